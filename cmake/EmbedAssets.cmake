@@ -0,0 +1,37 @@
+# Embute assets no executável (ver common/Assets.h).
+#
+#   pgcc_embed_assets(<alvo> <arquivo> ...)
+#
+# Os arquivos são relativos a assets/. Cada um vira, na hora da compilação, um
+# .cpp gerado com o conteúdo em um array constante; mudar o asset só regera e
+# recompila esse arquivo. Com PGCC_EMBED_ASSETS=OFF nada é embutido e o alvo lê
+# tudo de assets/ pelo caminho absoluto, útil para editar assets sem recompilar.
+
+option(PGCC_EMBED_ASSETS "Embute os assets listados com pgcc_embed_assets() no executável" ON)
+
+set(PGCC_EMBED_FILE_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/EmbedFile.cmake)
+
+function(pgcc_embed_assets TARGET)
+    # o fallback para o disco não depende do diretório de trabalho
+    target_compile_definitions(${TARGET} PRIVATE PGCC_ASSET_DIR="${CMAKE_SOURCE_DIR}/assets")
+    if(NOT PGCC_EMBED_ASSETS)
+        return()
+    endif()
+
+    foreach(ASSET ${ARGN})
+        set(INPUT ${CMAKE_SOURCE_DIR}/assets/${ASSET})
+        if(NOT EXISTS ${INPUT})
+            message(FATAL_ERROR "Asset para embutir não encontrado: ${INPUT}")
+        endif()
+        string(MAKE_C_IDENTIFIER ${ASSET} SYMBOL)
+        set(OUTPUT ${CMAKE_BINARY_DIR}/embedded_assets/${TARGET}/${SYMBOL}.cpp)
+        add_custom_command(
+            OUTPUT ${OUTPUT}
+            COMMAND ${CMAKE_COMMAND} -DINPUT=${INPUT} -DOUTPUT=${OUTPUT} -DNAME=${ASSET}
+                    -P ${PGCC_EMBED_FILE_SCRIPT}
+            DEPENDS ${INPUT} ${PGCC_EMBED_FILE_SCRIPT}
+            COMMENT "Embutindo asset ${ASSET}"
+            VERBATIM)
+        target_sources(${TARGET} PRIVATE ${OUTPUT})
+    endforeach()
+endfunction()
@@ -0,0 +1,30 @@
+# Script (cmake -P) chamado por pgcc_embed_assets(): escreve em OUTPUT um .cpp
+# com o conteúdo de INPUT em um array e o registra em Assets com o nome NAME.
+
+file(READ ${INPUT} HEX_CONTENT HEX)
+string(LENGTH "${HEX_CONTENT}" HEX_LENGTH)
+math(EXPR SIZE "${HEX_LENGTH} / 2")
+
+# "89504e47..." -> "0x89,0x50,0x4e,0x47,...", 16 bytes por linha
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX_CONTENT}")
+set(LINE "")
+foreach(I RANGE 15)
+    string(APPEND LINE "0x[0-9a-f][0-9a-f],")
+endforeach()
+string(REGEX REPLACE "(${LINE})" "\\1\n    " BYTES "${BYTES}")
+
+file(WRITE ${OUTPUT}
+"// Gerado por cmake/EmbedFile.cmake a partir de assets/${NAME}: não editar
+#include \"Assets.h\"
+
+namespace {
+
+// o '\\0' extra permite usar assets de texto como string C
+alignas(16) const unsigned char data[] = {
+    ${BYTES}0x00
+};
+
+const bool registered = Assets::registerEmbedded(\"${NAME}\", data, ${SIZE});
+
+} // namespace
+")
@@ -0,0 +1,390 @@
+#ifndef AabbTree_h
+#define AabbTree_h
+
+#include <float.h>
+#include <math.h>
+#include <vector>
+
+// Caixa alinhada aos eixos em 2D.
+struct Aabb2 {
+    float minX, minY, maxX, maxY;
+
+    bool contains(float x, float y) const {
+        // & em vez de &&: sem desvios, já que na travessia o resultado é imprevisível
+        return (x >= this->minX) & (x <= this->maxX) & (y >= this->minY) & (y <= this->maxY);
+    }
+
+    bool contains(const Aabb2 &other) const {
+        return other.minX >= this->minX && other.maxX <= this->maxX && other.minY >= this->minY &&
+               other.maxY <= this->maxY;
+    }
+
+    bool overlaps(const Aabb2 &other) const {
+        return (other.minX <= this->maxX) & (other.maxX >= this->minX) & (other.minY <= this->maxY) &
+               (other.maxY >= this->minY);
+    }
+
+    float perimeter() const {
+        return 2.0f * ((this->maxX - this->minX) + (this->maxY - this->minY));
+    }
+
+    // distância ao quadrado do ponto até a caixa (0 dentro dela)
+    float distance2(float x, float y) const {
+        float dx = fmaxf(fmaxf(this->minX - x, x - this->maxX), 0.0f);
+        float dy = fmaxf(fmaxf(this->minY - y, y - this->maxY), 0.0f);
+        return dx * dx + dy * dy;
+    }
+
+    static Aabb2 merge(const Aabb2 &a, const Aabb2 &b) {
+        Aabb2 box = {fminf(a.minX, b.minX), fminf(a.minY, b.minY), fmaxf(a.maxX, b.maxX), fmaxf(a.maxY, b.maxY)};
+        return box;
+    }
+};
+
+// Árvore dinâmica de AABBs (BVH) para objetos em posições arbitrárias.
+//
+// Cada objeto é uma folha com uma caixa "gorda" (a caixa real mais `margin` de
+// cada lado). move() só reinsere a folha quando a caixa nova sai da gorda, então
+// objetos que se mexem pouco custam quase nada por quadro. A inserção escolhe o
+// irmão pela heurística de área (perímetro, em 2D) e as rotações mantêm a
+// altura em O(log n), como a b2DynamicTree da Box2D.
+//
+// As consultas recebem um visitante `bool visit(int data)`; retornar false
+// interrompe a busca. As caixas gordas são conservadoras: quem precisa do teste
+// exato (ex.: ponto dentro do triângulo) o faz no visitante.
+
+class AabbTree {
+    struct Node {
+        Aabb2 box;
+        int parent;  // próximo livre quando o nó está na lista livre
+        int left, right; // -1 nas folhas
+        int height;  // 0 nas folhas, -1 livre
+        int data;
+    };
+
+    std::vector<Node> nodes;
+    int root;
+    int freeList;
+    int leafCount;
+    float margin;
+    std::vector<int> stack;
+
+    int allocateNode() {
+        if (this->freeList < 0) {
+            Node node;
+            node.parent = -1;
+            this->nodes.push_back(node);
+            this->freeList = (int) this->nodes.size() - 1;
+        }
+        int id = this->freeList;
+        this->freeList = this->nodes[id].parent;
+        Node &node = this->nodes[id];
+        node.parent = node.left = node.right = -1;
+        node.height = 0;
+        node.data = -1;
+        return id;
+    }
+
+    void freeNode(int id) {
+        this->nodes[id].parent = this->freeList;
+        this->nodes[id].height = -1;
+        this->freeList = id;
+    }
+
+    bool isLeaf(int id) const {
+        return this->nodes[id].left < 0;
+    }
+
+    void fixUpwards(int id) {
+        while (id >= 0) {
+            id = balance(id);
+            Node &node = this->nodes[id];
+            const Node &left = this->nodes[node.left];
+            const Node &right = this->nodes[node.right];
+            node.height = 1 + (left.height > right.height ? left.height : right.height);
+            node.box = Aabb2::merge(left.box, right.box);
+            id = node.parent;
+        }
+    }
+
+    void insertLeaf(int leaf) {
+        if (this->root < 0) {
+            this->root = leaf;
+            this->nodes[leaf].parent = -1;
+            return;
+        }
+
+        // desce pelo lado que menos aumenta o custo (soma dos perímetros)
+        Aabb2 leafBox = this->nodes[leaf].box;
+        int index = this->root;
+        while (!isLeaf(index)) {
+            const Node &node = this->nodes[index];
+            float area = node.box.perimeter();
+            float combined = Aabb2::merge(node.box, leafBox).perimeter();
+            float cost = 2.0f * combined;
+            float inheritance = 2.0f * (combined - area);
+
+            float childCost[2];
+            int children[2] = {node.left, node.right};
+            for (int k = 0; k < 2; k++) {
+                const Node &child = this->nodes[children[k]];
+                float grown = Aabb2::merge(leafBox, child.box).perimeter();
+                childCost[k] = isLeaf(children[k]) ? grown + inheritance
+                                                   : grown - child.box.perimeter() + inheritance;
+            }
+            if (cost < childCost[0] && cost < childCost[1]) {
+                break;
+            }
+            index = childCost[0] < childCost[1] ? children[0] : children[1];
+        }
+
+        int sibling = index;
+        int oldParent = this->nodes[sibling].parent;
+        int newParent = allocateNode();
+        this->nodes[newParent].parent = oldParent;
+        this->nodes[newParent].left = sibling;
+        this->nodes[newParent].right = leaf;
+        this->nodes[sibling].parent = newParent;
+        this->nodes[leaf].parent = newParent;
+        if (oldParent < 0) {
+            this->root = newParent;
+        } else if (this->nodes[oldParent].left == sibling) {
+            this->nodes[oldParent].left = newParent;
+        } else {
+            this->nodes[oldParent].right = newParent;
+        }
+        fixUpwards(newParent);
+    }
+
+    void removeLeaf(int leaf) {
+        if (leaf == this->root) {
+            this->root = -1;
+            return;
+        }
+        int parent = this->nodes[leaf].parent;
+        int grandParent = this->nodes[parent].parent;
+        int sibling = this->nodes[parent].left == leaf ? this->nodes[parent].right : this->nodes[parent].left;
+
+        if (grandParent < 0) {
+            this->root = sibling;
+            this->nodes[sibling].parent = -1;
+            freeNode(parent);
+            return;
+        }
+        if (this->nodes[grandParent].left == parent) {
+            this->nodes[grandParent].left = sibling;
+        } else {
+            this->nodes[grandParent].right = sibling;
+        }
+        this->nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        fixUpwards(grandParent);
+    }
+
+    // rotação quando um lado fica mais de 1 nível mais alto; retorna a nova raiz da subárvore
+    int balance(int a) {
+        if (isLeaf(a) || this->nodes[a].height < 2) {
+            return a;
+        }
+        int b = this->nodes[a].left;
+        int c = this->nodes[a].right;
+        int diff = this->nodes[c].height - this->nodes[b].height;
+        if (diff > 1) {
+            return rotate(a, c, b);
+        }
+        if (diff < -1) {
+            return rotate(a, b, c);
+        }
+        return a;
+    }
+
+    // sobe `up` (filho alto de a) para o lugar de a; `other` é o outro filho de a
+    int rotate(int a, int up, int other) {
+        Node &nodeA = this->nodes[a];
+        Node &nodeUp = this->nodes[up];
+        int f = nodeUp.left;
+        int g = nodeUp.right;
+
+        nodeUp.left = a;
+        nodeUp.parent = nodeA.parent;
+        nodeA.parent = up;
+        if (nodeUp.parent < 0) {
+            this->root = up;
+        } else if (this->nodes[nodeUp.parent].left == a) {
+            this->nodes[nodeUp.parent].left = up;
+        } else {
+            this->nodes[nodeUp.parent].right = up;
+        }
+
+        // o neto mais alto fica com `up`, o mais baixo desce para `a`
+        int keep = f, give = g;
+        if (this->nodes[f].height < this->nodes[g].height) {
+            keep = g;
+            give = f;
+        }
+        nodeUp.right = keep;
+        if (nodeA.left == up) {
+            nodeA.left = give;
+        } else {
+            nodeA.right = give;
+        }
+        this->nodes[give].parent = a;
+
+        const Node &otherNode = this->nodes[other];
+        const Node &giveNode = this->nodes[give];
+        nodeA.box = Aabb2::merge(otherNode.box, giveNode.box);
+        nodeA.height = 1 + (otherNode.height > giveNode.height ? otherNode.height : giveNode.height);
+        const Node &keepNode = this->nodes[keep];
+        nodeUp.box = Aabb2::merge(nodeA.box, keepNode.box);
+        nodeUp.height = 1 + (nodeA.height > keepNode.height ? nodeA.height : keepNode.height);
+        return up;
+    }
+
+    Aabb2 fatten(const Aabb2 &box) const {
+        Aabb2 fat = {box.minX - this->margin, box.minY - this->margin, box.maxX + this->margin,
+                     box.maxY + this->margin};
+        return fat;
+    }
+
+public:
+    explicit AabbTree(float margin = 0.0f) : root(-1), freeList(-1), leafCount(0), margin(margin) {}
+
+    // acrescenta um objeto; retorna o id da folha (para move/remove)
+    int insert(const Aabb2 &box, int data) {
+        int leaf = allocateNode();
+        this->nodes[leaf].box = fatten(box);
+        this->nodes[leaf].data = data;
+        insertLeaf(leaf);
+        this->leafCount++;
+        return leaf;
+    }
+
+    void remove(int leaf) {
+        removeLeaf(leaf);
+        freeNode(leaf);
+        this->leafCount--;
+    }
+
+    // Atualiza a caixa do objeto. Retorna true se a folha precisou ser
+    // reinserida (a caixa saiu da margem).
+    bool move(int leaf, const Aabb2 &box) {
+        if (this->nodes[leaf].box.contains(box)) {
+            return false;
+        }
+        removeLeaf(leaf);
+        this->nodes[leaf].box = fatten(box);
+        insertLeaf(leaf);
+        return true;
+    }
+
+    void clear() {
+        this->nodes.clear();
+        this->root = -1;
+        this->freeList = -1;
+        this->leafCount = 0;
+    }
+
+    template <typename Visit>
+    void queryPoint(float x, float y, Visit visit) {
+        if (this->root < 0) {
+            return;
+        }
+        this->stack.clear();
+        this->stack.push_back(this->root);
+        while (!this->stack.empty()) {
+            int id = this->stack.back();
+            this->stack.pop_back();
+            const Node &node = this->nodes[id];
+            if (!node.box.contains(x, y)) {
+                continue;
+            }
+            if (node.left < 0) {
+                if (!visit(node.data)) {
+                    return;
+                }
+            } else {
+                this->stack.push_back(node.left);
+                this->stack.push_back(node.right);
+            }
+        }
+    }
+
+    template <typename Visit>
+    void queryRect(const Aabb2 &rect, Visit visit) {
+        if (this->root < 0) {
+            return;
+        }
+        this->stack.clear();
+        this->stack.push_back(this->root);
+        while (!this->stack.empty()) {
+            int id = this->stack.back();
+            this->stack.pop_back();
+            const Node &node = this->nodes[id];
+            if (!node.box.overlaps(rect)) {
+                continue;
+            }
+            if (node.left < 0) {
+                if (!visit(node.data)) {
+                    return;
+                }
+            } else {
+                this->stack.push_back(node.left);
+                this->stack.push_back(node.right);
+            }
+        }
+    }
+
+    // Objeto mais próximo de (x, y) pela distância `distance2(data)` (ao
+    // quadrado), que não pode ser menor que a distância até a caixa gorda.
+    // Retorna o data, ou -1 se nada estiver a menos de sqrt(maxDistance2).
+    template <typename Distance2>
+    int nearest(float x, float y, Distance2 distance2, float maxDistance2 = FLT_MAX) {
+        int best = -1;
+        float bestDistance2 = maxDistance2;
+        if (this->root < 0) {
+            return best;
+        }
+        this->stack.clear();
+        this->stack.push_back(this->root);
+        while (!this->stack.empty()) {
+            int id = this->stack.back();
+            this->stack.pop_back();
+            const Node &node = this->nodes[id];
+            if (node.box.distance2(x, y) >= bestDistance2) {
+                continue;
+            }
+            if (node.left < 0) {
+                float d2 = distance2(node.data);
+                if (d2 < bestDistance2) {
+                    bestDistance2 = d2;
+                    best = node.data;
+                }
+                continue;
+            }
+            // o filho mais perto por último, para sair primeiro da pilha
+            float dl = this->nodes[node.left].box.distance2(x, y);
+            float dr = this->nodes[node.right].box.distance2(x, y);
+            this->stack.push_back(dl < dr ? node.right : node.left);
+            this->stack.push_back(dl < dr ? node.left : node.right);
+        }
+        return best;
+    }
+
+    int data(int leaf) const {
+        return this->nodes[leaf].data;
+    }
+
+    const Aabb2 &fatBox(int leaf) const {
+        return this->nodes[leaf].box;
+    }
+
+    int size() const {
+        return this->leafCount;
+    }
+
+    int height() const {
+        return this->root < 0 ? 0 : this->nodes[this->root].height;
+    }
+};
+
+#endif /* AabbTree_h */
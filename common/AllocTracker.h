@@ -0,0 +1,331 @@
+#ifndef AllocTracker_h
+#define AllocTracker_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <iostream>
+
+// Contagem de alocações por quadro.
+//
+// Com PGCC_ALLOC_TRACKING definido (builds Debug, ver CMakelists.txt) este
+// header substitui o operator new/delete global por versões que contam
+// alocações e bytes, de todas as threads. Entre beginFrame() e endFrame() cada
+// alocação também guarda a pilha de chamadas (até ALLOC_TRACKER_DEPTH
+// endereços) em uma tabela fixa, sem alocar, e endFrame() avisa quando um
+// quadro já aquecido aloca, com os pontos de chamada responsáveis:
+//
+//     while (...) {
+//         AllocTracker::beginFrame();
+//         ... quadro ...
+//         AllocTracker::endFrame();   // conta; avisa depois do aquecimento
+//     }
+//
+// Os nomes das funções do executável só aparecem com -rdynamic (ligado junto
+// nas builds Debug); sem ele ficam como executável+deslocamento.
+//
+// Sem PGCC_ALLOC_TRACKING tudo vira função vazia e o new/delete é o padrão.
+// Por substituir o operator new, o header deve ser incluído em um único .cpp
+// por executável (todos os programas do repositório têm um só). As versões
+// com alinhamento estendido (new com std::align_val_t) não são contadas.
+
+#define ALLOC_TRACKER_DEPTH 16
+#define ALLOC_TRACKER_SITES 512
+#define ALLOC_TRACKER_WARMUP 10 // quadros ignorados no começo (caches, buffers crescendo)
+#define ALLOC_TRACKER_REPORTS 3 // quadros com relatório completo; depois só a contagem
+
+struct AllocFrameStats {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+#if defined(PGCC_ALLOC_TRACKING)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <execinfo.h>
+#define ALLOC_TRACKER_BACKTRACE 1
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+class AllocTracker {
+    struct Site {
+        void *stack[ALLOC_TRACKER_DEPTH];
+        int depth;
+        uint64_t allocations;
+        uint64_t bytes;
+    };
+
+    // tudo em armazenamento estático inicializado com zero: o operator new
+    // pode ser chamado antes de qualquer construtor global
+    struct State {
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> frees;
+        std::atomic<uint64_t> bytes;
+        std::atomic<bool> inFrame;
+        std::atomic_flag sitesLock;
+        Site sites[ALLOC_TRACKER_SITES];
+        int siteCount;
+        uint64_t frameAllocations, frameBytes; // no começo do quadro
+        uint64_t frames;
+        uint64_t allocatingFrames;
+    };
+
+    static State &state() {
+        static State instance;
+        return instance;
+    }
+
+    static bool &insideTracker() {
+        static thread_local bool inside = false;
+        return inside;
+    }
+
+    static void recordSite(size_t size) {
+#if defined(ALLOC_TRACKER_BACKTRACE)
+        // backtrace() pode alocar na primeira chamada; não entra de novo aqui
+        bool &inside = insideTracker();
+        if (inside) {
+            return;
+        }
+        inside = true;
+        void *stack[ALLOC_TRACKER_DEPTH];
+        int depth = backtrace(stack, ALLOC_TRACKER_DEPTH);
+        if (depth > 0) {
+            State &s = state();
+            while (s.sitesLock.test_and_set(std::memory_order_acquire)) {
+            }
+            Site *site = NULL;
+            for (int i = 0; i < s.siteCount && site == NULL; i++) {
+                if (s.sites[i].depth == depth && memcmp(s.sites[i].stack, stack, depth * sizeof(void *)) == 0) {
+                    site = &s.sites[i];
+                }
+            }
+            if (site == NULL && s.siteCount < ALLOC_TRACKER_SITES) {
+                site = &s.sites[s.siteCount++];
+                memcpy(site->stack, stack, depth * sizeof(void *));
+                site->depth = depth;
+                site->allocations = 0;
+                site->bytes = 0;
+            }
+            if (site != NULL) {
+                site->allocations++;
+                site->bytes += size;
+            }
+            s.sitesLock.clear(std::memory_order_release);
+        }
+        inside = false;
+#else
+        (void) size;
+#endif
+    }
+
+    static std::string describe(void *address) {
+        char buffer[64];
+#if defined(ALLOC_TRACKER_BACKTRACE)
+        Dl_info info;
+        if (dladdr(address, &info) != 0) {
+            if (info.dli_sname != NULL) {
+                std::string name = info.dli_sname;
+#if defined(__GNUC__) || defined(__clang__)
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+                if (status == 0 && demangled != NULL) {
+                    name = demangled;
+                }
+                free(demangled);
+#endif
+                return name;
+            }
+            if (info.dli_fname != NULL) {
+                std::string file = info.dli_fname;
+                size_t slash = file.find_last_of('/');
+                snprintf(buffer, sizeof(buffer), "+0x%lx",
+                         (unsigned long) ((const char *) address - (const char *) info.dli_fbase));
+                return file.substr(slash == std::string::npos ? 0 : slash + 1) + buffer;
+            }
+        }
+#endif
+        snprintf(buffer, sizeof(buffer), "%p", address);
+        return buffer;
+    }
+
+    // O próprio tracker, o operator new e o alocador da biblioteca padrão não
+    // dizem quem alocou. Templates vêm com o tipo de retorno na frente do nome
+    // ("void std::vector<...>::..."), então vale o nome em qualquer posição
+    // antes dos parâmetros.
+    static bool isLibraryFrame(const std::string &name) {
+        std::string qualified = " " + name.substr(0, name.find('('));
+        return qualified.find(" std::") != std::string::npos || qualified.find(" __gnu_cxx::") != std::string::npos ||
+               qualified.find(" operator new") != std::string::npos ||
+               qualified.find(" AllocTracker::") != std::string::npos;
+    }
+
+public:
+    static bool enabled() {
+        return true;
+    }
+
+    // chamado pelo operator new
+    static void record(size_t size) {
+        State &s = state();
+        s.allocations.fetch_add(1, std::memory_order_relaxed);
+        s.bytes.fetch_add(size, std::memory_order_relaxed);
+        if (s.inFrame.load(std::memory_order_relaxed)) {
+            recordSite(size);
+        }
+    }
+
+    static void recordFree() {
+        state().frees.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // alocações desde o início do programa
+    static AllocFrameStats total() {
+        State &s = state();
+        AllocFrameStats stats = {s.allocations.load(), s.bytes.load()};
+        return stats;
+    }
+
+    static void beginFrame() {
+        State &s = state();
+        s.frameAllocations = s.allocations.load();
+        s.frameBytes = s.bytes.load();
+        while (s.sitesLock.test_and_set(std::memory_order_acquire)) {
+        }
+        s.siteCount = 0;
+        s.sitesLock.clear(std::memory_order_release);
+        s.inFrame.store(true);
+    }
+
+    // Fecha o quadro e devolve o que ele alocou. Depois do aquecimento, um
+    // quadro que aloca gera um aviso em cerr (com os pontos de chamada nos
+    // primeiros ALLOC_TRACKER_REPORTS).
+    static AllocFrameStats endFrame() {
+        State &s = state();
+        s.inFrame.store(false);
+        AllocFrameStats stats = {s.allocations.load() - s.frameAllocations, s.bytes.load() - s.frameBytes};
+        s.frames++;
+        if (stats.allocations > 0 && s.frames > ALLOC_TRACKER_WARMUP) {
+            s.allocatingFrames++;
+            std::cerr << "alloc: o quadro " << s.frames << " fez " << stats.allocations << " alocações ("
+                      << stats.bytes << " bytes)" << std::endl;
+            if (s.allocatingFrames <= ALLOC_TRACKER_REPORTS) {
+                printSites(std::cerr);
+            }
+        }
+        return stats;
+    }
+
+    // Pontos de chamada do último quadro: a primeira função fora da
+    // biblioteca padrão e quem a chamou.
+    static void printSites(std::ostream &out) {
+        State &s = state();
+        for (int i = 0; i < s.siteCount; i++) {
+            const Site &site = s.sites[i];
+            std::string where, caller;
+            for (int k = 0; k < site.depth; k++) {
+                std::string name = describe(site.stack[k]);
+                if (!where.empty()) {
+                    caller = name;
+                    break;
+                }
+                if (!isLibraryFrame(name)) {
+                    where = name;
+                }
+            }
+            if (where.empty()) {
+                where = describe(site.stack[0]);
+            }
+            out << "  " << site.allocations << "x " << site.bytes << " bytes em " << where;
+            if (!caller.empty()) {
+                out << " <- " << caller;
+            }
+            out << std::endl;
+        }
+    }
+};
+
+void *operator new(size_t size) {
+    AllocTracker::record(size);
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    AllocTracker::record(size);
+    return malloc(size > 0 ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept {
+    if (p != NULL) {
+        AllocTracker::recordFree();
+        free(p);
+    }
+}
+
+void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    operator delete(p);
+}
+
+#else
+
+class AllocTracker {
+public:
+    static bool enabled() {
+        return false;
+    }
+
+    static AllocFrameStats total() {
+        AllocFrameStats stats = {0, 0};
+        return stats;
+    }
+
+    static void beginFrame() {}
+
+    static AllocFrameStats endFrame() {
+        AllocFrameStats stats = {0, 0};
+        return stats;
+    }
+
+    static void printSites(std::ostream &) {}
+};
+
+#endif /* PGCC_ALLOC_TRACKING */
+
+#endif /* AllocTracker_h */
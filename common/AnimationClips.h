@@ -0,0 +1,199 @@
+#ifndef AnimationClips_h
+#define AnimationClips_h
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Animações de sprites definidas em dados e avaliadas na GPU.
+//
+// Um clipe descreve o layout da spritesheet, o intervalo de quadros (um por
+// direção, quando houver), a velocidade e o modo de repetição. A tabela inteira
+// vai para o shader como dois arrays de uniforms; cada sprite só informa o id do
+// clipe, a direção e o instante em que o clipe começou, e o vertex shader
+// calcula o quadro a partir do uniform global `time`. Nenhum trabalho de
+// animação por quadro na CPU.
+//
+// Arquivo de clipes (uma linha por clipe, '#' comenta):
+//   nome colunas linhas primeiroQuadro quadros passoDirecao fps loop|once|pingpong
+// primeiroQuadro = linha * colunas + coluna do quadro 0 na direção 0;
+// passoDirecao = quadros a somar por direção (0 = clipe sem direção).
+
+#define CLIP_LOOP 0
+#define CLIP_ONCE 1       // para no último quadro
+#define CLIP_PING_PONG 2  // vai e volta
+
+#define MAX_ANIMATION_CLIPS 64
+
+struct AnimationClip {
+    std::string name;
+    int columns, rows;
+    int firstFrame;
+    int frameCount;
+    int directionStride;
+    float fps;
+    int loopMode;
+};
+
+class AnimationClipTable {
+    std::vector<AnimationClip> clips;
+
+    // streambuf só de leitura sobre um texto que já está na memória
+    struct ViewBuffer : std::streambuf {
+        explicit ViewBuffer(std::string_view text) {
+            char *begin = const_cast<char *>(text.data());
+            setg(begin, begin, begin + text.size());
+        }
+    };
+
+public:
+    int add(const AnimationClip &clip) {
+        if ((int) this->clips.size() >= MAX_ANIMATION_CLIPS) {
+            std::cerr << "Tabela de clipes cheia (" << MAX_ANIMATION_CLIPS << "): " << clip.name << std::endl;
+            return -1;
+        }
+        this->clips.push_back(clip);
+        return (int) this->clips.size() - 1;
+    }
+
+    // lê um arquivo de clipes; retorna false se não conseguir abrir ou se
+    // alguma linha for inválida
+    bool loadFromFile(const std::string &path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Erro ao abrir arquivo de clipes: " << path << std::endl;
+            return false;
+        }
+        return load(file, path);
+    }
+
+    // mesmo formato, a partir do texto já carregado (ex.: asset embutido),
+    // lido direto da memória de `text`; `path` só aparece nas mensagens de erro
+    bool loadFromString(std::string_view text, const std::string &path) {
+        ViewBuffer buffer(text);
+        std::istream in(&buffer);
+        return load(in, path);
+    }
+
+    bool load(std::istream &file, const std::string &path) {
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            std::istringstream in(line);
+            AnimationClip clip;
+            std::string mode;
+            if (!(in >> clip.name)) {
+                continue; // linha vazia
+            }
+            if (!(in >> clip.columns >> clip.rows >> clip.firstFrame >> clip.frameCount
+                     >> clip.directionStride >> clip.fps >> mode)
+                || clip.columns <= 0 || clip.rows <= 0 || clip.frameCount <= 0) {
+                std::cerr << path << ":" << lineNumber << ": clipe inválido" << std::endl;
+                return false;
+            }
+            if (mode == "loop") {
+                clip.loopMode = CLIP_LOOP;
+            } else if (mode == "once") {
+                clip.loopMode = CLIP_ONCE;
+            } else if (mode == "pingpong") {
+                clip.loopMode = CLIP_PING_PONG;
+            } else {
+                std::cerr << path << ":" << lineNumber << ": modo desconhecido " << mode << std::endl;
+                return false;
+            }
+            if (add(clip) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // id do clipe pelo nome, ou -1
+    int find(const std::string &name) const {
+        for (size_t i = 0; i < this->clips.size(); i++) {
+            if (this->clips[i].name == name) {
+                return (int) i;
+            }
+        }
+        return -1;
+    }
+
+    const AnimationClip &get(int id) const {
+        return this->clips[id];
+    }
+
+    int size() const {
+        return (int) this->clips.size();
+    }
+
+    // envia a tabela para `shader` (que precisa estar em uso e incluir glsl())
+    void upload(GLuint shader) const {
+        int n = size();
+        std::vector<GLint> shape(4 * n);
+        std::vector<GLfloat> timing(4 * n);
+        for (int i = 0; i < n; i++) {
+            const AnimationClip &clip = this->clips[i];
+            shape[4 * i + 0] = clip.columns;
+            shape[4 * i + 1] = clip.rows;
+            shape[4 * i + 2] = clip.firstFrame;
+            shape[4 * i + 3] = clip.frameCount;
+            timing[4 * i + 0] = clip.fps;
+            timing[4 * i + 1] = (GLfloat) clip.loopMode;
+            timing[4 * i + 2] = (GLfloat) clip.directionStride;
+            timing[4 * i + 3] = 0.0f;
+        }
+        if (n > 0) {
+            glUniform4iv(glGetUniformLocation(shader, "clipShape"), n, shape.data());
+            glUniform4fv(glGetUniformLocation(shader, "clipTiming"), n, timing.data());
+        }
+    }
+
+    // Trecho GLSL para colar logo depois da linha #version do vertex shader.
+    // clipRect devolve (u, v, largura, altura) da célula atual na textura, com
+    // v = 0 na primeira linha da imagem (como o stb_image carrega).
+    static std::string glsl() {
+        return "#define MAX_ANIMATION_CLIPS " + std::to_string(MAX_ANIMATION_CLIPS) + "\n" + R"(
+        #define CLIP_LOOP 0
+        #define CLIP_ONCE 1
+        #define CLIP_PING_PONG 2
+
+        uniform ivec4 clipShape[MAX_ANIMATION_CLIPS];  // colunas, linhas, primeiro quadro, quadros
+        uniform vec4 clipTiming[MAX_ANIMATION_CLIPS];  // fps, modo, passo por direção, -
+        uniform float time;
+
+        vec4 clipRect(int clip, int direction, float startTime)
+        {
+            ivec4 shape = clipShape[clip];
+            vec4 timing = clipTiming[clip];
+            int frames = shape.w;
+            int step = int(floor(max(time - startTime, 0.0) * timing.x));
+            int mode = int(timing.y);
+            int frame;
+            if (mode == CLIP_ONCE) {
+                frame = min(step, frames - 1);
+            } else if (mode == CLIP_PING_PONG && frames > 1) {
+                int period = 2 * frames - 2;
+                frame = step % period;
+                frame = frame < frames ? frame : period - frame;
+            } else {
+                frame = step % frames;
+            }
+            int index = shape.z + direction * int(timing.z) + frame;
+            vec2 cellSize = vec2(1.0) / vec2(shape.xy);
+            return vec4(vec2(index % shape.x, index / shape.x) * cellSize, cellSize);
+        }
+        )";
+    }
+};
+
+#endif /* AnimationClips_h */
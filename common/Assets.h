@@ -0,0 +1,110 @@
+#ifndef Assets_h
+#define Assets_h
+
+#include <stddef.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Arquivos de assets (mapas, clipes, PNGs...) embutidos no executável.
+//
+// A função pgcc_embed_assets() do CMake (cmake/EmbedAssets.cmake) gera, para
+// cada arquivo listado, um .cpp com o conteúdo em um array constante que se
+// registra aqui durante a inicialização estática. Assets::find() devolve uma
+// visão direto desse array: sem abrir arquivo, sem cópia e sem depender do
+// diretório de trabalho.
+//
+// O que não foi embutido (ou tudo, com -DPGCC_EMBED_ASSETS=OFF, para editar os
+// assets sem recompilar) é lido do disco a partir de PGCC_ASSET_DIR na
+// primeira busca e fica em cache até o fim do programa, então as visões nunca
+// ficam inválidas.
+//
+// Os nomes são relativos à pasta assets/, com '/' (ex.: "maps/map15x15.txt").
+
+#ifndef PGCC_ASSET_DIR
+#define PGCC_ASSET_DIR "../assets"
+#endif
+
+struct AssetView {
+    const unsigned char *data; // sempre seguido de um '\0' (fora de size)
+    size_t size;
+    bool embedded;
+
+    bool valid() const {
+        return this->data != NULL;
+    }
+
+    const char *text() const {
+        return (const char *) this->data;
+    }
+
+    // o texto sem copiar; válido até o fim do programa
+    std::string_view view() const {
+        return std::string_view(text(), this->size);
+    }
+};
+
+class Assets {
+    struct Registry {
+        std::mutex lock;
+        std::unordered_map<std::string, AssetView> views;
+        std::unordered_map<std::string, std::string> loaded; // lidos do disco
+    };
+
+    static Registry &registry() {
+        static Registry instance;
+        return instance;
+    }
+
+public:
+    // chamado pelos arquivos gerados; `data` precisa ter um '\0' em data[size]
+    static bool registerEmbedded(const char *name, const unsigned char *data, size_t size) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        AssetView view = {data, size, true};
+        r.views[name] = view;
+        return true;
+    }
+
+    static std::string diskPath(const std::string &name) {
+        return std::string(PGCC_ASSET_DIR) + "/" + name;
+    }
+
+    // Conteúdo do asset; data == NULL (e uma mensagem em cerr) se não estiver
+    // embutido nem existir no disco.
+    static AssetView find(const std::string &name) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        std::unordered_map<std::string, AssetView>::const_iterator it = r.views.find(name);
+        if (it != r.views.end()) {
+            return it->second;
+        }
+
+        AssetView view = {NULL, 0, false};
+        std::ifstream file(diskPath(name), std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Asset não encontrado: " << name << " (nem embutido nem em " << diskPath(name) << ")"
+                      << std::endl;
+            return view;
+        }
+        std::string &content = r.loaded[name];
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        view.data = (const unsigned char *) content.c_str();
+        view.size = content.size();
+        r.views[name] = view;
+        return view;
+    }
+
+    static bool isEmbedded(const std::string &name) {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        std::unordered_map<std::string, AssetView>::const_iterator it = r.views.find(name);
+        return it != r.views.end() && it->second.embedded;
+    }
+};
+
+#endif /* Assets_h */
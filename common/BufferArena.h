@@ -0,0 +1,430 @@
+#ifndef BufferArena_h
+#define BufferArena_h
+
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+
+// Subalocador de um buffer grande da GPU.
+//
+// Em vez de um VBO/EBO por malha, várias malhas pequenas dividem um buffer:
+// allocate() devolve um handle, e offset(handle) diz onde os dados estão no
+// buffer. Os blocos livres ficam em listas segregadas no estilo TLSF (classe
+// pela potência de 2 do tamanho, subdividida em ARENA_SL_COUNT faixas, com
+// bitmaps para achar a classe), então alocar e liberar custam O(1); blocos
+// livres vizinhos são juntados na liberação.
+//
+// Cada alocação pode pedir um alinhamento qualquer (não precisa ser potência de
+// 2): o tamanho do vértice para dados que serão lidos com baseVertex ou
+// first, 4 para índices GL_UNSIGNED_INT etc.
+//
+// Sem espaço, o buffer dobra e o conteúdo é copiado na GPU (buffer() muda, os
+// offsets não). compact() move, com glCopyBufferSubData, o bloco vivo mais alto
+// para o buraco mais baixo em que ele cabe, até gastar o orçamento de bytes;
+// chamado um pouco por quadro, fecha os buracos deixados pelas liberações.
+// Quando algum bloco muda de lugar generation() muda, e quem guardou offsets
+// precisa consultá-los de novo.
+//
+// Os dados são enviados por GL_COPY_WRITE_BUFFER, sem mexer no
+// GL_ELEMENT_ARRAY_BUFFER do VAO que estiver ligado.
+
+#define ARENA_GRANULARITY 16   // bytes; todo bloco tem tamanho múltiplo disto
+#define ARENA_SL_LOG2 4
+#define ARENA_SL_COUNT (1 << ARENA_SL_LOG2)
+#define ARENA_FL_COUNT 28
+
+class BufferArena {
+    struct Block {
+        GLintptr offset;
+        GLsizeiptr size;
+        int prevPhys, nextPhys;  // vizinhos por endereço
+        int prevFree, nextFree;  // lista da classe (só blocos livres)
+        int handle;              // -1 quando livre
+    };
+
+    struct Allocation {
+        int block;               // -1 quando o handle está livre
+        GLsizeiptr size;         // tamanho pedido
+        GLsizeiptr alignment;
+        GLintptr offset;         // início alinhado dentro do bloco
+    };
+
+    GLuint buf;
+    GLenum usage;
+    GLsizeiptr capacity;
+    GLsizeiptr live;
+    unsigned int moves;
+
+    std::vector<Block> blocks;
+    std::vector<int> unusedBlocks;
+    int firstPhys, lastPhys;
+    std::vector<Allocation> allocations;
+    std::vector<int> unusedHandles;
+
+    uint32_t flBitmap;
+    uint32_t slBitmap[ARENA_FL_COUNT];
+    int freeHeads[ARENA_FL_COUNT][ARENA_SL_COUNT];
+
+    static int lowestBit(uint32_t v) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, v);
+        return (int) index;
+#else
+        return __builtin_ctz(v);
+#endif
+    }
+
+    static int highestBit(uint64_t v) {
+        int bit = 0;
+        while (v >>= 1) {
+            bit++;
+        }
+        return bit;
+    }
+
+    static GLsizeiptr roundUp(GLsizeiptr value, GLsizeiptr multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    // classe (fl, sl) de um bloco de `size` bytes
+    static void mapping(GLsizeiptr size, int &fl, int &sl) {
+        uint64_t units = (uint64_t) size / ARENA_GRANULARITY;
+        if (units < ARENA_SL_COUNT) {
+            fl = 0;
+            sl = (int) units;
+            return;
+        }
+        int top = highestBit(units);
+        fl = top - ARENA_SL_LOG2 + 1;
+        sl = (int) ((units >> (top - ARENA_SL_LOG2)) ^ ARENA_SL_COUNT);
+    }
+
+    // menor classe cujos blocos certamente comportam `size`
+    static void mappingSearch(GLsizeiptr size, int &fl, int &sl) {
+        uint64_t units = (uint64_t) size / ARENA_GRANULARITY;
+        if (units >= ARENA_SL_COUNT) {
+            units += (1ull << (highestBit(units) - ARENA_SL_LOG2)) - 1;
+        }
+        mapping((GLsizeiptr) (units * ARENA_GRANULARITY), fl, sl);
+    }
+
+    int newBlock(GLintptr offset, GLsizeiptr size) {
+        Block block = {offset, size, -1, -1, -1, -1, -1};
+        if (!this->unusedBlocks.empty()) {
+            int index = this->unusedBlocks.back();
+            this->unusedBlocks.pop_back();
+            this->blocks[index] = block;
+            return index;
+        }
+        this->blocks.push_back(block);
+        return (int) this->blocks.size() - 1;
+    }
+
+    void insertFree(int index) {
+        int fl, sl;
+        mapping(this->blocks[index].size, fl, sl);
+        Block &block = this->blocks[index];
+        block.handle = -1;
+        block.prevFree = -1;
+        block.nextFree = this->freeHeads[fl][sl];
+        if (block.nextFree >= 0) {
+            this->blocks[block.nextFree].prevFree = index;
+        }
+        this->freeHeads[fl][sl] = index;
+        this->flBitmap |= 1u << fl;
+        this->slBitmap[fl] |= 1u << sl;
+    }
+
+    void removeFree(int index) {
+        int fl, sl;
+        mapping(this->blocks[index].size, fl, sl);
+        Block &block = this->blocks[index];
+        if (block.prevFree >= 0) {
+            this->blocks[block.prevFree].nextFree = block.nextFree;
+        } else {
+            this->freeHeads[fl][sl] = block.nextFree;
+            if (block.nextFree < 0) {
+                this->slBitmap[fl] &= ~(1u << sl);
+                if (this->slBitmap[fl] == 0) {
+                    this->flBitmap &= ~(1u << fl);
+                }
+            }
+        }
+        if (block.nextFree >= 0) {
+            this->blocks[block.nextFree].prevFree = block.prevFree;
+        }
+    }
+
+    // bloco livre com pelo menos `size` bytes, ou -1
+    int findFree(GLsizeiptr size) const {
+        int fl, sl;
+        mappingSearch(size, fl, sl);
+        if (fl >= ARENA_FL_COUNT) {
+            return -1;
+        }
+        uint32_t slMap = this->slBitmap[fl] & (~0u << sl);
+        if (slMap == 0) {
+            uint32_t flMap = fl + 1 < 32 ? this->flBitmap & (~0u << (fl + 1)) : 0;
+            if (flMap == 0) {
+                return -1;
+            }
+            fl = lowestBit(flMap);
+            slMap = this->slBitmap[fl];
+        }
+        return this->freeHeads[fl][lowestBit(slMap)];
+    }
+
+    // separa os primeiros `size` bytes do bloco livre `index` (já fora das
+    // listas); o resto volta para a lista livre
+    void split(int index, GLsizeiptr size) {
+        GLsizeiptr rest = this->blocks[index].size - size;
+        if (rest < ARENA_GRANULARITY) {
+            return;
+        }
+        int tail = newBlock(this->blocks[index].offset + size, rest);
+        Block &block = this->blocks[index];
+        block.size = size;
+        this->blocks[tail].prevPhys = index;
+        this->blocks[tail].nextPhys = block.nextPhys;
+        if (block.nextPhys >= 0) {
+            this->blocks[block.nextPhys].prevPhys = tail;
+        } else {
+            this->lastPhys = tail;
+        }
+        block.nextPhys = tail;
+        insertFree(tail);
+    }
+
+    // junta `next` (livre, já fora das listas) ao fim de `index`
+    void absorb(int index, int next) {
+        this->blocks[index].size += this->blocks[next].size;
+        this->blocks[index].nextPhys = this->blocks[next].nextPhys;
+        if (this->blocks[next].nextPhys >= 0) {
+            this->blocks[this->blocks[next].nextPhys].prevPhys = index;
+        } else {
+            this->lastPhys = index;
+        }
+        this->unusedBlocks.push_back(next);
+    }
+
+    // devolve o bloco `index` às listas livres, juntando com os vizinhos livres
+    void freeBlock(int index) {
+        int next = this->blocks[index].nextPhys;
+        if (next >= 0 && this->blocks[next].handle < 0) {
+            removeFree(next);
+            absorb(index, next);
+        }
+        int prev = this->blocks[index].prevPhys;
+        if (prev >= 0 && this->blocks[prev].handle < 0) {
+            removeFree(prev);
+            absorb(prev, index);
+            index = prev;
+        }
+        insertFree(index);
+    }
+
+    static GLsizeiptr blockSizeFor(GLsizeiptr size, GLsizeiptr alignment) {
+        // blocos começam em múltiplos de ARENA_GRANULARITY; outros alinhamentos
+        // precisam de folga para o início ser empurrado
+        GLsizeiptr padding = ARENA_GRANULARITY % alignment == 0 ? 0 : alignment - 1;
+        return roundUp(size + padding, ARENA_GRANULARITY);
+    }
+
+    // ocupa o bloco livre `index` com a alocação `handle`
+    void place(int index, int handle) {
+        Allocation &allocation = this->allocations[handle];
+        removeFree(index);
+        split(index, blockSizeFor(allocation.size, allocation.alignment));
+        this->blocks[index].handle = handle;
+        allocation.block = index;
+        allocation.offset = roundUp(this->blocks[index].offset, allocation.alignment);
+    }
+
+    void copy(GLintptr from, GLintptr to, GLsizeiptr size) {
+        glBindBuffer(GL_COPY_READ_BUFFER, this->buf);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->buf);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, to, size);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void grow(GLsizeiptr needed) {
+        GLsizeiptr newCapacity = this->capacity > 0 ? this->capacity * 2 : 64 * 1024;
+        while (newCapacity - this->capacity < needed) {
+            newCapacity *= 2;
+        }
+        GLuint newBuffer;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, newCapacity, NULL, this->usage);
+        if (this->capacity > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, this->buf);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, this->capacity);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &this->buf);
+        this->buf = newBuffer;
+
+        int tail = newBlock(this->capacity, newCapacity - this->capacity);
+        this->blocks[tail].prevPhys = this->lastPhys;
+        if (this->lastPhys >= 0) {
+            this->blocks[this->lastPhys].nextPhys = tail;
+        } else {
+            this->firstPhys = tail;
+        }
+        this->lastPhys = tail;
+        this->capacity = newCapacity;
+        freeBlock(tail);
+    }
+
+public:
+    explicit BufferArena(GLenum usage = GL_STATIC_DRAW)
+        : buf(0), usage(usage), capacity(0), live(0), moves(0), firstPhys(-1), lastPhys(-1), flBitmap(0) {
+        for (int fl = 0; fl < ARENA_FL_COUNT; fl++) {
+            this->slBitmap[fl] = 0;
+            for (int sl = 0; sl < ARENA_SL_COUNT; sl++) {
+                this->freeHeads[fl][sl] = -1;
+            }
+        }
+    }
+
+    ~BufferArena() {
+        glDeleteBuffers(1, &this->buf);
+    }
+
+    BufferArena(const BufferArena &) = delete;
+    BufferArena &operator=(const BufferArena &) = delete;
+
+    // cria o buffer (precisa de um contexto OpenGL atual)
+    void init(GLsizeiptr initialCapacity) {
+        grow(roundUp(initialCapacity, ARENA_GRANULARITY));
+    }
+
+    // Reserva `size` bytes com o início múltiplo de `alignment`; retorna o handle.
+    int allocate(GLsizeiptr size, GLsizeiptr alignment = ARENA_GRANULARITY) {
+        if (size <= 0 || alignment <= 0) {
+            std::cerr << "BufferArena: alocação inválida (" << size << " bytes, alinhamento " << alignment << ")"
+                      << std::endl;
+            return -1;
+        }
+        Allocation allocation = {-1, size, alignment, 0};
+        int handle;
+        if (!this->unusedHandles.empty()) {
+            handle = this->unusedHandles.back();
+            this->unusedHandles.pop_back();
+            this->allocations[handle] = allocation;
+        } else {
+            handle = (int) this->allocations.size();
+            this->allocations.push_back(allocation);
+        }
+
+        GLsizeiptr blockSize = blockSizeFor(size, alignment);
+        int index = findFree(blockSize);
+        if (index < 0) {
+            grow(2 * blockSize); // folga para o arredondamento da classe
+            index = findFree(blockSize);
+        }
+        place(index, handle);
+        this->live += size;
+        return handle;
+    }
+
+    int allocate(const void *data, GLsizeiptr size, GLsizeiptr alignment = ARENA_GRANULARITY) {
+        int handle = allocate(size, alignment);
+        if (handle >= 0 && data != NULL) {
+            upload(handle, data, size);
+        }
+        return handle;
+    }
+
+    // escreve `size` bytes a partir de `at` dentro da alocação
+    void upload(int handle, const void *data, GLsizeiptr size, GLintptr at = 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, this->buf);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, this->allocations[handle].offset + at, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void release(int handle) {
+        if (handle < 0 || handle >= (int) this->allocations.size() || this->allocations[handle].block < 0) {
+            return;
+        }
+        freeBlock(this->allocations[handle].block);
+        this->live -= this->allocations[handle].size;
+        this->allocations[handle].block = -1;
+        this->unusedHandles.push_back(handle);
+    }
+
+    // Move blocos vivos do fim do buffer para buracos mais baixos até copiar
+    // `byteBudget` bytes ou não haver mais o que mover. Retorna os bytes copiados.
+    GLsizeiptr compact(GLsizeiptr byteBudget) {
+        GLsizeiptr copied = 0;
+        while (copied < byteBudget) {
+            int top = this->lastPhys;
+            while (top >= 0 && this->blocks[top].handle < 0) {
+                top = this->blocks[top].prevPhys;
+            }
+            if (top < 0) {
+                break;
+            }
+            int handle = this->blocks[top].handle;
+            Allocation &allocation = this->allocations[handle];
+            GLsizeiptr blockSize = blockSizeFor(allocation.size, allocation.alignment);
+
+            int hole = this->firstPhys;
+            while (hole != top && (this->blocks[hole].handle >= 0 || this->blocks[hole].size < blockSize)) {
+                hole = this->blocks[hole].nextPhys;
+            }
+            if (hole == top) {
+                break; // nenhum buraco abaixo comporta o bloco
+            }
+
+            GLintptr from = allocation.offset;
+            place(hole, handle);
+            copy(from, allocation.offset, allocation.size);
+            freeBlock(top);
+            copied += allocation.size;
+            this->moves++;
+        }
+        return copied;
+    }
+
+    GLintptr offset(int handle) const {
+        return this->allocations[handle].offset;
+    }
+
+    GLsizeiptr size(int handle) const {
+        return this->allocations[handle].size;
+    }
+
+    GLuint buffer() const {
+        return this->buf;
+    }
+
+    // muda sempre que compact() move algum bloco
+    unsigned int generation() const {
+        return this->moves;
+    }
+
+    GLsizeiptr getCapacity() const {
+        return this->capacity;
+    }
+
+    GLsizeiptr liveBytes() const {
+        return this->live;
+    }
+
+    // fim do último bloco vivo: o quanto do buffer está de fato em uso
+    GLintptr highWater() const {
+        int top = this->lastPhys;
+        while (top >= 0 && this->blocks[top].handle < 0) {
+            top = this->blocks[top].prevPhys;
+        }
+        return top < 0 ? 0 : this->blocks[top].offset + this->blocks[top].size;
+    }
+};
+
+#endif /* BufferArena_h */
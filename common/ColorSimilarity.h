@@ -0,0 +1,271 @@
+#ifndef ColorSimilarity_h
+#define ColorSimilarity_h
+
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Eliminação de cores parecidas do jogo das cores.
+//
+// As cores ficam em SoA (um array por canal) e a comparação é feita com a
+// distância ao quadrado contra um limiar já elevado ao quadrado: a tolerância
+// normalizada t vira (t * sqrt(3))^2 = 3 * t^2, sem sqrt nem divisão por
+// célula. O laço compara 8 células por vez com AVX2 (PGCC_NATIVE_ARCH).
+//
+// Para grades muito grandes há um índice opcional (buildIndex): o cubo RGB é
+// dividido em buckets uniformes e as células vivas de cada bucket ficam
+// contíguas. Um clique só visita os buckets que a esfera de tolerância toca;
+// buckets inteiramente dentro dela são eliminados sem teste, e as células
+// eliminadas saem do bucket, então cada célula é testada cada vez menos.
+//
+// As cores são canais em [0, 1]. Uma célula eliminada continua no array (o
+// índice é estável) e só muda a marca em flags().
+
+class ColorSimilarity {
+    int count;
+    int alive;
+    std::vector<float> r, g, b;
+    std::vector<uint8_t> eliminated;
+
+    // índice por buckets (vazio quando bucketsPerAxis == 0)
+    int bucketsPerAxis;
+    std::vector<float> sortedR, sortedG, sortedB; // cores na ordem dos buckets
+    std::vector<int> sortedIndex;                  // célula de cada posição
+    std::vector<int> bucketStart;                  // primeira posição do bucket
+    std::vector<int> bucketAlive;                  // vivas no começo do bucket
+
+    static float square(float v) {
+        return v * v;
+    }
+
+    // bit k = célula first + k está a menos de sqrt(limit2) de (cr, cg, cb)
+    static int matchMask8(const float *r, const float *g, const float *b,
+                          float cr, float cg, float cb, float limit2) {
+#if defined(__AVX2__)
+        __m256 dr = _mm256_sub_ps(_mm256_loadu_ps(r), _mm256_set1_ps(cr));
+        __m256 dg = _mm256_sub_ps(_mm256_loadu_ps(g), _mm256_set1_ps(cg));
+        __m256 db = _mm256_sub_ps(_mm256_loadu_ps(b), _mm256_set1_ps(cb));
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dr, dr), _mm256_mul_ps(dg, dg)),
+                                  _mm256_mul_ps(db, db));
+        return _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_set1_ps(limit2), _CMP_LT_OQ));
+#else
+        int mask = 0;
+        for (int k = 0; k < 8; k++) {
+            float d2 = square(r[k] - cr) + square(g[k] - cg) + square(b[k] - cb);
+            mask |= (d2 < limit2) << k;
+        }
+        return mask;
+#endif
+    }
+
+    int bucketOf(float v) const {
+        int bucket = (int) (v * this->bucketsPerAxis);
+        if (bucket < 0) {
+            return 0;
+        }
+        return bucket < this->bucketsPerAxis ? bucket : this->bucketsPerAxis - 1;
+    }
+
+    void eliminate(int index, std::vector<int> &out) {
+        this->eliminated[index] = 1;
+        this->alive--;
+        out.push_back(index);
+    }
+
+    void scanAll(float cr, float cg, float cb, float limit2, std::vector<int> &out) {
+        int i = 0;
+        for (; i + 8 <= this->count; i += 8) {
+            int mask = matchMask8(&this->r[i], &this->g[i], &this->b[i], cr, cg, cb, limit2);
+            if (mask == 0) {
+                continue;
+            }
+            for (int k = 0; k < 8; k++) {
+                if (((mask >> k) & 1) && !this->eliminated[i + k]) {
+                    eliminate(i + k, out);
+                }
+            }
+        }
+        for (; i < this->count; i++) {
+            float d2 = square(this->r[i] - cr) + square(this->g[i] - cg) + square(this->b[i] - cb);
+            if (d2 < limit2 && !this->eliminated[i]) {
+                eliminate(i, out);
+            }
+        }
+    }
+
+    // testa as vivas do bucket e compacta as que sobram no começo dele
+    void scanBucket(int bucket, float cr, float cg, float cb, float limit2, std::vector<int> &out) {
+        int first = this->bucketStart[bucket];
+        int end = first + this->bucketAlive[bucket];
+        int write = first;
+        int i = first;
+        for (; i + 8 <= end; i += 8) {
+            int mask = matchMask8(&this->sortedR[i], &this->sortedG[i], &this->sortedB[i], cr, cg, cb, limit2);
+            for (int k = 0; k < 8; k++) {
+                if ((mask >> k) & 1) {
+                    eliminate(this->sortedIndex[i + k], out);
+                } else {
+                    keep(i + k, write++);
+                }
+            }
+        }
+        for (; i < end; i++) {
+            float d2 = square(this->sortedR[i] - cr) + square(this->sortedG[i] - cg) + square(this->sortedB[i] - cb);
+            if (d2 < limit2) {
+                eliminate(this->sortedIndex[i], out);
+            } else {
+                keep(i, write++);
+            }
+        }
+        this->bucketAlive[bucket] = write - first;
+    }
+
+    void keep(int from, int to) {
+        this->sortedR[to] = this->sortedR[from];
+        this->sortedG[to] = this->sortedG[from];
+        this->sortedB[to] = this->sortedB[from];
+        this->sortedIndex[to] = this->sortedIndex[from];
+    }
+
+    void scanIndex(float cr, float cg, float cb, float limit2, std::vector<int> &out) {
+        float radius = sqrtf(limit2);
+        float size = 1.0f / this->bucketsPerAxis;
+        int n = this->bucketsPerAxis;
+        int r0 = bucketOf(cr - radius), r1 = bucketOf(cr + radius);
+        int g0 = bucketOf(cg - radius), g1 = bucketOf(cg + radius);
+        int b0 = bucketOf(cb - radius), b1 = bucketOf(cb + radius);
+        for (int br = r0; br <= r1; br++) {
+            // distâncias mínima e máxima de cada eixo até o intervalo do bucket
+            float nearR = square(fmaxf(fmaxf(br * size - cr, cr - (br + 1) * size), 0.0f));
+            float farR = square(fmaxf(cr - br * size, (br + 1) * size - cr));
+            for (int bg = g0; bg <= g1; bg++) {
+                float nearG = square(fmaxf(fmaxf(bg * size - cg, cg - (bg + 1) * size), 0.0f));
+                float farG = square(fmaxf(cg - bg * size, (bg + 1) * size - cg));
+                for (int bb = b0; bb <= b1; bb++) {
+                    int bucket = (br * n + bg) * n + bb;
+                    if (this->bucketAlive[bucket] == 0) {
+                        continue;
+                    }
+                    float nearB = square(fmaxf(fmaxf(bb * size - cb, cb - (bb + 1) * size), 0.0f));
+                    if (nearR + nearG + nearB >= limit2) {
+                        continue; // o bucket inteiro está fora da esfera
+                    }
+                    float farB = square(fmaxf(cb - bb * size, (bb + 1) * size - cb));
+                    if (farR + farG + farB < limit2) {
+                        // o bucket inteiro está dentro: elimina sem testar
+                        int first = this->bucketStart[bucket];
+                        for (int i = first; i < first + this->bucketAlive[bucket]; i++) {
+                            eliminate(this->sortedIndex[i], out);
+                        }
+                        this->bucketAlive[bucket] = 0;
+                        continue;
+                    }
+                    scanBucket(bucket, cr, cg, cb, limit2, out);
+                }
+            }
+        }
+    }
+
+public:
+    ColorSimilarity() : count(0), alive(0), bucketsPerAxis(0) {}
+
+    // count células, todas vivas e pretas; descarta o índice
+    void resize(int count) {
+        this->count = count;
+        this->alive = count;
+        this->r.assign(count, 0.0f);
+        this->g.assign(count, 0.0f);
+        this->b.assign(count, 0.0f);
+        this->eliminated.assign(count, 0);
+        this->bucketsPerAxis = 0;
+    }
+
+    // chamar antes de buildIndex (ou refazer o índice depois)
+    void setColor(int index, float r, float g, float b) {
+        this->r[index] = r;
+        this->g[index] = g;
+        this->b[index] = b;
+    }
+
+    // Monta o índice com bucketsPerAxis^3 buckets (0 desliga). Só células
+    // vivas entram. Vale a pena a partir de centenas de milhares de células;
+    // 16 por eixo serve para tolerâncias em torno de 0.2.
+    void buildIndex(int bucketsPerAxis) {
+        this->bucketsPerAxis = bucketsPerAxis;
+        if (bucketsPerAxis <= 0) {
+            this->bucketsPerAxis = 0;
+            return;
+        }
+        int buckets = bucketsPerAxis * bucketsPerAxis * bucketsPerAxis;
+        std::vector<int> cellBucket(this->count);
+        this->bucketStart.assign(buckets + 1, 0);
+        this->bucketAlive.assign(buckets, 0);
+        for (int i = 0; i < this->count; i++) {
+            if (this->eliminated[i]) {
+                cellBucket[i] = -1;
+                continue;
+            }
+            cellBucket[i] = (bucketOf(this->r[i]) * bucketsPerAxis + bucketOf(this->g[i])) * bucketsPerAxis +
+                            bucketOf(this->b[i]);
+            this->bucketAlive[cellBucket[i]]++;
+        }
+        for (int i = 0; i < buckets; i++) {
+            this->bucketStart[i + 1] = this->bucketStart[i] + this->bucketAlive[i];
+        }
+        // counting sort: a ordem dentro do bucket segue a das células
+        int total = this->bucketStart[buckets];
+        this->sortedR.resize(total);
+        this->sortedG.resize(total);
+        this->sortedB.resize(total);
+        this->sortedIndex.resize(total);
+        std::vector<int> next(this->bucketStart.begin(), this->bucketStart.end() - 1);
+        for (int i = 0; i < this->count; i++) {
+            if (cellBucket[i] < 0) {
+                continue;
+            }
+            int at = next[cellBucket[i]]++;
+            this->sortedR[at] = this->r[i];
+            this->sortedG[at] = this->g[i];
+            this->sortedB[at] = this->b[i];
+            this->sortedIndex[at] = i;
+        }
+    }
+
+    // Elimina as células vivas cuja distância normalizada até a cor da célula
+    // `index` é menor que `tolerance` (a própria célula inclusive) e acrescenta
+    // os índices delas a `out` (em ordem crescente só sem índice). Retorna
+    // quantas foram eliminadas.
+    int eliminateSimilar(int index, float tolerance, std::vector<int> &out) {
+        size_t before = out.size();
+        float limit2 = 3.0f * tolerance * tolerance;
+        float cr = this->r[index], cg = this->g[index], cb = this->b[index];
+        if (this->bucketsPerAxis > 0) {
+            scanIndex(cr, cg, cb, limit2, out);
+        } else {
+            scanAll(cr, cg, cb, limit2, out);
+        }
+        return (int) (out.size() - before);
+    }
+
+    bool isEliminated(int index) const {
+        return this->eliminated[index] != 0;
+    }
+
+    // uma marca (0 ou 1) por célula, pronta para ir para um buffer da GPU
+    const uint8_t *flags() const {
+        return this->eliminated.data();
+    }
+
+    int size() const {
+        return this->count;
+    }
+
+    int remaining() const {
+        return this->alive;
+    }
+};
+
+#endif /* ColorSimilarity_h */
@@ -0,0 +1,153 @@
+#ifndef Entities_h
+#define Entities_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "TileMap.h"
+
+// Entidades guardadas como estrutura de arrays (SoA): cada atributo é um vetor
+// contíguo e cada sistema é um laço simples sobre um intervalo [first, first+count),
+// o que permite dividir o trabalho entre threads e escalar para centenas de
+// milhares de personagens.
+//
+// Posições são em tiles, na convenção do TileMap: col = x do mapa, row = y.
+// A animação é avaliada na GPU (ver AnimationClips.h): cada entidade guarda só
+// o clipe atual e o instante em que ele começou.
+
+// direções = ordem das linhas nos clipes direcionais (jorge.png)
+#define ENTITY_DOWN 0
+#define ENTITY_LEFT 1
+#define ENTITY_RIGHT 2
+#define ENTITY_UP 3
+
+// dados por instância para desenho instanciado (16 bytes)
+struct EntityInstance {
+    float x, y;               // posição na tela
+    float clipStart;          // instante em que o clipe começou
+    uint16_t clip, direction; // id na AnimationClipTable, ENTITY_DOWN..ENTITY_UP
+};
+
+class EntityStore {
+public:
+    std::vector<int32_t> col, row;           // tile ocupado
+    std::vector<int32_t> moveCol, moveRow;   // passo pedido para o próximo movimento
+    std::vector<uint8_t> direction;          // ENTITY_DOWN..ENTITY_UP
+    std::vector<uint16_t> clip;              // clipe de animação atual
+    std::vector<float> clipStart;            // instante (segundos) em que o clipe começou
+    std::vector<uint8_t> onHazard;           // preenchido por collideEntities
+
+    int size() const {
+        return (int) this->col.size();
+    }
+
+    void reserve(int n) {
+        this->col.reserve(n);
+        this->row.reserve(n);
+        this->moveCol.reserve(n);
+        this->moveRow.reserve(n);
+        this->direction.reserve(n);
+        this->clip.reserve(n);
+        this->clipStart.reserve(n);
+        this->onHazard.reserve(n);
+    }
+
+    int create(int col, int row, uint16_t clip, float clipStart) {
+        this->col.push_back(col);
+        this->row.push_back(row);
+        this->moveCol.push_back(0);
+        this->moveRow.push_back(0);
+        this->direction.push_back(ENTITY_DOWN);
+        this->clip.push_back(clip);
+        this->clipStart.push_back(clipStart);
+        this->onHazard.push_back(0);
+        return size() - 1;
+    }
+
+    // troca o clipe; tocar de novo o clipe atual não o reinicia
+    void playClip(int id, uint16_t clip, float now) {
+        if (this->clip[id] != clip) {
+            this->clip[id] = clip;
+            this->clipStart[id] = now;
+        }
+    }
+
+    // remove trocando com a última entidade: o id da última passa a ser `id`
+    void destroy(int id) {
+        int last = size() - 1;
+        this->col[id] = this->col[last];
+        this->row[id] = this->row[last];
+        this->moveCol[id] = this->moveCol[last];
+        this->moveRow[id] = this->moveRow[last];
+        this->direction[id] = this->direction[last];
+        this->clip[id] = this->clip[last];
+        this->clipStart[id] = this->clipStart[last];
+        this->onHazard[id] = this->onHazard[last];
+        this->col.pop_back();
+        this->row.pop_back();
+        this->moveCol.pop_back();
+        this->moveRow.pop_back();
+        this->direction.pop_back();
+        this->clip.pop_back();
+        this->clipStart.pop_back();
+        this->onHazard.pop_back();
+    }
+};
+
+// Movimento: aplica (moveCol, moveRow) contra o bitboard do mapa, atualiza a
+// direção pelo passo pedido (mesmo quando bloqueado) e zera os pedidos.
+// Retorna quantas entidades andaram.
+inline int moveEntities(EntityStore &e, TileMap &map, int first, int count) {
+    int32_t *moveCol = e.moveCol.data() + first;
+    int32_t *moveRow = e.moveRow.data() + first;
+    uint8_t *direction = e.direction.data() + first;
+    for (int i = 0; i < count; i++) {
+        // na projeção isométrica, col+row cresce "para baixo" na tela
+        int down = moveCol[i] + moveRow[i];
+        if (down < 0) {
+            direction[i] = ENTITY_UP;
+        } else if (down > 0) {
+            direction[i] = ENTITY_DOWN;
+        } else if (moveCol[i] < 0) {
+            direction[i] = ENTITY_LEFT;
+        } else if (moveCol[i] > 0) {
+            direction[i] = ENTITY_RIGHT;
+        }
+    }
+    int moved = map.moveBatch(e.col.data() + first, e.row.data() + first, moveCol, moveRow, count);
+    for (int i = 0; i < count; i++) {
+        moveCol[i] = 0;
+        moveRow[i] = 0;
+    }
+    return moved;
+}
+
+// Colisão com o cenário: onHazard = entidade parada em tile TILE_HAZARD.
+// Retorna quantas entidades estão em perigo.
+inline int collideEntities(EntityStore &e, TileMap &map, int first, int count) {
+    return map.hazardBatch(e.col.data() + first, e.row.data() + first, count, e.onHazard.data() + first);
+}
+
+// Instâncias de desenho: converte tile -> tela na projeção isométrica usada pelo
+// TrabalhoGB (origem do tile (0,0) em originX/originY) e copia o estado da
+// animação. Retorna o número de instâncias escritas em `out`.
+inline int buildEntityInstances(const EntityStore &e, float tileW, float tileH, float originX, float originY,
+                                int first, int count, EntityInstance *out) {
+    const int32_t *col = e.col.data() + first;
+    const int32_t *row = e.row.data() + first;
+    const uint8_t *direction = e.direction.data() + first;
+    const uint16_t *clip = e.clip.data() + first;
+    const float *clipStart = e.clipStart.data() + first;
+    const float halfW = tileW / 2.0f;
+    const float halfH = tileH / 2.0f;
+    for (int i = 0; i < count; i++) {
+        out[i].x = (col[i] - row[i]) * halfW + originX;
+        out[i].y = (col[i] + row[i]) * halfH + originY;
+        out[i].clipStart = clipStart[i];
+        out[i].clip = clip[i];
+        out[i].direction = direction[i];
+    }
+    return count;
+}
+
+#endif /* Entities_h */
@@ -0,0 +1,96 @@
+#ifndef FrameArena_h
+#define FrameArena_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+// Memória de rascunho de um quadro.
+//
+// allocate() só avança um ponteiro dentro de um bloco reservado uma vez;
+// reset(), no começo de cada quadro, devolve tudo de uma vez. Serve para dados
+// que vivem só até o fim do quadro (instâncias montadas para um envio à GPU,
+// listas temporárias), sem new/delete por quadro. Os objetos não são
+// destruídos, então só tipos trivialmente destrutíveis.
+//
+// Se um quadro pedir mais do que cabe, o excesso vem de blocos extras e o
+// próximo reset() troca o bloco principal por um do tamanho do maior quadro
+// visto: depois de alguns quadros a arena não aloca mais nada.
+//
+//     FrameArena arena;
+//     while (...) {
+//         arena.reset();
+//         EntityInstance *out = arena.allocate<EntityInstance>(count);
+//         ...
+//     }
+
+class FrameArena {
+    unsigned char *block;
+    size_t capacity;
+    size_t used;
+    std::vector<unsigned char *> overflow; // blocos extras do quadro atual
+    size_t overflowBytes;
+
+    static size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024)
+        : block(new unsigned char[capacity]), capacity(capacity), used(0), overflowBytes(0) {}
+
+    ~FrameArena() {
+        reset();
+        delete[] this->block;
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // `align` precisa ser potência de 2 e no máximo alignof(max_align_t)
+    void *allocate(size_t bytes, size_t align = alignof(max_align_t)) {
+        size_t offset = alignUp(this->used, align);
+        if (offset + bytes <= this->capacity) {
+            this->used = offset + bytes;
+            return this->block + offset;
+        }
+        unsigned char *extra = new unsigned char[bytes > 0 ? bytes : 1];
+        this->overflow.push_back(extra);
+        this->overflowBytes += bytes + align;
+        return extra;
+    }
+
+    template <typename T>
+    T *allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "a FrameArena não chama destrutores");
+        return (T *) allocate(count * sizeof(T), alignof(T));
+    }
+
+    // Libera tudo o que foi alocado desde o último reset. Os ponteiros
+    // devolvidos antes deixam de valer.
+    void reset() {
+        if (!this->overflow.empty()) {
+            for (size_t i = 0; i < this->overflow.size(); i++) {
+                delete[] this->overflow[i];
+            }
+            this->overflow.clear();
+            size_t needed = this->used + this->overflowBytes;
+            delete[] this->block;
+            this->capacity = needed + needed / 2;
+            this->block = new unsigned char[this->capacity];
+            this->overflowBytes = 0;
+        }
+        this->used = 0;
+    }
+
+    size_t bytesUsed() const {
+        return this->used + this->overflowBytes;
+    }
+
+    size_t bytesReserved() const {
+        return this->capacity;
+    }
+};
+
+#endif /* FrameArena_h */
@@ -0,0 +1,187 @@
+#ifndef GeometryPool_h
+#define GeometryPool_h
+
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "BufferArena.h"
+
+// Pool de geometria: um único VBO (e um VAO) compartilhado por todas as
+// primitivas criadas em tempo de execução.
+//
+// Os vértices de cada primitiva ficam em uma alocação de um BufferArena,
+// alinhada ao tamanho do vértice para poder ser desenhada com `first`.
+// release() devolve a alocação ao arena e o id é reaproveitado; compact() move
+// primitivas para fechar os buracos que ficaram. Quando o arena cresce ou move
+// dados, o VAO e a lista de desenho são refeitos no próximo draw(). draw()
+// desenha todas as primitivas vivas, na ordem de criação, com um único
+// glMultiDrawArrays.
+//
+// Os vértices são floats intercalados; addAttribute() descreve o layout (na
+// ordem em que os atributos aparecem no vértice) antes de init().
+
+class GeometryPool {
+    struct Attribute {
+        GLuint location;
+        GLint components;
+    };
+
+    BufferArena arena;
+    GLuint vao;
+    GLuint attachedBuffer;     // buffer que o VAO aponta
+    unsigned int drawnGeneration;
+    GLint floatsPerVertex;
+    std::vector<Attribute> attributes;
+
+    std::vector<int> allocations;  // handle no arena por id; -1 quando livre
+    std::vector<GLsizei> counts;
+    std::vector<int> freeIds;
+    std::vector<int> releasedIds;  // ainda em drawOrder; viram livres no rebuild
+    std::vector<int> drawOrder;    // ids na ordem de criação (pode ter ids liberados)
+    std::vector<GLint> drawFirst;
+    std::vector<GLsizei> drawCount;
+    bool drawListDirty;
+
+    GLsizeiptr vertexBytes() const {
+        return this->floatsPerVertex * sizeof(GLfloat);
+    }
+
+    void setupAttributes() {
+        glBindVertexArray(this->vao);
+        glBindBuffer(GL_ARRAY_BUFFER, this->arena.buffer());
+        GLsizei stride = this->floatsPerVertex * sizeof(GLfloat);
+        int offset = 0;
+        for (size_t i = 0; i < this->attributes.size(); i++) {
+            glVertexAttribPointer(this->attributes[i].location, this->attributes[i].components, GL_FLOAT, GL_FALSE,
+                                  stride, (GLvoid *) (offset * sizeof(GLfloat)));
+            glEnableVertexAttribArray(this->attributes[i].location);
+            offset += this->attributes[i].components;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+        this->attachedBuffer = this->arena.buffer();
+    }
+
+    void rebuildDrawList() {
+        this->drawFirst.clear();
+        this->drawCount.clear();
+        size_t kept = 0;
+        for (size_t i = 0; i < this->drawOrder.size(); i++) {
+            int id = this->drawOrder[i];
+            if (this->allocations[id] < 0) {
+                continue; // liberado
+            }
+            this->drawOrder[kept++] = id;
+            this->drawFirst.push_back((GLint) (this->arena.offset(this->allocations[id]) / vertexBytes()));
+            this->drawCount.push_back(this->counts[id]);
+        }
+        this->drawOrder.resize(kept);
+        this->freeIds.insert(this->freeIds.end(), this->releasedIds.begin(), this->releasedIds.end());
+        this->releasedIds.clear();
+        this->drawnGeneration = this->arena.generation();
+        this->drawListDirty = false;
+    }
+
+public:
+    GeometryPool()
+        : arena(GL_DYNAMIC_DRAW), vao(0), attachedBuffer(0), drawnGeneration(0), floatsPerVertex(0),
+          drawListDirty(false) {}
+
+    ~GeometryPool() {
+        glDeleteVertexArrays(1, &this->vao);
+    }
+
+    GeometryPool(const GeometryPool &) = delete;
+    GeometryPool &operator=(const GeometryPool &) = delete;
+
+    void addAttribute(GLuint location, GLint components) {
+        Attribute attribute = {location, components};
+        this->attributes.push_back(attribute);
+        this->floatsPerVertex += components;
+    }
+
+    // cria o VAO e um buffer inicial para `initialVertices` vértices
+    void init(GLint initialVertices = 1024) {
+        glGenVertexArrays(1, &this->vao);
+        this->arena.init(initialVertices * vertexBytes());
+        setupAttributes();
+    }
+
+    // Copia `vertexCount` vértices para o pool e retorna o id da primitiva.
+    int allocate(const GLfloat *vertices, GLsizei vertexCount) {
+        if (vertexCount <= 0) {
+            std::cerr << "GeometryPool: primitiva sem vértices" << std::endl;
+            return -1;
+        }
+        int allocation = this->arena.allocate(vertices, vertexCount * vertexBytes(), vertexBytes());
+
+        int id;
+        if (!this->freeIds.empty()) {
+            id = this->freeIds.back();
+            this->freeIds.pop_back();
+            this->allocations[id] = allocation;
+            this->counts[id] = vertexCount;
+        } else {
+            id = (int) this->allocations.size();
+            this->allocations.push_back(allocation);
+            this->counts.push_back(vertexCount);
+        }
+        this->drawOrder.push_back(id);
+        this->drawListDirty = true;
+        return id;
+    }
+
+    // sobrescreve os vértices da primitiva `id` (mesma quantidade)
+    void update(int id, const GLfloat *vertices) {
+        this->arena.upload(this->allocations[id], vertices, this->counts[id] * vertexBytes());
+    }
+
+    void release(int id) {
+        if (id < 0 || id >= (int) this->allocations.size() || this->allocations[id] < 0) {
+            return;
+        }
+        this->arena.release(this->allocations[id]);
+        this->allocations[id] = -1;
+        this->releasedIds.push_back(id);
+        this->drawListDirty = true;
+    }
+
+    // Move até `byteBudget` bytes de primitivas para os buracos deixados por
+    // release(). Feito um pouco por quadro, mantém o buffer denso sem pausas.
+    // Retorna os bytes movidos: 0 quando não há mais nada a compactar.
+    GLsizeiptr compact(GLsizeiptr byteBudget = 64 * 1024) {
+        return this->arena.compact(byteBudget);
+    }
+
+    // todas as primitivas vivas em uma chamada (o programa já deve estar em uso)
+    void draw(GLenum mode) {
+        if (this->attachedBuffer != this->arena.buffer()) {
+            setupAttributes(); // o VAO guarda o buffer de cada atributo
+        }
+        if (this->drawListDirty || this->drawnGeneration != this->arena.generation()) {
+            rebuildDrawList();
+        }
+        if (this->drawFirst.empty()) {
+            return;
+        }
+        glBindVertexArray(this->vao);
+        glMultiDrawArrays(mode, this->drawFirst.data(), this->drawCount.data(), (GLsizei) this->drawFirst.size());
+        glBindVertexArray(0);
+    }
+
+    int primitiveCount() {
+        if (this->drawListDirty) {
+            rebuildDrawList();
+        }
+        return (int) this->drawOrder.size();
+    }
+
+    // em vértices
+    GLint getCapacity() const {
+        return (GLint) (this->arena.getCapacity() / vertexBytes());
+    }
+};
+
+#endif /* GeometryPool_h */
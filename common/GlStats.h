@@ -0,0 +1,604 @@
+#ifndef GlStats_h
+#define GlStats_h
+
+#include <glad/glad.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#define GL_STATS_CALLER() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define GL_STATS_CALLER() _ReturnAddress()
+#else
+#define GL_STATS_CALLER() ((void *) 0)
+#endif
+
+// Contagem das chamadas OpenGL por quadro.
+//
+// Ligado, troca os ponteiros da tabela da GLAD (glad_glDrawArrays...) por
+// funções que contam e repassam a chamada; desligado, devolve os ponteiros
+// originais, então o custo é zero: o programa chama o driver direto, como
+// sem este header. Conta, por quadro:
+//
+//   draws, vértices e instâncias    glDraw*, glMultiDrawArrays
+//   mudanças de estado              binds, glUseProgram, glEnable, blend...
+//   uniforms                        glUniform*
+//   bytes enviados                  glBuffer(Sub)Data, glCopyBufferSubData,
+//                                   glTex(Sub)Image2D/3D
+//   glGetUniformLocation
+//
+// As demais funções que os programas usam (glClear, criação e remoção de
+// objetos, shaders, consultas como glGetError) entram só nas chamadas e na
+// tabela por ponto de chamada. Função nova no código = entrada nova em
+// GL_STATS_FUNCTIONS; sem ela a chamada não aparece em lugar nenhum.
+//
+// e, por ponto de chamada (endereço de retorno), quantas vezes cada função foi
+// chamada dali. Uso, depois de carregar a GLAD e na thread do contexto:
+//
+//     GlStats::initFromEnvironment();   // PGCC_GL_STATS=<N> liga no início
+//     ...
+//     glfwSwapBuffers(window);
+//     GlStats::frame();                 // fecha o quadro; resumo a cada N
+//
+// GlStats::setEnabled(false) (ou toggle()) imprime a tabela por ponto de
+// chamada. Sem -rdynamic as funções do próprio executável aparecem como
+// executável+deslocamento; `addr2line -f -C -e <executável> <deslocamento>`
+// dá a linha.
+
+struct GlFrameStats {
+    uint64_t calls;
+    uint64_t draws;
+    uint64_t vertices;
+    uint64_t instances;
+    uint64_t stateChanges;
+    uint64_t uniforms;
+    uint64_t bufferBytes;
+    uint64_t textureBytes;
+    uint64_t uniformLocations;
+
+    void add(const GlFrameStats &other) {
+        this->calls += other.calls;
+        this->draws += other.draws;
+        this->vertices += other.vertices;
+        this->instances += other.instances;
+        this->stateChanges += other.stateChanges;
+        this->uniforms += other.uniforms;
+        this->bufferBytes += other.bufferBytes;
+        this->textureBytes += other.textureBytes;
+        this->uniformLocations += other.uniformLocations;
+    }
+};
+
+struct GlCallSite {
+    const char *function;
+    uint64_t calls;
+    uint64_t amount; // vértices ou bytes, conforme a função
+};
+
+// funções interceptadas: X(nome sem o prefixo gl, tipo do ponteiro)
+#define GL_STATS_FUNCTIONS(X)                                                 \
+    X(DrawArrays, PFNGLDRAWARRAYSPROC)                                        \
+    X(DrawArraysInstanced, PFNGLDRAWARRAYSINSTANCEDPROC)                      \
+    X(DrawElements, PFNGLDRAWELEMENTSPROC)                                    \
+    X(DrawElementsBaseVertex, PFNGLDRAWELEMENTSBASEVERTEXPROC)                \
+    X(DrawElementsInstanced, PFNGLDRAWELEMENTSINSTANCEDPROC)                  \
+    X(DrawElementsInstancedBaseVertex, PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC) \
+    X(MultiDrawArrays, PFNGLMULTIDRAWARRAYSPROC)                              \
+    X(BindVertexArray, PFNGLBINDVERTEXARRAYPROC)                              \
+    X(BindBuffer, PFNGLBINDBUFFERPROC)                                        \
+    X(BindTexture, PFNGLBINDTEXTUREPROC)                                      \
+    X(ActiveTexture, PFNGLACTIVETEXTUREPROC)                                  \
+    X(UseProgram, PFNGLUSEPROGRAMPROC)                                        \
+    X(Enable, PFNGLENABLEPROC)                                                \
+    X(Disable, PFNGLDISABLEPROC)                                              \
+    X(BlendFunc, PFNGLBLENDFUNCPROC)                                          \
+    X(DepthFunc, PFNGLDEPTHFUNCPROC)                                          \
+    X(Viewport, PFNGLVIEWPORTPROC)                                            \
+    X(LineWidth, PFNGLLINEWIDTHPROC)                                          \
+    X(PointSize, PFNGLPOINTSIZEPROC)                                          \
+    X(PixelStorei, PFNGLPIXELSTOREIPROC)                                      \
+    X(TexParameteri, PFNGLTEXPARAMETERIPROC)                                  \
+    X(TexParameterf, PFNGLTEXPARAMETERFPROC)                                  \
+    X(ClearColor, PFNGLCLEARCOLORPROC)                                        \
+    X(VertexAttribPointer, PFNGLVERTEXATTRIBPOINTERPROC)                      \
+    X(VertexAttribIPointer, PFNGLVERTEXATTRIBIPOINTERPROC)                    \
+    X(EnableVertexAttribArray, PFNGLENABLEVERTEXATTRIBARRAYPROC)              \
+    X(VertexAttribDivisor, PFNGLVERTEXATTRIBDIVISORPROC)                      \
+    X(Uniform1i, PFNGLUNIFORM1IPROC)                                          \
+    X(Uniform1f, PFNGLUNIFORM1FPROC)                                          \
+    X(Uniform2f, PFNGLUNIFORM2FPROC)                                          \
+    X(Uniform2i, PFNGLUNIFORM2IPROC)                                          \
+    X(Uniform3f, PFNGLUNIFORM3FPROC)                                          \
+    X(Uniform4f, PFNGLUNIFORM4FPROC)                                          \
+    X(Uniform1iv, PFNGLUNIFORM1IVPROC)                                        \
+    X(Uniform4iv, PFNGLUNIFORM4IVPROC)                                        \
+    X(Uniform4fv, PFNGLUNIFORM4FVPROC)                                        \
+    X(UniformMatrix4fv, PFNGLUNIFORMMATRIX4FVPROC)                            \
+    X(BufferData, PFNGLBUFFERDATAPROC)                                        \
+    X(BufferSubData, PFNGLBUFFERSUBDATAPROC)                                  \
+    X(CopyBufferSubData, PFNGLCOPYBUFFERSUBDATAPROC)                          \
+    X(TexImage2D, PFNGLTEXIMAGE2DPROC)                                        \
+    X(TexSubImage2D, PFNGLTEXSUBIMAGE2DPROC)                                  \
+    X(TexImage3D, PFNGLTEXIMAGE3DPROC)                                        \
+    X(TexSubImage3D, PFNGLTEXSUBIMAGE3DPROC)                                  \
+    X(GetUniformLocation, PFNGLGETUNIFORMLOCATIONPROC)                        \
+    X(Clear, PFNGLCLEARPROC)                                                  \
+    X(GenerateMipmap, PFNGLGENERATEMIPMAPPROC)                                \
+    X(GenBuffers, PFNGLGENBUFFERSPROC)                                        \
+    X(GenTextures, PFNGLGENTEXTURESPROC)                                      \
+    X(GenVertexArrays, PFNGLGENVERTEXARRAYSPROC)                              \
+    X(DeleteBuffers, PFNGLDELETEBUFFERSPROC)                                  \
+    X(DeleteTextures, PFNGLDELETETEXTURESPROC)                                \
+    X(DeleteVertexArrays, PFNGLDELETEVERTEXARRAYSPROC)                        \
+    X(CreateShader, PFNGLCREATESHADERPROC)                                    \
+    X(ShaderSource, PFNGLSHADERSOURCEPROC)                                    \
+    X(CompileShader, PFNGLCOMPILESHADERPROC)                                  \
+    X(DeleteShader, PFNGLDELETESHADERPROC)                                    \
+    X(CreateProgram, PFNGLCREATEPROGRAMPROC)                                  \
+    X(AttachShader, PFNGLATTACHSHADERPROC)                                    \
+    X(LinkProgram, PFNGLLINKPROGRAMPROC)                                      \
+    X(ValidateProgram, PFNGLVALIDATEPROGRAMPROC)                              \
+    X(DeleteProgram, PFNGLDELETEPROGRAMPROC)                                  \
+    X(GetShaderiv, PFNGLGETSHADERIVPROC)                                      \
+    X(GetShaderInfoLog, PFNGLGETSHADERINFOLOGPROC)                            \
+    X(GetProgramiv, PFNGLGETPROGRAMIVPROC)                                    \
+    X(GetProgramInfoLog, PFNGLGETPROGRAMINFOLOGPROC)                          \
+    X(GetActiveUniform, PFNGLGETACTIVEUNIFORMPROC)                            \
+    X(GetError, PFNGLGETERRORPROC)                                            \
+    X(GetFloatv, PFNGLGETFLOATVPROC)                                          \
+    X(GetIntegerv, PFNGLGETINTEGERVPROC)                                      \
+    X(GetString, PFNGLGETSTRINGPROC)                                          \
+    X(IsEnabled, PFNGLISENABLEDPROC)
+
+class GlStats {
+    enum Kind { DRAW, STATE, UNIFORM, BUFFER, TEXTURE, LOCATION, OTHER };
+
+#define GL_STATS_MEMBER(name, type) type name;
+    struct Functions {
+        GL_STATS_FUNCTIONS(GL_STATS_MEMBER)
+    };
+#undef GL_STATS_MEMBER
+
+    struct State {
+        bool enabled;
+        int interval; // quadros por linha de resumo
+        Functions real; // ponteiros originais da GLAD
+        GlFrameStats current;
+        GlFrameStats last;
+        GlFrameStats window; // soma dos quadros desde o último resumo
+        int windowFrames;
+        uint64_t frames; // desde que foi ligado
+        std::unordered_map<const void *, GlCallSite> sites;
+    };
+
+    static State &state() {
+        static State instance = State();
+        return instance;
+    }
+
+    static void record(const void *site, const char *function, Kind kind, uint64_t amount, uint64_t instances = 0) {
+        State &s = state();
+        GlFrameStats &f = s.current;
+        f.calls++;
+        switch (kind) {
+        case DRAW:
+            f.draws++;
+            f.vertices += amount;
+            f.instances += instances;
+            break;
+        case STATE:
+            f.stateChanges++;
+            break;
+        case UNIFORM:
+            f.uniforms++;
+            break;
+        case BUFFER:
+            f.bufferBytes += amount;
+            break;
+        case TEXTURE:
+            f.textureBytes += amount;
+            break;
+        case LOCATION:
+            f.uniformLocations++;
+            break;
+        case OTHER:
+            break;
+        }
+
+        GlCallSite &entry = s.sites[site];
+        entry.function = function;
+        entry.calls++;
+        entry.amount += amount;
+    }
+
+    // bytes de um pixel em glTexImage* (sem o alinhamento das linhas)
+    static uint64_t pixelBytes(GLenum format, GLenum type) {
+        switch (type) {
+        case GL_UNSIGNED_SHORT_5_6_5:
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+            return 2;
+        case GL_UNSIGNED_INT_8_8_8_8:
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        case GL_UNSIGNED_INT_24_8:
+            return 4;
+        }
+
+        uint64_t components = 4;
+        switch (format) {
+        case GL_RED:
+        case GL_RED_INTEGER:
+        case GL_DEPTH_COMPONENT:
+        case GL_STENCIL_INDEX:
+            components = 1;
+            break;
+        case GL_RG:
+        case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+        case GL_RGB_INTEGER:
+            components = 3;
+            break;
+        }
+
+        switch (type) {
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return components * 4;
+        default:
+            return components;
+        }
+    }
+
+    static uint64_t texelBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type,
+                               const void *pixels) {
+        // sem ponteiro (ou com um PBO ligado) nada sai da memória da CPU agora
+        if (pixels == NULL) {
+            return 0;
+        }
+        return (uint64_t) width * height * depth * pixelBytes(format, type);
+    }
+
+#define GL_STATS_HOOK(name, kind, amount, params, args)                         \
+    static void APIENTRY hook##name params {                                    \
+        record(GL_STATS_CALLER(), "gl" #name, kind, amount);                    \
+        state().real.name args;                                                 \
+    }
+
+    static void APIENTRY hookDrawArrays(GLenum mode, GLint first, GLsizei count) {
+        record(GL_STATS_CALLER(), "glDrawArrays", DRAW, count, 1);
+        state().real.DrawArrays(mode, first, count);
+    }
+
+    static void APIENTRY hookDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+        record(GL_STATS_CALLER(), "glDrawArraysInstanced", DRAW, (uint64_t) count * instances, instances);
+        state().real.DrawArraysInstanced(mode, first, count, instances);
+    }
+
+    static void APIENTRY hookDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+        record(GL_STATS_CALLER(), "glDrawElements", DRAW, count, 1);
+        state().real.DrawElements(mode, count, type, indices);
+    }
+
+    static void APIENTRY hookDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                    GLint base) {
+        record(GL_STATS_CALLER(), "glDrawElementsBaseVertex", DRAW, count, 1);
+        state().real.DrawElementsBaseVertex(mode, count, type, indices, base);
+    }
+
+    static void APIENTRY hookDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                   GLsizei instances) {
+        record(GL_STATS_CALLER(), "glDrawElementsInstanced", DRAW, (uint64_t) count * instances, instances);
+        state().real.DrawElementsInstanced(mode, count, type, indices, instances);
+    }
+
+    static void APIENTRY hookDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type,
+                                                             const void *indices, GLsizei instances, GLint base) {
+        record(GL_STATS_CALLER(), "glDrawElementsInstancedBaseVertex", DRAW, (uint64_t) count * instances,
+               instances);
+        state().real.DrawElementsInstancedBaseVertex(mode, count, type, indices, instances, base);
+    }
+
+    static void APIENTRY hookMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount) {
+        uint64_t vertices = 0;
+        for (GLsizei i = 0; i < drawcount; i++) {
+            vertices += count[i];
+        }
+        record(GL_STATS_CALLER(), "glMultiDrawArrays", DRAW, vertices, drawcount);
+        state().real.MultiDrawArrays(mode, first, count, drawcount);
+    }
+
+    GL_STATS_HOOK(BindVertexArray, STATE, 0, (GLuint array), (array))
+    GL_STATS_HOOK(BindBuffer, STATE, 0, (GLenum target, GLuint buffer), (target, buffer))
+    GL_STATS_HOOK(BindTexture, STATE, 0, (GLenum target, GLuint texture), (target, texture))
+    GL_STATS_HOOK(ActiveTexture, STATE, 0, (GLenum texture), (texture))
+    GL_STATS_HOOK(UseProgram, STATE, 0, (GLuint program), (program))
+    GL_STATS_HOOK(Enable, STATE, 0, (GLenum cap), (cap))
+    GL_STATS_HOOK(Disable, STATE, 0, (GLenum cap), (cap))
+    GL_STATS_HOOK(BlendFunc, STATE, 0, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor))
+    GL_STATS_HOOK(DepthFunc, STATE, 0, (GLenum func), (func))
+    GL_STATS_HOOK(Viewport, STATE, 0, (GLint x, GLint y, GLsizei w, GLsizei h), (x, y, w, h))
+    GL_STATS_HOOK(LineWidth, STATE, 0, (GLfloat width), (width))
+    GL_STATS_HOOK(PointSize, STATE, 0, (GLfloat size), (size))
+    GL_STATS_HOOK(PixelStorei, STATE, 0, (GLenum pname, GLint param), (pname, param))
+    GL_STATS_HOOK(TexParameteri, STATE, 0, (GLenum target, GLenum pname, GLint param), (target, pname, param))
+    GL_STATS_HOOK(TexParameterf, STATE, 0, (GLenum target, GLenum pname, GLfloat param), (target, pname, param))
+    GL_STATS_HOOK(ClearColor, STATE, 0, (GLfloat r, GLfloat g, GLfloat b, GLfloat a), (r, g, b, a))
+    GL_STATS_HOOK(VertexAttribPointer, STATE, 0,
+                  (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer),
+                  (index, size, type, normalized, stride, pointer))
+    GL_STATS_HOOK(VertexAttribIPointer, STATE, 0,
+                  (GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer),
+                  (index, size, type, stride, pointer))
+    GL_STATS_HOOK(EnableVertexAttribArray, STATE, 0, (GLuint index), (index))
+    GL_STATS_HOOK(VertexAttribDivisor, STATE, 0, (GLuint index, GLuint divisor), (index, divisor))
+
+    GL_STATS_HOOK(Uniform1i, UNIFORM, 0, (GLint location, GLint v0), (location, v0))
+    GL_STATS_HOOK(Uniform1f, UNIFORM, 0, (GLint location, GLfloat v0), (location, v0))
+    GL_STATS_HOOK(Uniform2f, UNIFORM, 0, (GLint location, GLfloat v0, GLfloat v1), (location, v0, v1))
+    GL_STATS_HOOK(Uniform2i, UNIFORM, 0, (GLint location, GLint v0, GLint v1), (location, v0, v1))
+    GL_STATS_HOOK(Uniform3f, UNIFORM, 0, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2),
+                  (location, v0, v1, v2))
+    GL_STATS_HOOK(Uniform4f, UNIFORM, 0, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3),
+                  (location, v0, v1, v2, v3))
+    GL_STATS_HOOK(Uniform1iv, UNIFORM, 0, (GLint location, GLsizei count, const GLint *value),
+                  (location, count, value))
+    GL_STATS_HOOK(Uniform4iv, UNIFORM, 0, (GLint location, GLsizei count, const GLint *value),
+                  (location, count, value))
+    GL_STATS_HOOK(Uniform4fv, UNIFORM, 0, (GLint location, GLsizei count, const GLfloat *value),
+                  (location, count, value))
+    GL_STATS_HOOK(UniformMatrix4fv, UNIFORM, 0,
+                  (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value),
+                  (location, count, transpose, value))
+
+    // glBufferData sem dados só reserva (ou órfã) o buffer: 0 bytes enviados
+    GL_STATS_HOOK(BufferData, BUFFER, data != NULL ? (uint64_t) size : 0,
+                  (GLenum target, GLsizeiptr size, const void *data, GLenum usage), (target, size, data, usage))
+    GL_STATS_HOOK(BufferSubData, BUFFER, (uint64_t) size,
+                  (GLenum target, GLintptr offset, GLsizeiptr size, const void *data), (target, offset, size, data))
+    // cópia dentro da GPU (BufferArena crescendo ou compactando): conta como bytes de buffer
+    GL_STATS_HOOK(CopyBufferSubData, BUFFER, (uint64_t) size,
+                  (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size),
+                  (readTarget, writeTarget, readOffset, writeOffset, size))
+    GL_STATS_HOOK(TexImage2D, TEXTURE, texelBytes(width, height, 1, format, type, pixels),
+                  (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+                   GLenum format, GLenum type, const void *pixels),
+                  (target, level, internalformat, width, height, border, format, type, pixels))
+    GL_STATS_HOOK(TexSubImage2D, TEXTURE, texelBytes(width, height, 1, format, type, pixels),
+                  (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+                   GLenum format, GLenum type, const void *pixels),
+                  (target, level, xoffset, yoffset, width, height, format, type, pixels))
+    GL_STATS_HOOK(TexImage3D, TEXTURE, texelBytes(width, height, depth, format, type, pixels),
+                  (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth,
+                   GLint border, GLenum format, GLenum type, const void *pixels),
+                  (target, level, internalformat, width, height, depth, border, format, type, pixels))
+    GL_STATS_HOOK(TexSubImage3D, TEXTURE, texelBytes(width, height, depth, format, type, pixels),
+                  (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width,
+                   GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels),
+                  (target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels))
+
+    GL_STATS_HOOK(Clear, OTHER, 0, (GLbitfield mask), (mask))
+    GL_STATS_HOOK(GenerateMipmap, OTHER, 0, (GLenum target), (target))
+    GL_STATS_HOOK(GenBuffers, OTHER, 0, (GLsizei n, GLuint *buffers), (n, buffers))
+    GL_STATS_HOOK(GenTextures, OTHER, 0, (GLsizei n, GLuint *textures), (n, textures))
+    GL_STATS_HOOK(GenVertexArrays, OTHER, 0, (GLsizei n, GLuint *arrays), (n, arrays))
+    GL_STATS_HOOK(DeleteBuffers, OTHER, 0, (GLsizei n, const GLuint *buffers), (n, buffers))
+    GL_STATS_HOOK(DeleteTextures, OTHER, 0, (GLsizei n, const GLuint *textures), (n, textures))
+    GL_STATS_HOOK(DeleteVertexArrays, OTHER, 0, (GLsizei n, const GLuint *arrays), (n, arrays))
+    GL_STATS_HOOK(ShaderSource, OTHER, 0,
+                  (GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length),
+                  (shader, count, string, length))
+    GL_STATS_HOOK(CompileShader, OTHER, 0, (GLuint shader), (shader))
+    GL_STATS_HOOK(DeleteShader, OTHER, 0, (GLuint shader), (shader))
+    GL_STATS_HOOK(AttachShader, OTHER, 0, (GLuint program, GLuint shader), (program, shader))
+    GL_STATS_HOOK(LinkProgram, OTHER, 0, (GLuint program), (program))
+    GL_STATS_HOOK(ValidateProgram, OTHER, 0, (GLuint program), (program))
+    GL_STATS_HOOK(DeleteProgram, OTHER, 0, (GLuint program), (program))
+    GL_STATS_HOOK(GetShaderiv, OTHER, 0, (GLuint shader, GLenum pname, GLint *params), (shader, pname, params))
+    GL_STATS_HOOK(GetShaderInfoLog, OTHER, 0, (GLuint shader, GLsizei size, GLsizei *length, GLchar *log),
+                  (shader, size, length, log))
+    GL_STATS_HOOK(GetProgramiv, OTHER, 0, (GLuint program, GLenum pname, GLint *params), (program, pname, params))
+    GL_STATS_HOOK(GetProgramInfoLog, OTHER, 0, (GLuint program, GLsizei size, GLsizei *length, GLchar *log),
+                  (program, size, length, log))
+    GL_STATS_HOOK(GetActiveUniform, OTHER, 0,
+                  (GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type,
+                   GLchar *name),
+                  (program, index, bufSize, length, size, type, name))
+    GL_STATS_HOOK(GetFloatv, OTHER, 0, (GLenum pname, GLfloat *data), (pname, data))
+    GL_STATS_HOOK(GetIntegerv, OTHER, 0, (GLenum pname, GLint *data), (pname, data))
+
+#undef GL_STATS_HOOK
+
+// ganchos que devolvem o valor da função original
+#define GL_STATS_HOOK_RETURN(name, result, kind, params, args)                  \
+    static result APIENTRY hook##name params {                                  \
+        record(GL_STATS_CALLER(), "gl" #name, kind, 0);                         \
+        return state().real.name args;                                          \
+    }
+
+    GL_STATS_HOOK_RETURN(GetUniformLocation, GLint, LOCATION, (GLuint program, const GLchar *name), (program, name))
+    GL_STATS_HOOK_RETURN(CreateShader, GLuint, OTHER, (GLenum type), (type))
+    GL_STATS_HOOK_RETURN(CreateProgram, GLuint, OTHER, (), ())
+    GL_STATS_HOOK_RETURN(GetError, GLenum, OTHER, (), ())
+    GL_STATS_HOOK_RETURN(GetString, const GLubyte *, OTHER, (GLenum name), (name))
+    GL_STATS_HOOK_RETURN(IsEnabled, GLboolean, OTHER, (GLenum cap), (cap))
+
+#undef GL_STATS_HOOK_RETURN
+
+    // troca os ponteiros da GLAD pelos ganchos; funções que o driver não
+    // carregou (NULL) continuam NULL
+    static void install() {
+        State &s = state();
+#define GL_STATS_INSTALL(name, type)                                            \
+    s.real.name = glad_gl##name;                                                \
+    if (glad_gl##name != NULL) {                                                \
+        glad_gl##name = hook##name;                                             \
+    }
+        GL_STATS_FUNCTIONS(GL_STATS_INSTALL)
+#undef GL_STATS_INSTALL
+    }
+
+    static void uninstall() {
+        State &s = state();
+#define GL_STATS_UNINSTALL(name, type) glad_gl##name = s.real.name;
+        GL_STATS_FUNCTIONS(GL_STATS_UNINSTALL)
+#undef GL_STATS_UNINSTALL
+    }
+
+    // "função+0x..." (ou "executável+0x..." sem símbolo) de um endereço
+    static std::string describe(const void *address) {
+        char buffer[64];
+#if defined(__unix__) || defined(__APPLE__)
+        Dl_info info;
+        if (address != NULL && dladdr(address, &info) != 0) {
+            if (info.dli_sname != NULL) {
+                std::string name = info.dli_sname;
+#if defined(__GNUC__) || defined(__clang__)
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+                if (status == 0 && demangled != NULL) {
+                    name = demangled;
+                }
+                free(demangled);
+#endif
+                snprintf(buffer, sizeof(buffer), "+0x%lx",
+                         (unsigned long) ((const char *) address - (const char *) info.dli_saddr));
+                return name + buffer;
+            }
+            if (info.dli_fname != NULL) {
+                std::string file = info.dli_fname;
+                size_t slash = file.find_last_of('/');
+                snprintf(buffer, sizeof(buffer), "+0x%lx",
+                         (unsigned long) ((const char *) address - (const char *) info.dli_fbase));
+                return file.substr(slash == std::string::npos ? 0 : slash + 1) + buffer;
+            }
+        }
+#endif
+        snprintf(buffer, sizeof(buffer), "%p", address);
+        return buffer;
+    }
+
+    static void printSummary(std::ostream &out, const GlFrameStats &total, int frames) {
+        double n = frames > 0 ? frames : 1;
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "gl: %d quadros | por quadro: %.0f chamadas, %.1f draws, %.0f vértices, %.0f instâncias, "
+                 "%.0f estado, %.0f uniforms, %.1f KB buffers, %.1f KB texturas, %.0f getUniformLocation",
+                 frames, total.calls / n, total.draws / n, total.vertices / n, total.instances / n,
+                 total.stateChanges / n, total.uniforms / n, total.bufferBytes / n / 1024.0,
+                 total.textureBytes / n / 1024.0, total.uniformLocations / n);
+        out << line << std::endl;
+    }
+
+public:
+    static bool enabled() {
+        return state().enabled;
+    }
+
+    static void setEnabled(bool enabled) {
+        State &s = state();
+        if (enabled == s.enabled) {
+            return;
+        }
+        if (enabled) {
+            install();
+            s.current = s.last = s.window = GlFrameStats();
+            s.windowFrames = 0;
+            s.frames = 0;
+            s.sites.clear();
+        } else {
+            uninstall();
+            printSites(std::cout);
+        }
+        s.enabled = enabled;
+    }
+
+    static void toggle() {
+        setEnabled(!enabled());
+    }
+
+    // uma linha de resumo (médias por quadro) a cada `frames` quadros
+    static void setInterval(int frames) {
+        state().interval = frames > 0 ? frames : 1;
+    }
+
+    // PGCC_GL_STATS=<N> liga a contagem com resumo a cada N quadros
+    // (60 se N não for um número); chamar depois de gladLoadGLLoader
+    static void initFromEnvironment() {
+        const char *value = getenv("PGCC_GL_STATS");
+        if (value == NULL || *value == '\0') {
+            return;
+        }
+        int frames = atoi(value);
+        setInterval(frames > 0 ? frames : 60);
+        setEnabled(true);
+    }
+
+    // fecha o quadro atual; chamar depois de glfwSwapBuffers
+    static void frame() {
+        State &s = state();
+        if (!s.enabled) {
+            return;
+        }
+        s.last = s.current;
+        s.window.add(s.current);
+        s.current = GlFrameStats();
+        s.frames++;
+        if (++s.windowFrames >= (s.interval > 0 ? s.interval : 60)) {
+            printSummary(std::cout, s.window, s.windowFrames);
+            s.window = GlFrameStats();
+            s.windowFrames = 0;
+        }
+    }
+
+    // contagens do último quadro fechado
+    static const GlFrameStats &lastFrame() {
+        return state().last;
+    }
+
+    // pontos de chamada desde que a contagem foi ligada, dos mais chamados
+    // para os menos
+    static void printSites(std::ostream &out, size_t limit = 25) {
+        State &s = state();
+        std::vector<std::pair<const void *, GlCallSite>> sites(s.sites.begin(), s.sites.end());
+        std::sort(sites.begin(), sites.end(),
+                  [](const std::pair<const void *, GlCallSite> &a, const std::pair<const void *, GlCallSite> &b) {
+                      return a.second.calls > b.second.calls;
+                  });
+
+        double frames = s.frames > 0 ? (double) s.frames : 1.0;
+        out << "gl: chamadas por ponto de chamada (" << s.frames << " quadros)" << std::endl;
+        char line[512];
+        out << "           chamadas   vért./bytes  função                             local" << std::endl;
+        for (size_t i = 0; i < sites.size() && i < limit; i++) {
+            const GlCallSite &site = sites[i].second;
+            snprintf(line, sizeof(line), "  %10.1f/quadro  %12llu  %-34s %s", site.calls / frames,
+                     (unsigned long long) site.amount, site.function, describe(sites[i].first).c_str());
+            out << line << std::endl;
+        }
+        if (sites.size() > limit) {
+            out << "  ... mais " << sites.size() - limit << " pontos" << std::endl;
+        }
+    }
+};
+
+#endif /* GlStats_h */
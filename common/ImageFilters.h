@@ -0,0 +1,71 @@
+#ifndef ImageFilters_h
+#define ImageFilters_h
+
+#include <math.h>
+
+// Filtros do exemplo_03 sobre imagens RGB de 3 bytes por pixel. Cada função
+// processa os pixels [first, last), então a imagem pode ser dividida entre
+// threads (parallelFor) sem nenhuma sincronização. Ficam fora do exemplo para
+// o pgcc_bench medir exatamente o mesmo código.
+
+// distância máxima entre duas cores RGB: sqrt(3 * 255^2)
+#define COLOR_DISTANCE_MAX 441.6729559301
+
+inline double colorDistance(int r1, int g1, int b1, int r2, int g2, int b2) {
+    double r = r1 - r2;
+    double g = g1 - g2;
+    double b = b1 - b2;
+    return sqrt(r*r + g*g + b*b);
+}
+
+// pinta de preto os pixels a menos de `tolerance` (0..1) da cor-chave
+inline void chromaKeyPixels(unsigned char *data, int first, int last, int r, int g, int b, double tolerance) {
+    for (int i = first * 3; i < last * 3; i += 3) {
+        int ri = data[i] & 0xff;
+        int gi = data[i+1] & 0xff;
+        int bi = data[i+2] & 0xff;
+        double d = colorDistance(r, g, b, ri, gi, bi);
+        if (d/COLOR_DISTANCE_MAX < tolerance) {
+            data[i] = 0;
+            data[i+1] = 0;
+            data[i+2] = 0;
+        }
+    }
+}
+
+// média dos canais com os pesos dados
+inline void grayScalePixels(unsigned char *data, int first, int last, double rw, double gw, double bw) {
+    for (int i = first * 3; i < last * 3; i += 3) {
+        int ri = data[i] & 0xff;
+        int gi = data[i+1] & 0xff;
+        int bi = data[i+2] & 0xff;
+
+        data[i] = data[i+1] = data[i+2] = (int)(ri * rw + gi * gw + bi * bw);
+    }
+}
+
+inline void colorizePixels(unsigned char *data, int first, int last, int r, int g, int b) {
+    for (int i = first * 3; i < last * 3; i += 3) {
+        int ri = data[i] & 0xff;
+        int gi = data[i+1] & 0xff;
+        int bi = data[i+2] & 0xff;
+
+        data[i]   = ri | r;
+        data[i+1] = gi | g;
+        data[i+2] = bi | b;
+    }
+}
+
+inline void negativePixels(unsigned char *data, int first, int last) {
+    for (int i = first * 3; i < last * 3; i += 3) {
+        int ri = data[i] & 0xff;
+        int gi = data[i+1] & 0xff;
+        int bi = data[i+2] & 0xff;
+
+        data[i]   = ri ^ 255;
+        data[i+1] = gi ^ 255;
+        data[i+2] = bi ^ 255;
+    }
+}
+
+#endif /* ImageFilters_h */
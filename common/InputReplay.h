@@ -0,0 +1,446 @@
+#ifndef InputReplay_h
+#define InputReplay_h
+
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "RedrawScheduler.h"
+
+// Gravação e reprodução determinística da entrada (teclado, mouse, janela).
+//
+//   PGCC_RECORD=sessao.pgir ./TrabalhoGB        grava uma sessão
+//   PGCC_REPLAY=sessao.pgir ./TrabalhoGB        reproduz a sessão
+//   PGCC_HEADLESS=1                             reprodução com janela invisível
+//   PGCC_REPLAY_TIMES=quadros.txt               tempos de quadro (ms, um por linha)
+//
+// Cada volta do laço principal é um "tick". Na gravação os callbacks do GLFW
+// não vão direto para o programa: os eventos da volta são guardados, o tempo
+// da volta é lido uma vez e só então eles são gravados (com o tick) e
+// entregues. Na reprodução os eventos reais são descartados e cada volta
+// recebe exatamente os mesmos eventos e o mesmo tempo da gravação, sem
+// esperar: o programa (inclusive o RedrawScheduler e tudo o que usa now())
+// faz as mesmas contas e desenha os mesmos quadros, o mais rápido possível e
+// sem vsync. Ao fim do arquivo a janela é fechada e a distribuição dos tempos
+// de quadro (do fim da espera até endFrame()) é impressa, para comparar
+// builds com a mesma sessão.
+//
+//     InputReplay input;
+//     input.initFromEnvironment();          // antes de criar a janela
+//     ... cria a janela, registra os callbacks e o redraw ...
+//     input.install(window, redraw);
+//     while (!glfwWindowShouldClose(window)) {
+//         input.waitEvents(redraw);         // no lugar de redraw.waitEvents()
+//         ... usa input.now() e input.cursorPos() em vez do GLFW ...
+//         if (!redraw.beginFrame()) continue;
+//         ... desenha, glfwSwapBuffers ...
+//         input.endFrame();
+//     }
+//
+// Sem nenhuma das variáveis nada é instalado e now()/cursorPos() são o
+// glfwGetTime()/glfwGetCursorPos() de sempre.
+//
+// Arquivo: "PGIR", versão (uint32), tempo do install (double) e registros de
+// 1 byte de tipo seguido dos campos, em little-endian. Um registro TICK (tempo em double) abre cada volta
+// e os eventos dela vêm em seguida; posições do cursor são float. O tick de um
+// evento é a quantidade de TICKs antes dele.
+
+#define INPUT_REPLAY_MAGIC "PGIR"
+#define INPUT_REPLAY_VERSION 1
+
+class InputReplay {
+public:
+    enum Mode { LIVE, RECORD, REPLAY };
+
+private:
+    enum Type { TICK, KEY, BUTTON, CURSOR, REFRESH, RESIZE };
+
+    struct Event {
+        uint8_t type;
+        int32_t a, b, c, d; // key/scancode/action/mods, botão/ação/mods, largura/altura
+        float x, y;         // cursor
+    };
+
+    Mode mode;
+    bool headless;
+    FILE *file; // gravação
+    std::vector<unsigned char> data; // reprodução: o arquivo inteiro
+    size_t offset;
+    std::vector<Event> pending; // eventos da volta na gravação
+    GLFWwindow *window;
+    double tickTime;
+    double tickStart; // glfwGetTime() real do começo da volta
+    double cursorX, cursorY;
+    uint64_t ticks;
+    uint64_t events;
+    std::vector<float> frameMs;
+
+    GLFWkeyfun keyCallback;
+    GLFWmousebuttonfun buttonCallback;
+    GLFWcursorposfun cursorCallback;
+    GLFWwindowrefreshfun refreshCallback;
+    GLFWframebuffersizefun resizeCallback;
+
+    static InputReplay *&installed() {
+        static InputReplay *input = NULL;
+        return input;
+    }
+
+    template <typename T>
+    void put(T value) {
+        fwrite(&value, sizeof(value), 1, this->file);
+    }
+
+    template <typename T>
+    bool get(T &value) {
+        if (this->offset + sizeof(value) > this->data.size()) {
+            return false;
+        }
+        memcpy(&value, &this->data[this->offset], sizeof(value));
+        this->offset += sizeof(value);
+        return true;
+    }
+
+    void write(const Event &e) {
+        put(e.type);
+        switch (e.type) {
+        case KEY:
+            put(e.a);
+            put(e.b);
+            put((uint8_t) e.c);
+            put((uint8_t) e.d);
+            break;
+        case BUTTON:
+            put((uint8_t) e.a);
+            put((uint8_t) e.b);
+            put((uint8_t) e.c);
+            put(e.x);
+            put(e.y);
+            break;
+        case CURSOR:
+            put(e.x);
+            put(e.y);
+            break;
+        case RESIZE:
+            put(e.a);
+            put(e.b);
+            break;
+        }
+        this->events++;
+    }
+
+    // próximo evento da volta atual; false no próximo TICK ou no fim
+    bool read(Event &e) {
+        if (this->offset >= this->data.size() || this->data[this->offset] == TICK) {
+            return false;
+        }
+        memset(&e, 0, sizeof(e));
+        e.type = this->data[this->offset++];
+        uint8_t b0 = 0, b1 = 0, b2 = 0;
+        bool ok = true;
+        switch (e.type) {
+        case KEY:
+            ok = get(e.a) && get(e.b) && get(b0) && get(b1);
+            e.c = b0;
+            e.d = b1;
+            break;
+        case BUTTON:
+            ok = get(b0) && get(b1) && get(b2) && get(e.x) && get(e.y);
+            e.a = b0;
+            e.b = b1;
+            e.c = b2;
+            break;
+        case CURSOR:
+            ok = get(e.x) && get(e.y);
+            break;
+        case REFRESH:
+            break;
+        case RESIZE:
+            ok = get(e.a) && get(e.b);
+            break;
+        default:
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Arquivo de reprodução corrompido no byte " << this->offset << std::endl;
+            this->offset = this->data.size();
+            return false;
+        }
+        return true;
+    }
+
+    void dispatch(const Event &e) {
+        switch (e.type) {
+        case KEY:
+            if (this->keyCallback != NULL) {
+                this->keyCallback(this->window, e.a, e.b, e.c, e.d);
+            }
+            break;
+        case BUTTON:
+            this->cursorX = e.x;
+            this->cursorY = e.y;
+            if (this->buttonCallback != NULL) {
+                this->buttonCallback(this->window, e.a, e.b, e.c);
+            }
+            break;
+        case CURSOR:
+            this->cursorX = e.x;
+            this->cursorY = e.y;
+            if (this->cursorCallback != NULL) {
+                this->cursorCallback(this->window, e.x, e.y);
+            }
+            break;
+        case REFRESH:
+            if (this->refreshCallback != NULL) {
+                this->refreshCallback(this->window);
+            }
+            break;
+        case RESIZE:
+            if (this->resizeCallback != NULL) {
+                this->resizeCallback(this->window, e.a, e.b);
+            }
+            break;
+        }
+    }
+
+    // callbacks instalados no GLFW: guardam o evento na gravação e descartam
+    // a entrada real na reprodução
+    static void queue(const Event &e) {
+        InputReplay *input = installed();
+        if (input != NULL && input->mode == RECORD) {
+            input->pending.push_back(e);
+        }
+    }
+
+    static void onKey(GLFWwindow *, int key, int scancode, int action, int mods) {
+        Event e = {KEY, key, scancode, action, mods, 0.0f, 0.0f};
+        queue(e);
+    }
+
+    static void onButton(GLFWwindow *window, int button, int action, int mods) {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        Event e = {BUTTON, button, action, mods, 0, (float) x, (float) y};
+        queue(e);
+    }
+
+    static void onCursor(GLFWwindow *, double x, double y) {
+        Event e = {CURSOR, 0, 0, 0, 0, (float) x, (float) y};
+        queue(e);
+    }
+
+    static void onRefresh(GLFWwindow *) {
+        Event e = {REFRESH, 0, 0, 0, 0, 0.0f, 0.0f};
+        queue(e);
+    }
+
+    static void onResize(GLFWwindow *, int width, int height) {
+        Event e = {RESIZE, width, height, 0, 0, 0.0f, 0.0f};
+        queue(e);
+    }
+
+    static double tickClock() {
+        return installed()->now();
+    }
+
+    bool openRecording(const char *path) {
+        this->file = fopen(path, "wb");
+        if (this->file == NULL) {
+            std::cerr << "Não foi possível criar " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool openReplay(const char *path) {
+        FILE *in = fopen(path, "rb");
+        if (in == NULL) {
+            std::cerr << "Não foi possível abrir " << path << std::endl;
+            return false;
+        }
+        unsigned char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            this->data.insert(this->data.end(), buffer, buffer + n);
+        }
+        fclose(in);
+
+        uint32_t version = 0;
+        this->offset = 4;
+        if (this->data.size() < 8 || memcmp(&this->data[0], INPUT_REPLAY_MAGIC, 4) != 0 || !get(version) ||
+            version != INPUT_REPLAY_VERSION || !get(this->tickTime)) {
+            std::cerr << path << " não é uma gravação de entrada (versão " << INPUT_REPLAY_VERSION << ")"
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void printFrameTimes() {
+        std::vector<float> sorted = this->frameMs;
+        if (sorted.empty()) {
+            std::cout << "replay: nenhum quadro desenhado" << std::endl;
+            return;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (float ms : sorted) {
+            sum += ms;
+        }
+        size_t n = sorted.size();
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "replay: %llu ticks, %zu quadros | ms por quadro: média %.3f, p50 %.3f, p90 %.3f, p99 %.3f, máx %.3f",
+                 (unsigned long long) this->ticks, n, sum / n, sorted[n / 2], sorted[std::min(n - 1, n * 9 / 10)],
+                 sorted[std::min(n - 1, n * 99 / 100)], sorted[n - 1]);
+        std::cout << line << std::endl;
+
+        const char *path = getenv("PGCC_REPLAY_TIMES");
+        if (path != NULL && *path != '\0') {
+            FILE *out = fopen(path, "w");
+            if (out == NULL) {
+                std::cerr << "Não foi possível gravar " << path << std::endl;
+                return;
+            }
+            for (float ms : this->frameMs) {
+                fprintf(out, "%.4f\n", ms);
+            }
+            fclose(out);
+        }
+    }
+
+public:
+    InputReplay()
+        : mode(LIVE), headless(false), file(NULL), offset(0), window(NULL), tickTime(0.0), tickStart(0.0),
+          cursorX(0.0), cursorY(0.0), ticks(0), events(0), keyCallback(NULL), buttonCallback(NULL),
+          cursorCallback(NULL), refreshCallback(NULL), resizeCallback(NULL) {}
+
+    ~InputReplay() {
+        if (this->file != NULL) {
+            fclose(this->file);
+            std::cout << "Entrada gravada: " << this->ticks << " ticks, " << this->events << " eventos" << std::endl;
+        }
+    }
+
+    Mode getMode() const {
+        return this->mode;
+    }
+
+    // Lê PGCC_RECORD / PGCC_REPLAY / PGCC_HEADLESS. Chamar depois de glfwInit e
+    // antes de criar a janela (a reprodução headless esconde a janela).
+    void initFromEnvironment() {
+        const char *record = getenv("PGCC_RECORD");
+        const char *replay = getenv("PGCC_REPLAY");
+        if (replay != NULL && *replay != '\0') {
+            if (!openReplay(replay)) {
+                exit(EXIT_FAILURE);
+            }
+            this->mode = REPLAY;
+            const char *headless = getenv("PGCC_HEADLESS");
+            this->headless = headless != NULL && *headless != '\0' && strcmp(headless, "0") != 0;
+            if (this->headless) {
+                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            }
+        } else if (record != NULL && *record != '\0') {
+            if (!openRecording(record)) {
+                exit(EXIT_FAILURE);
+            }
+            this->mode = RECORD;
+        }
+    }
+
+    // Coloca a gravação/reprodução entre o GLFW e os callbacks já registrados
+    // (teclado, mouse e os do RedrawScheduler). Chamar depois de registrá-los
+    // e com o contexto atual.
+    void install(GLFWwindow *window, RedrawScheduler &redraw) {
+        if (this->mode == LIVE) {
+            return;
+        }
+        installed() = this;
+        this->window = window;
+        this->keyCallback = glfwSetKeyCallback(window, onKey);
+        this->buttonCallback = glfwSetMouseButtonCallback(window, onButton);
+        this->cursorCallback = glfwSetCursorPosCallback(window, onCursor);
+        this->refreshCallback = glfwSetWindowRefreshCallback(window, onRefresh);
+        this->resizeCallback = glfwSetFramebufferSizeCallback(window, onResize);
+        redraw.setClock(tickClock);
+        if (this->mode == RECORD) {
+            // o tempo até a primeira volta também é o gravado
+            this->tickTime = glfwGetTime();
+            fwrite(INPUT_REPLAY_MAGIC, 1, 4, this->file);
+            put((uint32_t) INPUT_REPLAY_VERSION);
+            put(this->tickTime);
+        } else {
+            glfwSwapInterval(0);
+        }
+    }
+
+    // Uma volta: espera/processa os eventos e fixa o tempo da volta. Na
+    // reprodução não espera; no fim do arquivo pede o fechamento da janela.
+    void waitEvents(RedrawScheduler &redraw) {
+        if (this->mode == LIVE) {
+            redraw.waitEvents();
+            return;
+        }
+
+        if (this->mode == RECORD) {
+            redraw.waitEvents();
+            this->tickTime = glfwGetTime();
+            this->tickStart = this->tickTime;
+            put((uint8_t) TICK);
+            put(this->tickTime);
+            this->ticks++;
+            for (size_t i = 0; i < this->pending.size(); i++) {
+                write(this->pending[i]);
+                dispatch(this->pending[i]);
+            }
+            this->pending.clear();
+            return;
+        }
+
+        glfwPollEvents(); // mantém a janela respondendo; a entrada real é descartada
+        this->tickStart = glfwGetTime();
+        uint8_t type;
+        if (!get(type) || type != TICK || !get(this->tickTime)) {
+            if (!glfwWindowShouldClose(this->window)) {
+                printFrameTimes();
+                glfwSetWindowShouldClose(this->window, GLFW_TRUE);
+            }
+            return;
+        }
+        this->ticks++;
+        Event e;
+        while (read(e)) {
+            dispatch(e);
+        }
+    }
+
+    // fim de um quadro desenhado (depois do glfwSwapBuffers)
+    void endFrame() {
+        if (this->mode == REPLAY) {
+            this->frameMs.push_back((float) ((glfwGetTime() - this->tickStart) * 1000.0));
+        }
+    }
+
+    // tempo da volta atual (gravado/reproduzido) ou glfwGetTime()
+    double now() const {
+        return this->mode == LIVE ? glfwGetTime() : this->tickTime;
+    }
+
+    // posição do cursor no último evento de mouse entregue
+    void cursorPos(GLFWwindow *window, double *x, double *y) const {
+        if (this->mode == LIVE) {
+            glfwGetCursorPos(window, x, y);
+        } else {
+            *x = this->cursorX;
+            *y = this->cursorY;
+        }
+    }
+};
+
+#endif /* InputReplay_h */
@@ -0,0 +1,318 @@
+#ifndef JobSystem_h
+#define JobSystem_h
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Trace.h"
+
+// Escalonador de tarefas com roubo de trabalho (work stealing).
+//
+// Cada thread tem sua própria fila: o dono empilha e desempilha pelo fim (LIFO,
+// aproveita a cache), as threads ociosas roubam pelo começo (FIFO, pegam os
+// pedaços maiores). A thread que cria o JobSystem (normalmente a do GLFW) é o
+// trabalhador 0 e só executa tarefas enquanto espera em wait()/parallelFor().
+//
+// Uma tarefa é uma função + ponteiro de dados + intervalo [begin, end). Tarefas
+// podem sinalizar um JobCounter ao terminar e podem esperar outro contador
+// chegar a zero antes de começar (dependência).
+
+typedef void (*JobFunction)(void *data, int begin, int end);
+
+struct JobCounter;
+
+struct Job {
+    JobFunction function;
+    void *data;
+    int begin, end;
+    JobCounter *signal;   // decrementado quando a tarefa termina (pode ser NULL)
+};
+
+// Contador de tarefas pendentes. Tarefas que dependem dele ficam guardadas
+// aqui e são liberadas pela última tarefa a terminar.
+struct JobCounter {
+    std::atomic<int> pending;
+    std::mutex lock;
+    std::vector<Job> continuations;
+
+    JobCounter() : pending(0) {}
+
+    bool done() const {
+        return this->pending.load() == 0;
+    }
+};
+
+class JobSystem {
+    // Fila dupla em anel. Só cresce quando enche, então depois do aquecimento
+    // agendar tarefas não aloca nada (a std::deque aloca e libera um bloco
+    // toda vez que cruza a borda de um).
+    struct WorkQueue {
+        std::mutex lock;
+        std::vector<Job> ring; // tamanho potência de 2
+        size_t head;           // primeira tarefa
+        size_t count;
+
+        WorkQueue() : ring(64), head(0), count(0) {}
+
+        bool empty() const {
+            return this->count == 0;
+        }
+
+        void pushBack(const Job &job) {
+            if (this->count == this->ring.size()) {
+                std::vector<Job> bigger(this->ring.size() * 2);
+                for (size_t i = 0; i < this->count; i++) {
+                    bigger[i] = this->ring[(this->head + i) & (this->ring.size() - 1)];
+                }
+                this->ring.swap(bigger);
+                this->head = 0;
+            }
+            this->ring[(this->head + this->count) & (this->ring.size() - 1)] = job;
+            this->count++;
+        }
+
+        Job popBack() {
+            this->count--;
+            return this->ring[(this->head + this->count) & (this->ring.size() - 1)];
+        }
+
+        Job popFront() {
+            Job job = this->ring[this->head];
+            this->head = (this->head + 1) & (this->ring.size() - 1);
+            this->count--;
+            return job;
+        }
+    };
+
+    std::vector<WorkQueue *> queues;      // 0 = thread criadora, 1.. = trabalhadores
+    std::vector<std::thread> threads;
+    std::atomic<int> queued;              // tarefas nas filas (para dormir sem perder avisos)
+    std::atomic<int> sleeping;
+    std::atomic<bool> stopping;
+    std::mutex sleepLock;
+    std::condition_variable wakeUp;
+
+    // Fila da thread atual neste JobSystem. O índice guardado por thread vale
+    // só para o sistema que a criou: uma tarefa que agenda em outro JobSystem
+    // (ou qualquer thread de fora) usa a fila 0, que é protegida por lock como
+    // as demais.
+    struct WorkerSlot {
+        const JobSystem *owner;
+        int index;
+    };
+
+    static WorkerSlot &workerSlot() {
+        static thread_local WorkerSlot slot = {NULL, 0};
+        return slot;
+    }
+
+    int currentWorker() const {
+        const WorkerSlot &slot = workerSlot();
+        return slot.owner == this ? slot.index : 0;
+    }
+
+    void push(const Job &job) {
+        WorkQueue *q = this->queues[currentWorker()];
+        {
+            std::lock_guard<std::mutex> guard(q->lock);
+            q->pushBack(job);
+        }
+        this->queued.fetch_add(1);
+        if (this->sleeping.load() > 0) {
+            // garante que o trabalhador já está bloqueado em wakeUp.wait
+            std::lock_guard<std::mutex> guard(this->sleepLock);
+        }
+        this->wakeUp.notify_one();
+    }
+
+    bool pop(Job &job) {
+        int self = currentWorker();
+        int n = (int) this->queues.size();
+        WorkQueue *own = this->queues[self];
+        {
+            std::lock_guard<std::mutex> guard(own->lock);
+            if (!own->empty()) {
+                job = own->popBack();
+                this->queued.fetch_sub(1);
+                return true;
+            }
+        }
+        for (int k = 1; k < n; k++) {
+            WorkQueue *victim = this->queues[(self + k) % n];
+            std::lock_guard<std::mutex> guard(victim->lock);
+            if (!victim->empty()) {
+                job = victim->popFront();
+                this->queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(const Job &job) {
+        TRACE_ZONE("job");
+        job.function(job.data, job.begin, job.end);
+        if (job.signal != NULL) {
+            finish(job.signal);
+        }
+    }
+
+    void finish(JobCounter *counter) {
+        // Enquanto não for a última tarefa, basta decrementar. A última faz o
+        // decremento segurando o lock: quem espera em wait() passa pelo mesmo
+        // lock antes de retornar, então o contador (muitas vezes na pilha de
+        // quem espera) não é destruído enquanto ainda está em uso aqui.
+        int pending = counter->pending.load();
+        while (pending > 1) {
+            if (counter->pending.compare_exchange_weak(pending, pending - 1)) {
+                return;
+            }
+        }
+        std::vector<Job> ready;
+        {
+            std::lock_guard<std::mutex> guard(counter->lock);
+            if (counter->pending.fetch_sub(1) == 1) {
+                ready.swap(counter->continuations);
+            }
+        }
+        for (size_t i = 0; i < ready.size(); i++) {
+            push(ready[i]);
+        }
+    }
+
+    void workerLoop(int index) {
+        workerSlot().owner = this;
+        workerSlot().index = index;
+        TRACE_THREAD_NAME("worker");
+        Job job;
+        while (!this->stopping.load()) {
+            if (pop(job)) {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(this->sleepLock);
+            this->sleeping.fetch_add(1);
+            this->wakeUp.wait(guard, [this] { return this->queued.load() > 0 || this->stopping.load(); });
+            this->sleeping.fetch_sub(1);
+        }
+    }
+
+    template <typename F>
+    struct ParallelFor {
+        const F *body;
+        int grain;
+        JobCounter *counter;
+        JobSystem *system;
+    };
+
+    // divide o intervalo ao meio até chegar no grão: a metade de cima vira uma
+    // tarefa (que pode ser roubada) e a de baixo continua nesta thread
+    template <typename F>
+    static void splitRange(void *data, int begin, int end) {
+        ParallelFor<F> *pf = (ParallelFor<F> *) data;
+        while (end - begin > pf->grain) {
+            int mid = begin + (end - begin) / 2;
+            pf->counter->pending.fetch_add(1);
+            Job half = {&JobSystem::splitRange<F>, data, mid, end, pf->counter};
+            pf->system->push(half);
+            end = mid;
+        }
+        (*pf->body)(begin, end);
+    }
+
+public:
+    // workers = threads extras; 0 usa todos os núcleos menos o da thread atual
+    explicit JobSystem(int workers = 0) : queued(0), sleeping(0), stopping(false) {
+        if (workers <= 0) {
+            int cores = (int) std::thread::hardware_concurrency();
+            workers = cores > 1 ? cores - 1 : 1;
+        }
+        for (int i = 0; i <= workers; i++) {
+            this->queues.push_back(new WorkQueue());
+        }
+        for (int i = 1; i <= workers; i++) {
+            this->threads.push_back(std::thread(&JobSystem::workerLoop, this, i));
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> guard(this->sleepLock);
+            this->stopping.store(true);
+        }
+        this->wakeUp.notify_all();
+        for (size_t i = 0; i < this->threads.size(); i++) {
+            this->threads[i].join();
+        }
+        for (size_t i = 0; i < this->queues.size(); i++) {
+            delete this->queues[i];
+        }
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // número de threads que executam tarefas (incluindo a criadora)
+    int workerCount() const {
+        return (int) this->queues.size();
+    }
+
+    // Agenda function(data, begin, end). Se `signal` não for NULL, ele é
+    // incrementado agora e decrementado quando a tarefa terminar. Se `after`
+    // não for NULL, a tarefa só entra na fila quando `after` chegar a zero.
+    void run(JobFunction function, void *data, int begin, int end, JobCounter *signal = NULL, JobCounter *after = NULL) {
+        Job job = {function, data, begin, end, signal};
+        if (signal != NULL) {
+            signal->pending.fetch_add(1);
+        }
+        if (after != NULL) {
+            std::lock_guard<std::mutex> guard(after->lock);
+            if (!after->done()) {
+                after->continuations.push_back(job);
+                return;
+            }
+        }
+        push(job);
+    }
+
+    // Executa outras tarefas até `counter` chegar a zero.
+    void wait(JobCounter &counter) {
+        Job job;
+        while (!counter.done()) {
+            if (pop(job)) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        std::lock_guard<std::mutex> guard(counter.lock);
+    }
+
+    // Chama body(begin, end) sobre pedaços de no máximo `grain` elementos de
+    // [begin, end) e só retorna quando todos terminarem. grain <= 0 escolhe
+    // automaticamente (~8 pedaços por thread). Intervalos menores que o grão
+    // rodam direto na thread atual, sem custo de agendamento.
+    template <typename F>
+    void parallelFor(int begin, int end, int grain, const F &body) {
+        if (end <= begin) {
+            return;
+        }
+        if (grain <= 0) {
+            grain = (end - begin) / (workerCount() * 8);
+            grain = grain > 0 ? grain : 1;
+        }
+        if (end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+        JobCounter counter;
+        ParallelFor<F> pf = {&body, grain, &counter, this};
+        splitRange<F>(&pf, begin, end);
+        wait(counter);
+    }
+};
+
+#endif /* JobSystem_h */
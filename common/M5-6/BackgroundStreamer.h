@@ -0,0 +1,451 @@
+#ifndef BackgroundStreamer_h
+#define BackgroundStreamer_h
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "Layer.h"
+#include "JobSystem.h"
+
+// Streaming de fundos muito largos.
+//
+// Cada camada é uma faixa horizontal formada por um ou mais segmentos (PNGs
+// lado a lado, todos da mesma altura). A faixa é dividida em páginas de
+// largura fixa e só as páginas próximas da janela visível ficam na GPU, em um
+// pool de fatias de um GL_TEXTURE_2D_ARRAY. Uma tabela de páginas (textura de
+// inteiros, uma linha por camada) diz ao shader em que fatia está cada página;
+// página fora do pool = transparente. Com isso a largura da faixa não depende
+// de GL_MAX_TEXTURE_SIZE e a memória de GPU depende só do tamanho do pool.
+//
+// As páginas à frente da janela, na direção do movimento (velocidade da câmera
+// * Layer::ratex), são pré-carregadas: os segmentos são decodificados nas
+// threads do JobSystem e o envio para a GPU acontece em update(), limitado a
+// algumas páginas por quadro. O stb_image só decodifica um PNG inteiro, então
+// a unidade de decodificação é o segmento: faixas longas devem ser cortadas em
+// vários arquivos para que a memória de CPU também fique limitada. Um segmento
+// é liberado assim que todas as páginas dele que estão na janela já subiram.
+//
+// Coordenadas: o shader recebe st.x em "alturas" da faixa (st.x = 1 avança
+// `height` pixels), st.y de 0 (topo) a 1, e a faixa se repete na horizontal.
+
+#define STREAM_SEGMENT_EMPTY 0
+#define STREAM_SEGMENT_LOADING 1
+#define STREAM_SEGMENT_READY 2
+#define STREAM_SEGMENT_FAILED 3
+
+struct StreamSegment {
+    std::string filename;
+    int x, width;                 // posição e largura na faixa, em pixels
+    std::atomic<int> state;
+    unsigned char *pixels;        // RGBA, válido quando state == READY
+
+    StreamSegment() : x(0), width(0), state(STREAM_SEGMENT_EMPTY), pixels(NULL) {}
+};
+
+struct StreamStrip {
+    std::vector<StreamSegment *> segments;
+    int width;                    // soma das larguras dos segmentos
+    int pageCount;
+    std::vector<int> pageSlot;    // fatia do pool de cada página (-1 = não residente)
+    int wantFirst, wantLast;      // janela de páginas desejadas (índices sem repetição)
+    int visibleFirst, visibleLast;
+};
+
+class BackgroundStreamer {
+    JobSystem *jobs;
+    JobCounter decodes;
+    int pageWidth;
+    int slotWidth;                // página + 1 pixel de borda de cada lado (filtro linear)
+    int height;
+    int poolSlots;
+    int uploadsPerFrame;
+    float lookahead;              // segundos de movimento pré-carregados
+    std::vector<StreamStrip *> strips;
+    std::vector<int> slotStrip, slotPage;  // dono de cada fatia do pool (-1 = livre)
+    GLuint pool, pageTable;
+    int tableWidth;
+    bool warnedPoolFull;
+    std::vector<char> needed;     // rascunho de update(): segmentos da faixa ainda necessários
+    std::vector<GLint> stripWidths;  // largura de cada faixa, enviada por setUniforms()
+
+    static void decodeSegment(void *data, int, int) {
+        StreamSegment *segment = (StreamSegment *) data;
+        int w, h, channels;
+        segment->pixels = stbi_load(segment->filename.c_str(), &w, &h, &channels, 4);
+        segment->state.store(segment->pixels != NULL ? STREAM_SEGMENT_READY : STREAM_SEGMENT_FAILED);
+    }
+
+    static int wrap(int value, int n) {
+        int r = value % n;
+        return r < 0 ? r + n : r;
+    }
+
+    // percorre os pedaços de segmento que cobrem [a, b) na faixa (com repetição)
+    template <typename F>
+    static void forEachPiece(const StreamStrip &strip, int a, int b, const F &piece) {
+        while (a < b) {
+            int x = wrap(a, strip.width);
+            int s = 0;
+            while (x >= strip.segments[s]->x + strip.segments[s]->width) {
+                s++;
+            }
+            StreamSegment *segment = strip.segments[s];
+            int srcX = x - segment->x;
+            int w = segment->width - srcX;
+            if (w > b - a) {
+                w = b - a;
+            }
+            piece(segment, srcX, w);
+            a += w;
+        }
+    }
+
+    void setPageSlot(int s, int page, int slot) {
+        this->strips[s]->pageSlot[page] = slot;
+        GLshort value = (GLshort) slot;
+        glBindTexture(GL_TEXTURE_2D, this->pageTable);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, page, s, 1, 1, GL_RED_INTEGER, GL_SHORT, &value);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    bool inWindow(const StreamStrip &strip, int page) const {
+        return wrap(page - strip.wantFirst, strip.pageCount) <= strip.wantLast - strip.wantFirst;
+    }
+
+    int freeSlot() {
+        for (int i = 0; i < this->poolSlots; i++) {
+            if (this->slotStrip[i] < 0) {
+                return i;
+            }
+        }
+        if (!this->warnedPoolFull) {
+            std::cerr << "BackgroundStreamer: pool de páginas cheio (" << this->poolSlots << " fatias)" << std::endl;
+            this->warnedPoolFull = true;
+        }
+        return -1;
+    }
+
+    // garante a página `page` da faixa `s`: pede a decodificação dos segmentos
+    // que faltam e, se estiverem prontos e houver orçamento, envia para o pool.
+    // Retorna true se a página ficou residente.
+    bool requestPage(int s, int page, int &uploads, std::vector<char> &needed) {
+        StreamStrip &strip = *this->strips[s];
+        int a = page * this->pageWidth - 1;
+        int b = a + this->slotWidth;
+        bool ready = true;
+        forEachPiece(strip, a, b, [&](StreamSegment *segment, int, int) {
+            int state = segment->state.load();
+            if (state == STREAM_SEGMENT_EMPTY) {
+                segment->state.store(STREAM_SEGMENT_LOADING);
+                if (this->jobs != NULL) {
+                    this->jobs->run(decodeSegment, segment, 0, 1, &this->decodes);
+                } else {
+                    decodeSegment(segment, 0, 1);
+                    state = segment->state.load();
+                }
+            }
+            if (state != STREAM_SEGMENT_READY) {
+                ready = false;
+            }
+        });
+
+        int slot = -1;
+        if (ready && uploads < this->uploadsPerFrame) {
+            slot = freeSlot();
+        }
+        if (slot < 0) {
+            markNeeded(strip, a, b, needed);
+            return false;
+        }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->pool);
+        int dstX = 0;
+        forEachPiece(strip, a, b, [&](StreamSegment *segment, int srcX, int w) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, segment->width);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, srcX);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, dstX, 0, slot, w, this->height, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, segment->pixels);
+            dstX += w;
+        });
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        this->slotStrip[slot] = s;
+        this->slotPage[slot] = page;
+        setPageSlot(s, page, slot);
+        uploads++;
+        return true;
+    }
+
+    // marca os segmentos que cobrem [a, b) como ainda necessários
+    void markNeeded(const StreamStrip &strip, int a, int b, std::vector<char> &needed) const {
+        forEachPiece(strip, a, b, [&](StreamSegment *segment, int, int) {
+            for (size_t i = 0; i < strip.segments.size(); i++) {
+                if (strip.segments[i] == segment) {
+                    needed[i] = 1;
+                }
+            }
+        });
+    }
+
+public:
+    // pageWidth em pixels; poolSlots = páginas residentes na GPU (todas as camadas)
+    explicit BackgroundStreamer(JobSystem *jobs, int pageWidth = 256, int poolSlots = 64)
+        : jobs(jobs), pageWidth(pageWidth), slotWidth(pageWidth + 2), height(0), poolSlots(poolSlots),
+          uploadsPerFrame(4), lookahead(1.0f), pool(0), pageTable(0), tableWidth(0), warnedPoolFull(false) {
+        this->slotStrip.assign(poolSlots, -1);
+        this->slotPage.assign(poolSlots, -1);
+    }
+
+    ~BackgroundStreamer() {
+        if (this->jobs != NULL) {
+            this->jobs->wait(this->decodes);
+        }
+        for (size_t s = 0; s < this->strips.size(); s++) {
+            for (size_t i = 0; i < this->strips[s]->segments.size(); i++) {
+                stbi_image_free(this->strips[s]->segments[i]->pixels);
+                delete this->strips[s]->segments[i];
+            }
+            delete this->strips[s];
+        }
+        glDeleteTextures(1, &this->pool);
+        glDeleteTextures(1, &this->pageTable);
+    }
+
+    BackgroundStreamer(const BackgroundStreamer &) = delete;
+    BackgroundStreamer &operator=(const BackgroundStreamer &) = delete;
+
+    // Acrescenta uma faixa (uma camada) formada pelos arquivos em `segments`,
+    // da esquerda para a direita. Só lê os cabeçalhos dos PNGs. Retorna o
+    // índice da faixa ou -1.
+    int addStrip(const std::vector<std::string> &segments) {
+        StreamStrip *strip = new StreamStrip();
+        strip->width = 0;
+        for (size_t i = 0; i < segments.size(); i++) {
+            int w, h, channels;
+            if (!stbi_info(segments[i].c_str(), &w, &h, &channels)) {
+                std::cerr << "BackgroundStreamer: não foi possível ler " << segments[i] << std::endl;
+                w = 0;
+            } else if (this->height != 0 && h != this->height) {
+                std::cerr << "BackgroundStreamer: " << segments[i] << " tem altura " << h
+                          << ", esperado " << this->height << std::endl;
+                w = 0;
+            }
+            if (w == 0) {
+                for (size_t k = 0; k < strip->segments.size(); k++) {
+                    delete strip->segments[k];
+                }
+                delete strip;
+                return -1;
+            }
+            this->height = h;
+            StreamSegment *segment = new StreamSegment();
+            segment->filename = segments[i];
+            segment->x = strip->width;
+            segment->width = w;
+            strip->segments.push_back(segment);
+            strip->width += w;
+        }
+        if (strip->segments.empty()) {
+            delete strip;
+            return -1;
+        }
+        strip->pageCount = (strip->width + this->pageWidth - 1) / this->pageWidth;
+        strip->pageSlot.assign(strip->pageCount, -1);
+        strip->wantFirst = strip->visibleFirst = 0;
+        strip->wantLast = strip->visibleLast = -1;
+        this->strips.push_back(strip);
+        this->stripWidths.push_back(strip->width);
+        if (strip->segments.size() > this->needed.size()) {
+            this->needed.resize(strip->segments.size());
+        }
+        return (int) this->strips.size() - 1;
+    }
+
+    // cria o pool e a tabela de páginas (depois de todos os addStrip)
+    bool createTextures() {
+        GLint maxLayers = 0, maxSize = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        this->tableWidth = 1;
+        for (size_t s = 0; s < this->strips.size(); s++) {
+            if (this->strips[s]->pageCount > this->tableWidth) {
+                this->tableWidth = this->strips[s]->pageCount;
+            }
+        }
+        if (this->strips.empty() || this->poolSlots > maxLayers || this->tableWidth > maxSize || this->height > maxSize) {
+            std::cerr << "BackgroundStreamer: pool ou tabela de páginas maior que o suportado" << std::endl;
+            return false;
+        }
+
+        glGenTextures(1, &this->pool);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->pool);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, this->slotWidth, this->height, this->poolSlots, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        std::vector<GLshort> empty(this->tableWidth * this->strips.size(), -1);
+        glGenTextures(1, &this->pageTable);
+        glBindTexture(GL_TEXTURE_2D, this->pageTable);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16I, this->tableWidth, (GLsizei) this->strips.size(), 0,
+                     GL_RED_INTEGER, GL_SHORT, empty.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return true;
+    }
+
+    // Atualiza a residência: layers[i] controla a faixa i. cameraVelocity é a
+    // velocidade da câmera (unidades de cameraX por segundo) e decide para que
+    // lado pré-carregar; viewAspect = largura / altura da janela.
+    void update(const std::vector<Layer *> &layers, float cameraX, float cameraVelocity, float viewAspect) {
+        int n = (int) this->strips.size();
+        for (int s = 0; s < n && s < (int) layers.size(); s++) {
+            StreamStrip &strip = *this->strips[s];
+            float start = (layers[s]->offsetx + layers[s]->ratex * cameraX) * this->height;
+            float span = viewAspect * this->height;
+            float velocity = layers[s]->ratex * cameraVelocity * this->height;
+            strip.visibleFirst = (int) floorf(start / this->pageWidth);
+            strip.visibleLast = (int) floorf((start + span) / this->pageWidth);
+            int ahead = (int) ceilf(fabsf(velocity) * this->lookahead / this->pageWidth);
+            strip.wantFirst = strip.visibleFirst - 1 - (velocity < 0.0f ? ahead : 0);
+            strip.wantLast = strip.visibleLast + 1 + (velocity > 0.0f ? ahead : 0);
+            if (strip.wantLast - strip.wantFirst >= strip.pageCount) {
+                strip.wantLast = strip.wantFirst + strip.pageCount - 1;
+            }
+        }
+
+        // devolve ao pool as páginas que saíram da janela
+        for (int i = 0; i < this->poolSlots; i++) {
+            int s = this->slotStrip[i];
+            if (s >= 0 && !inWindow(*this->strips[s], this->slotPage[i])) {
+                setPageSlot(s, this->slotPage[i], -1);
+                this->slotStrip[i] = -1;
+                this->slotPage[i] = -1;
+            }
+        }
+
+        // primeiro o que está visível, depois o que vem pela frente
+        int uploads = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            for (int s = 0; s < n; s++) {
+                StreamStrip &strip = *this->strips[s];
+                std::vector<char> &needed = this->needed;
+                std::fill(needed.begin(), needed.begin() + strip.segments.size(), 0);
+                for (int p = strip.wantFirst; p <= strip.wantLast; p++) {
+                    bool visible = p >= strip.visibleFirst && p <= strip.visibleLast;
+                    int page = wrap(p, strip.pageCount);
+                    if (strip.pageSlot[page] >= 0) {
+                        continue;
+                    }
+                    if (visible == (pass == 0)) {
+                        requestPage(s, page, uploads, needed);
+                    } else {
+                        int a = page * this->pageWidth - 1;
+                        markNeeded(strip, a, a + this->slotWidth, needed);
+                    }
+                }
+                if (pass == 1) {
+                    // segmentos decodificados que não cobrem mais nenhuma página pendente
+                    for (size_t i = 0; i < strip.segments.size(); i++) {
+                        StreamSegment *segment = strip.segments[i];
+                        if (!needed[i] && segment->state.load() == STREAM_SEGMENT_READY) {
+                            stbi_image_free(segment->pixels);
+                            segment->pixels = NULL;
+                            segment->state.store(STREAM_SEGMENT_EMPTY);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // envia os uniforms usados por glsl(), que não mudam depois de
+    // createTextures(); uma vez por programa, com `program` em uso
+    void setUniforms(GLuint program, int poolUnit, int tableUnit) const {
+        int n = (int) this->strips.size();
+        glUniform1i(glGetUniformLocation(program, "pagePool"), poolUnit);
+        glUniform1i(glGetUniformLocation(program, "pageTable"), tableUnit);
+        glUniform1iv(glGetUniformLocation(program, "stripWidth"), n, this->stripWidths.data());
+        glUniform3f(glGetUniformLocation(program, "pageSize"), (float) this->pageWidth, (float) this->slotWidth, (float) this->height);
+    }
+
+    // liga o pool e a tabela nas unidades de textura passadas a setUniforms()
+    void bind(int poolUnit, int tableUnit) const {
+        glActiveTexture(GL_TEXTURE0 + poolUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->pool);
+        glActiveTexture(GL_TEXTURE0 + tableUnit);
+        glBindTexture(GL_TEXTURE_2D, this->pageTable);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // Trecho GLSL com streamedTexel(faixa, st); precisa de MAX_PARALLAX_LAYERS
+    // (ou outro limite de faixas) definido antes como MAX_STREAM_STRIPS.
+    static std::string glsl() {
+        return R"(
+            uniform sampler2DArray pagePool;
+            uniform isampler2D pageTable;
+            uniform int stripWidth[MAX_STREAM_STRIPS];
+            uniform vec3 pageSize;  // largura da página, largura da fatia, altura
+
+            vec4 streamedTexel(int strip, vec2 st)
+            {
+                float x = mod(st.x * pageSize.z, float(stripWidth[strip]));
+                int page = int(x / pageSize.x);
+                int slot = texelFetch(pageTable, ivec2(page, strip), 0).r;
+                if (slot < 0)
+                {
+                    return vec4(0.0); // página ainda não residente
+                }
+                float local = x - float(page) * pageSize.x + 1.0;
+                return textureLod(pagePool, vec3(local / pageSize.y, clamp(st.y, 0.0, 1.0), float(slot)), 0.0);
+            }
+        )";
+    }
+
+    int getStripCount() const {
+        return (int) this->strips.size();
+    }
+
+    int getHeight() const {
+        return this->height;
+    }
+
+    // páginas na GPU e bytes decodificados na CPU, para acompanhar a residência
+    int residentPages() const {
+        int count = 0;
+        for (int i = 0; i < this->poolSlots; i++) {
+            count += this->slotStrip[i] >= 0;
+        }
+        return count;
+    }
+
+    size_t decodedBytes() const {
+        size_t bytes = 0;
+        for (size_t s = 0; s < this->strips.size(); s++) {
+            for (size_t i = 0; i < this->strips[s]->segments.size(); i++) {
+                const StreamSegment *segment = this->strips[s]->segments[i];
+                if (segment->state.load() == STREAM_SEGMENT_READY) {
+                    bytes += (size_t) segment->width * this->height * 4;
+                }
+            }
+        }
+        return bytes;
+    }
+};
+
+#endif /* BackgroundStreamer_h */
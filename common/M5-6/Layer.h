@@ -1,7 +1,12 @@
+#ifndef Layer_h
+#define Layer_h
+
 typedef struct Layer {
 		float z;
-		unsigned int tid;
+		unsigned int tid;	// textura (ou camada do GL_TEXTURE_2D_ARRAY no ParallaxCompositor)
 		char * filename;
 		float offsetx, offsety, ratex, ratey;
 	
-} Layer;
\ No newline at end of file
+} Layer;
+
+#endif /* Layer_h */
@@ -0,0 +1,302 @@
+#ifndef ParallaxCompositor_h
+#define ParallaxCompositor_h
+
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "Layer.h"
+#include "JobSystem.h"
+#include "BackgroundStreamer.h"
+
+// Paralaxe em uma única passada: todas as camadas ficam em um
+// GL_TEXTURE_2D_ARRAY e um único triângulo que cobre a tela as compõe no
+// fragment shader, da camada da frente para a de trás. Assim que o pixel fica
+// opaco o laço termina, então cada pixel é escrito uma vez só, em vez de uma
+// vez por camada com blending.
+//
+// layers[0] é a camada do fundo (como no exemplo_05). Para cada camada o
+// deslocamento na textura é (offsetx, offsety) + (ratex, ratey) * câmera.
+// Todas as imagens precisam ter o mesmo tamanho.
+//
+// Com loadStreamed() as camadas vêm de um BackgroundStreamer (faixas de
+// qualquer largura, paginadas) em vez de uma textura inteira por camada.
+
+#define MAX_PARALLAX_LAYERS 16
+
+class ParallaxCompositor {
+    GLuint texture;
+    GLuint program;
+    GLuint vao;                 // vazio: os vértices saem de gl_VertexID
+    BackgroundStreamer *streamer;
+    int layerCount;
+    int width, height;          // tamanho das imagens
+
+    // locais dos uniforms, buscados uma vez depois do link, e o último valor
+    // enviado de cada um: por quadro só vai o que mudou (em geral, a câmera)
+    GLint scrollLocation, cameraLocation, uvScaleLocation, clearColorLocation;
+    GLfloat sentScroll[4 * MAX_PARALLAX_LAYERS];
+    GLfloat sentCamera[2], sentUvScale, sentClearColor[3];
+    bool uniformsSent;
+
+    static GLuint compile(const char *source, GLenum type) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::PARALLAX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    bool createProgram(bool streamed) {
+        const char *vertexSource = R"(#version 400
+            out vec2 uv;
+            void main()
+            {
+                // triângulo que cobre a tela inteira: (-1,-1), (3,-1), (-1,3)
+                vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+                uv = position;
+                gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+            })";
+        std::string fragmentSource = "#version 400\n#define MAX_PARALLAX_LAYERS " +
+                                     std::to_string(MAX_PARALLAX_LAYERS) + "\n";
+        if (streamed) {
+            fragmentSource += "#define STREAMED\n#define MAX_STREAM_STRIPS MAX_PARALLAX_LAYERS\n" +
+                              BackgroundStreamer::glsl();
+        }
+        fragmentSource += R"(
+            in vec2 uv;
+            out vec4 color;
+
+            uniform sampler2DArray layers;
+            uniform int layerCount;
+            uniform vec4 layerScroll[MAX_PARALLAX_LAYERS]; // offsetx, offsety, ratex, ratey
+            uniform vec2 camera;
+            uniform vec2 uvScale;                          // corrige a proporção da imagem
+            uniform vec3 clearColor;
+
+            void main()
+            {
+                // a primeira linha da imagem (stb_image) fica no topo da tela
+                vec2 base = vec2(uv.x, 1.0 - uv.y) * uvScale;
+                // derivadas fora do laço: o break torna o fluxo não uniforme
+                vec2 dx = dFdx(base);
+                vec2 dy = dFdy(base);
+
+                vec3 rgb = vec3(0.0);
+                float alpha = 0.0;
+                for (int i = layerCount - 1; i >= 0; i--)
+                {
+                    vec4 scroll = layerScroll[i];
+                    vec2 st = base + scroll.xy + scroll.zw * camera;
+#ifdef STREAMED
+                    vec4 texel = streamedTexel(i, st);
+#else
+                    vec4 texel = textureGrad(layers, vec3(st, float(i)), dx, dy);
+#endif
+                    float weight = (1.0 - alpha) * texel.a;
+                    rgb += weight * texel.rgb;
+                    alpha += weight;
+                    if (alpha >= 0.996)
+                    {
+                        break; // camadas de trás não aparecem mais neste pixel
+                    }
+                }
+                color = vec4(rgb + (1.0 - alpha) * clearColor, 1.0);
+            })";
+
+        GLuint vs = compile(vertexSource, GL_VERTEX_SHADER);
+        GLuint fs = compile(fragmentSource.c_str(), GL_FRAGMENT_SHADER);
+        this->program = glCreateProgram();
+        glAttachShader(this->program, vs);
+        glAttachShader(this->program, fs);
+        glLinkProgram(this->program);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        GLint success;
+        glGetProgramiv(this->program, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(this->program, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::PARALLAX::LINKING_FAILED\n" << infoLog << std::endl;
+            return false;
+        }
+
+        this->scrollLocation = glGetUniformLocation(this->program, "layerScroll");
+        this->cameraLocation = glGetUniformLocation(this->program, "camera");
+        this->uvScaleLocation = glGetUniformLocation(this->program, "uvScale");
+        this->clearColorLocation = glGetUniformLocation(this->program, "clearColor");
+        glUseProgram(this->program);
+        glUniform1i(glGetUniformLocation(this->program, "layers"), 0);
+        glUniform1i(glGetUniformLocation(this->program, "layerCount"), this->layerCount);
+        if (streamed) {
+            this->streamer->setUniforms(this->program, 0, 1);
+        }
+        glUseProgram(0);
+        this->uniformsSent = false;
+        return true;
+    }
+
+public:
+    ParallaxCompositor()
+        : texture(0), program(0), vao(0), streamer(NULL), layerCount(0), width(0), height(0), scrollLocation(-1),
+          cameraLocation(-1), uvScaleLocation(-1), clearColorLocation(-1), uniformsSent(false) {}
+
+    ~ParallaxCompositor() {
+        glDeleteTextures(1, &this->texture);
+        glDeleteVertexArrays(1, &this->vao);
+        glDeleteProgram(this->program);
+    }
+
+    ParallaxCompositor(const ParallaxCompositor &) = delete;
+    ParallaxCompositor &operator=(const ParallaxCompositor &) = delete;
+
+    // Carrega layer->filename de cada camada na fatia correspondente do array
+    // (layer->tid passa a ser o índice da fatia). Com `jobs`, os PNGs são
+    // decodificados em paralelo; o envio para a GPU fica na thread atual.
+    bool load(const std::vector<Layer *> &layers, JobSystem *jobs = NULL) {
+        int n = (int) layers.size();
+        if (n == 0 || n > MAX_PARALLAX_LAYERS) {
+            std::cerr << "Número de camadas inválido: " << n << " (máximo " << MAX_PARALLAX_LAYERS << ")" << std::endl;
+            return false;
+        }
+
+        std::vector<unsigned char *> pixels(n, (unsigned char *) NULL);
+        std::vector<int> widths(n), heights(n);
+        auto decode = [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+                int channels;
+                pixels[i] = stbi_load(layers[i]->filename, &widths[i], &heights[i], &channels, 4);
+            }
+        };
+        if (jobs != NULL) {
+            jobs->parallelFor(0, n, 1, decode);
+        } else {
+            decode(0, n);
+        }
+
+        bool ok = true;
+        for (int i = 0; i < n; i++) {
+            if (pixels[i] == NULL) {
+                std::cerr << "Falha ao carregar camada " << layers[i]->filename << std::endl;
+                ok = false;
+            } else if (widths[i] != widths[0] || heights[i] != heights[0]) {
+                std::cerr << "Camada " << layers[i]->filename << " tem tamanho diferente da primeira" << std::endl;
+                ok = false;
+            }
+        }
+
+        if (ok) {
+            this->layerCount = n;
+            this->width = widths[0];
+            this->height = heights[0];
+
+            glGenTextures(1, &this->texture);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, this->texture);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, this->width, this->height, n, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            for (int i = 0; i < n; i++) {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, this->width, this->height, 1,
+                                GL_RGBA, GL_UNSIGNED_BYTE, pixels[i]);
+                layers[i]->tid = i;
+            }
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+            glGenVertexArrays(1, &this->vao);
+            ok = createProgram(false);
+        }
+
+        for (int i = 0; i < n; i++) {
+            stbi_image_free(pixels[i]);
+        }
+        return ok;
+    }
+
+    // Usa as faixas de `streamer` (já com createTextures() feito) como camadas;
+    // a faixa i segue layers[i] em draw(). O streamer continua sendo do chamador.
+    bool loadStreamed(BackgroundStreamer *streamer) {
+        int n = streamer->getStripCount();
+        if (n == 0 || n > MAX_PARALLAX_LAYERS) {
+            std::cerr << "Número de camadas inválido: " << n << " (máximo " << MAX_PARALLAX_LAYERS << ")" << std::endl;
+            return false;
+        }
+        this->streamer = streamer;
+        this->layerCount = n;
+        this->height = streamer->getHeight();
+        this->width = this->height; // st.x em alturas da faixa
+        glGenVertexArrays(1, &this->vao);
+        return createProgram(true);
+    }
+
+    // Desenha todas as camadas em uma única chamada. viewportW/H só servem para
+    // manter a proporção das imagens (a textura repete na horizontal). Só os
+    // uniforms que mudaram desde o último draw() são reenviados.
+    void draw(const std::vector<Layer *> &layers, float cameraX, float cameraY,
+              int viewportW, int viewportH, float r = 0.0f, float g = 0.0f, float b = 0.0f) {
+        GLfloat scroll[4 * MAX_PARALLAX_LAYERS];
+        for (int i = 0; i < this->layerCount; i++) {
+            scroll[4 * i + 0] = layers[i]->offsetx;
+            scroll[4 * i + 1] = layers[i]->offsety;
+            scroll[4 * i + 2] = layers[i]->ratex;
+            scroll[4 * i + 3] = layers[i]->ratey;
+        }
+        float imageAspect = (float) this->width / (float) this->height;
+        float viewAspect = (float) viewportW / (float) viewportH;
+        float uvScale = viewAspect / imageAspect;
+        bool resend = !this->uniformsSent;
+
+        glUseProgram(this->program);
+        if (resend || memcmp(scroll, this->sentScroll, this->layerCount * 4 * sizeof(GLfloat)) != 0) {
+            glUniform4fv(this->scrollLocation, this->layerCount, scroll);
+            memcpy(this->sentScroll, scroll, this->layerCount * 4 * sizeof(GLfloat));
+        }
+        if (resend || cameraX != this->sentCamera[0] || cameraY != this->sentCamera[1]) {
+            glUniform2f(this->cameraLocation, cameraX, cameraY);
+            this->sentCamera[0] = cameraX;
+            this->sentCamera[1] = cameraY;
+        }
+        if (resend || uvScale != this->sentUvScale) {
+            glUniform2f(this->uvScaleLocation, uvScale, 1.0f);
+            this->sentUvScale = uvScale;
+        }
+        if (resend || r != this->sentClearColor[0] || g != this->sentClearColor[1] || b != this->sentClearColor[2]) {
+            glUniform3f(this->clearColorLocation, r, g, b);
+            this->sentClearColor[0] = r;
+            this->sentClearColor[1] = g;
+            this->sentClearColor[2] = b;
+        }
+        this->uniformsSent = true;
+
+        if (this->streamer != NULL) {
+            this->streamer->bind(0, 1);
+        } else {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, this->texture);
+        }
+        glBindVertexArray(this->vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    int getLayerCount() const {
+        return this->layerCount;
+    }
+};
+
+#endif /* ParallaxCompositor_h */
@@ -1,66 +1,406 @@
+#ifndef TileMap_h
+#define TileMap_h
+
+#include <stdint.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// O mapa é dividido em chunks de 32x32 tiles. Um chunk é "uniforme" (todos os
+// tiles iguais, nenhum byte além do descritor) ou "empacotado": uma paleta local
+// com os ids presentes no chunk e 1, 2, 3 ou 4 bits por tile (8 quando a paleta
+// estoura 16 ids). Com os 7 tiles do tilesetIso cada tile ocupa no máximo 3 bits.
+// Um tile nunca cruza a fronteira de uma palavra de 64 bits, então getTile
+// decodifica com uma multiplicação, um shift e uma máscara.
+#define TILEMAP_CHUNK_SHIFT 5
+#define TILEMAP_CHUNK_SIZE (1 << TILEMAP_CHUNK_SHIFT)
+#define TILEMAP_CHUNK_MASK (TILEMAP_CHUNK_SIZE - 1)
+#define TILEMAP_CHUNK_CELLS (TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE)
+#define TILEMAP_PALETTE_MAX 16
+#define TILEMAP_DIV_SHIFT 20
+
+// propriedades de cada id de tile, usadas pelos bitboards de colisão
+#define TILE_BLOCKED 0x1 // não caminhável
+#define TILE_HAZARD  0x2 // caminhável, mas perigoso (ex.: lava)
+
+struct TileChunk {
+    uint64_t *words;                         // tiles empacotados (NULL quando uniforme)
+    uint32_t divMagic;                       // ceil(2^20 / perWord): i / perWord sem divisão
+    uint8_t bits;                            // bits por tile (0 = chunk uniforme)
+    uint8_t perWord;                         // tiles por palavra de 64 bits
+    uint8_t value;                           // id do chunk uniforme
+    uint8_t paletteSize;
+    uint8_t palette[TILEMAP_PALETTE_MAX];    // índice empacotado -> id do tile
+};
+
 class TileMap {
     float z;               // caso de eventual de vários tilemaps sobrepostos
     unsigned int tid;      // indicação do tileset utilizado
     int width, height;     // dimensões da matriz
-    unsigned char *map; // mapa com ids dos tiles que formam o cenário
+    int chunksX, chunksY;  // dimensões da matriz de chunks
+    TileChunk *chunks;     // mapa com ids dos tiles que formam o cenário, compactado
+    unsigned char *dense;  // cópia descompactada, criada apenas por getMap()
+
+    // Bitboards de colisão: 1 bit por tile, linha a linha, cada linha alinhada
+    // em palavras de 32 bits. Só existem depois do primeiro setTileFlags.
+    unsigned char tileFlags[256];
+    int wordsPerRow;
+    uint32_t *walkBits;    // 1 = caminhável
+    uint32_t *hazardBits;  // 1 = perigoso
+
+    TileChunk &chunkAt(int col, int row) {
+        return this->chunks[(col >> TILEMAP_CHUNK_SHIFT) + (row >> TILEMAP_CHUNK_SHIFT) * this->chunksX];
+    }
+
+    static int cellIndex(int col, int row) {
+        return (col & TILEMAP_CHUNK_MASK) + ((row & TILEMAP_CHUNK_MASK) << TILEMAP_CHUNK_SHIFT);
+    }
+
+    static unsigned char decodeCell(const TileChunk &c, int i) {
+        if (c.bits == 0) {
+            return c.value;
+        }
+        unsigned int w = ((unsigned int) i * c.divMagic) >> TILEMAP_DIV_SHIFT;
+        unsigned int shift = ((unsigned int) i - w * c.perWord) * c.bits;
+        unsigned int v = (unsigned int) (c.words[w] >> shift) & ((1u << c.bits) - 1u);
+        return c.bits == 8 ? (unsigned char) v : c.palette[v];
+    }
+
+    static void encodeCell(TileChunk &c, int i, unsigned int v) {
+        unsigned int w = ((unsigned int) i * c.divMagic) >> TILEMAP_DIV_SHIFT;
+        unsigned int shift = ((unsigned int) i - w * c.perWord) * c.bits;
+        uint64_t mask = (uint64_t) ((1u << c.bits) - 1u) << shift;
+        c.words[w] = (c.words[w] & ~mask) | ((uint64_t) v << shift);
+    }
+
+    static int paletteIndex(const TileChunk &c, unsigned char tile) {
+        if (c.bits == 8) {
+            return tile;
+        }
+        for (int p = 0; p < c.paletteSize; p++) {
+            if (c.palette[p] == tile) {
+                return p;
+            }
+        }
+        return -1;
+    }
+
+    static void decodeChunk(const TileChunk &c, unsigned char *cells) {
+        if (c.bits == 0) {
+            memset(cells, c.value, TILEMAP_CHUNK_CELLS);
+            return;
+        }
+        for (int i = 0; i < TILEMAP_CHUNK_CELLS; i++) {
+            cells[i] = decodeCell(c, i);
+        }
+    }
+
+    // reconstrói o chunk a partir dos ids descompactados, escolhendo a menor paleta
+    static void encodeChunk(TileChunk &c, const unsigned char *cells) {
+        bool seen[256] = {false};
+        unsigned char palette[TILEMAP_PALETTE_MAX];
+        int distinct = 0;
+        for (int i = 0; i < TILEMAP_CHUNK_CELLS; i++) {
+            if (!seen[cells[i]]) {
+                seen[cells[i]] = true;
+                if (distinct < TILEMAP_PALETTE_MAX) {
+                    palette[distinct] = cells[i];
+                }
+                distinct++;
+            }
+        }
+
+        delete[] c.words;
+        c.words = NULL;
+        if (distinct == 1) {
+            c.bits = 0;
+            c.value = cells[0];
+            c.paletteSize = 0;
+            return;
+        }
+
+        c.bits = distinct <= 2 ? 1 : distinct <= 4 ? 2 : distinct <= 8 ? 3 : distinct <= 16 ? 4 : 8;
+        c.perWord = 64 / c.bits;
+        c.divMagic = ((1u << TILEMAP_DIV_SHIFT) + c.perWord - 1) / c.perWord;
+        c.paletteSize = c.bits == 8 ? 0 : distinct;
+        memcpy(c.palette, palette, c.paletteSize);
+
+        int numWords = (TILEMAP_CHUNK_CELLS + c.perWord - 1) / c.perWord;
+        c.words = new uint64_t[numWords]();
+        for (int i = 0; i < TILEMAP_CHUNK_CELLS; i++) {
+            encodeCell(c, i, (unsigned int) paletteIndex(c, cells[i]));
+        }
+    }
+
+    void updateBits(int col, int row, unsigned char tile) {
+        uint32_t bit = 1u << (col & 31);
+        int w = row * this->wordsPerRow + (col >> 5);
+        if (this->tileFlags[tile] & TILE_BLOCKED) {
+            this->walkBits[w] &= ~bit;
+        } else {
+            this->walkBits[w] |= bit;
+        }
+        if (this->tileFlags[tile] & TILE_HAZARD) {
+            this->hazardBits[w] |= bit;
+        } else {
+            this->hazardBits[w] &= ~bit;
+        }
+    }
+
+    void rebuildBits() {
+        int words = this->wordsPerRow * this->height;
+        if (this->walkBits == NULL) {
+            this->walkBits = new uint32_t[words];
+            this->hazardBits = new uint32_t[words];
+        }
+        memset(this->walkBits, 0, sizeof(uint32_t) * words);
+        memset(this->hazardBits, 0, sizeof(uint32_t) * words);
+        for (int row = 0; row < this->height; row++) {
+            for (int col = 0; col < this->width; col++) {
+                updateBits(col, row, (unsigned char) getTile(col, row));
+            }
+        }
+    }
+
+    // out[i] = bit (cols[i], rows[i]) do bitboard; posições fora do mapa valem 0
+    int queryBits(const uint32_t *bits, const int32_t *cols, const int32_t *rows, int n, uint8_t *out) const {
+        int count = 0;
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i w = _mm256_set1_epi32(this->width);
+        const __m256i h = _mm256_set1_epi32(this->height);
+        const __m256i minusOne = _mm256_set1_epi32(-1);
+        const __m256i stride = _mm256_set1_epi32(this->wordsPerRow);
+        const __m256i bitMask = _mm256_set1_epi32(31);
+        for (; i + 8 <= n; i += 8) {
+            __m256i c = _mm256_loadu_si256((const __m256i *) (cols + i));
+            __m256i r = _mm256_loadu_si256((const __m256i *) (rows + i));
+            __m256i inside = _mm256_and_si256(
+                _mm256_and_si256(_mm256_cmpgt_epi32(w, c), _mm256_cmpgt_epi32(c, minusOne)),
+                _mm256_and_si256(_mm256_cmpgt_epi32(h, r), _mm256_cmpgt_epi32(r, minusOne)));
+            __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(r, stride), _mm256_srli_epi32(c, 5));
+            __m256i words = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *) bits, idx, inside, 4);
+            __m256i lane = _mm256_sllv_epi32(words, _mm256_sub_epi32(bitMask, _mm256_and_si256(c, bitMask)));
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(lane));
+            for (int k = 0; k < 8; k++) {
+                out[i + k] = (uint8_t) ((mask >> k) & 1);
+                count += (mask >> k) & 1;
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            int c = cols[i];
+            int r = rows[i];
+            uint8_t v = 0;
+            if ((unsigned int) c < (unsigned int) this->width && (unsigned int) r < (unsigned int) this->height) {
+                v = (uint8_t) ((bits[r * this->wordsPerRow + (c >> 5)] >> (c & 31)) & 1u);
+            }
+            out[i] = v;
+            count += v;
+        }
+        return count;
+    }
 
-    
 public:
     TileMap(int w, int h, unsigned char initWith) {
-        this->map = new unsigned char [w*h];
         this->width = w;
         this->height = h;
         this->z = 0.0f;
         this->tid = 0;
+        this->chunksX = (w + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+        this->chunksY = (h + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+        this->chunks = new TileChunk[this->chunksX * this->chunksY]();
+        for (int i = 0; i < this->chunksX * this->chunksY; i++) {
+            this->chunks[i].value = initWith;
+        }
+        this->dense = NULL;
+        memset(this->tileFlags, 0, sizeof(this->tileFlags));
+        this->wordsPerRow = (w + 31) >> 5;
+        this->walkBits = NULL;
+        this->hazardBits = NULL;
+    }
+
+    ~TileMap() {
+        for (int i = 0; i < this->chunksX * this->chunksY; i++) {
+            delete[] this->chunks[i].words;
+        }
+        delete[] this->chunks;
+        delete[] this->dense;
+        delete[] this->walkBits;
+        delete[] this->hazardBits;
     }
-    
-//    TileMap(const TileMap &tm) {
-//        map = new unsigned char[tm.width * tm.height];
-//        this->width = tm.width;
-//        this->height = tm.height;
-//        this->z = tm.z;
-//        this->tid = tm.tid;
-////        for (int i=0; this->width * this->height; i++) {
-////            this->map[i] = tm.map[i];
-////        }
-//        memcpy(this->map, tm.map, tm.width*tm.height);
-//    }
-    
+
+    TileMap(const TileMap &) = delete;
+    TileMap &operator=(const TileMap &) = delete;
+
+    // Cópia descompactada (1 byte por tile, linha a linha). Serve apenas para
+    // código legado que precisa do vetor cru: custa width*height bytes e só
+    // reflete os setTile feitos antes da chamada.
     unsigned char* getMap() {
-        return this->map;
+        if (this->dense == NULL) {
+            this->dense = new unsigned char[this->width * this->height];
+        }
+        for (int row = 0; row < this->height; row++) {
+            for (int col = 0; col < this->width; col++) {
+                this->dense[col + row * this->width] = (unsigned char) getTile(col, row);
+            }
+        }
+        return this->dense;
     }
-    
+
     int getWidth() {
         return this->width;
     }
-    
+
     int getHeight() {
         return this->height;
     }
-    
+
     int getTile(int col, int row) {
-        return this->map[col + row * this->width];
+        return decodeCell(chunkAt(col, row), cellIndex(col, row));
+    }
+
+    void setPackedTile(int col, int row, unsigned char tile) {
+        TileChunk &c = chunkAt(col, row);
+        int i = cellIndex(col, row);
+        if (c.bits == 0 && c.value == tile) {
+            return;
+        }
+        int p = c.bits == 0 ? -1 : paletteIndex(c, tile);
+        if (p >= 0) {
+            encodeCell(c, i, (unsigned int) p);
+            return;
+        }
+        // id fora da paleta: o chunk precisa de mais bits
+        unsigned char cells[TILEMAP_CHUNK_CELLS];
+        decodeChunk(c, cells);
+        cells[i] = tile;
+        encodeChunk(c, cells);
     }
-    
+
     void setTile(int col, int row, unsigned char tile) {
-        this->map[col + row * this->width] = tile;
+        setPackedTile(col, row, tile);
+        if (this->walkBits != NULL) {
+            updateBits(col, row, tile);
+        }
+    }
+
+    // Define as propriedades (TILE_BLOCKED, TILE_HAZARD) de um id de tile.
+    // A primeira chamada cria os bitboards; as seguintes os reconstroem.
+    void setTileFlags(unsigned char tile, unsigned char flags) {
+        this->tileFlags[tile] = flags;
+        rebuildBits();
+    }
+
+    unsigned char getTileFlags(unsigned char tile) {
+        return this->tileFlags[tile];
+    }
+
+    // posição dentro do mapa e sem TILE_BLOCKED (sem bitboards, tudo é caminhável)
+    bool isWalkable(int col, int row) {
+        if ((unsigned int) col >= (unsigned int) this->width || (unsigned int) row >= (unsigned int) this->height) {
+            return false;
+        }
+        if (this->walkBits == NULL) {
+            return true;
+        }
+        return (this->walkBits[row * this->wordsPerRow + (col >> 5)] >> (col & 31)) & 1u;
+    }
+
+    bool isHazard(int col, int row) {
+        if (this->hazardBits == NULL ||
+            (unsigned int) col >= (unsigned int) this->width || (unsigned int) row >= (unsigned int) this->height) {
+            return false;
+        }
+        return (this->hazardBits[row * this->wordsPerRow + (col >> 5)] >> (col & 31)) & 1u;
     }
-    
+
+    // Consultas em lote: out[i] recebe isWalkable/isHazard(cols[i], rows[i]).
+    // Retornam quantas posições passaram no teste. Com AVX2 são testadas 8
+    // posições por vez (gather das palavras do bitboard).
+    int walkableBatch(const int32_t *cols, const int32_t *rows, int n, uint8_t *out) {
+        if (this->walkBits == NULL) {
+            rebuildBits();
+        }
+        return queryBits(this->walkBits, cols, rows, n, out);
+    }
+
+    int hazardBatch(const int32_t *cols, const int32_t *rows, int n, uint8_t *out) {
+        if (this->hazardBits == NULL) {
+            rebuildBits();
+        }
+        return queryBits(this->hazardBits, cols, rows, n, out);
+    }
+
+    // Move n agentes de uma vez: cada (cols[i], rows[i]) anda (dcols[i], drows[i])
+    // apenas se o destino for caminhável. Retorna quantos agentes se moveram.
+    int moveBatch(int32_t *cols, int32_t *rows, const int32_t *dcols, const int32_t *drows, int n) {
+        const int BLOCK = 256;
+        int32_t targetCols[BLOCK], targetRows[BLOCK];
+        uint8_t ok[BLOCK];
+        int moved = 0;
+        for (int base = 0; base < n; base += BLOCK) {
+            int m = n - base < BLOCK ? n - base : BLOCK;
+            for (int i = 0; i < m; i++) {
+                targetCols[i] = cols[base + i] + dcols[base + i];
+                targetRows[i] = rows[base + i] + drows[base + i];
+            }
+            moved += walkableBatch(targetCols, targetRows, m, ok);
+            for (int i = 0; i < m; i++) {
+                cols[base + i] = ok[i] ? targetCols[i] : cols[base + i];
+                rows[base + i] = ok[i] ? targetRows[i] : rows[base + i];
+            }
+        }
+        return moved;
+    }
+
+    // Reempacota todos os chunks com a menor paleta possível (chunks que voltaram
+    // a ter um único id viram uniformes). Útil depois de muitas edições.
+    void compact() {
+        unsigned char cells[TILEMAP_CHUNK_CELLS];
+        for (int i = 0; i < this->chunksX * this->chunksY; i++) {
+            if (this->chunks[i].bits != 0) {
+                decodeChunk(this->chunks[i], cells);
+                encodeChunk(this->chunks[i], cells);
+            }
+        }
+    }
+
+    // memória ocupada pelo mapa compactado, em bytes
+    size_t residentBytes() {
+        size_t bytes = sizeof(TileMap) + sizeof(TileChunk) * this->chunksX * this->chunksY;
+        for (int i = 0; i < this->chunksX * this->chunksY; i++) {
+            const TileChunk &c = this->chunks[i];
+            if (c.bits != 0) {
+                bytes += sizeof(uint64_t) * ((TILEMAP_CHUNK_CELLS + c.perWord - 1) / c.perWord);
+            }
+        }
+        if (this->dense != NULL) {
+            bytes += this->width * this->height;
+        }
+        if (this->walkBits != NULL) {
+            bytes += 2 * sizeof(uint32_t) * this->wordsPerRow * this->height;
+        }
+        return bytes;
+    }
+
     int getTileSet() {
         return this->tid;
     }
-    
+
     float getZ() {
         return this->z;
     }
-    
+
     void setZ(float z){
         this->z = z;
     }
-    
+
     void setTid(int tid) {
         this->tid = tid;
     }
-    
+
 };
 
+#endif /* TileMap_h */
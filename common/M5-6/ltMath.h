@@ -44,12 +44,14 @@ float dot (float *a, float *b) {
     return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
 }
 
-float * cross (float *a, float *b) {
+// out = a x b (out may be a or b)
+void cross (float *a, float *b, float *out) {
     float x = a[1] * b[2] - a[2] * b[1];
     float y = a[2] * b[0] - a[0] * b[2];
     float z = a[0] * b[1] - a[1] * b[0];
-    float v[] = {x, y, z};
-    return v;
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
 }
 
 
@@ -61,21 +63,16 @@ float triangleArea2D(float *triangle){
     return fabs(((triangle[2] - triangle[0])*(triangle[5] - triangle[1]) - (triangle[4] - triangle[0]) * (triangle[3] - triangle[1]))/2);
 }
 
-// tests: triangle area X point--sub-triangles areas
+// tests: point on the inner side of the three edges (edge functions); the
+// border counts as inside. For many points or many triangles see TriangleSet.h
 bool triangleCollidePoint2D(float *triangle, float *point){
-	float a = triangleArea2D(triangle);
+    float e0 = (triangle[2] - triangle[0]) * (point[1] - triangle[1]) - (triangle[3] - triangle[1]) * (point[0] - triangle[0]);
+    float e1 = (triangle[4] - triangle[2]) * (point[1] - triangle[3]) - (triangle[5] - triangle[3]) * (point[0] - triangle[2]);
+    float e2 = (triangle[0] - triangle[4]) * (point[1] - triangle[5]) - (triangle[1] - triangle[5]) * (point[0] - triangle[4]);
 
-    float subtri1[] = {triangle[0], triangle[1], triangle[2], triangle[3], point[0], point[1]};
-    float subtri2[] = {triangle[0], triangle[1], point[0], point[1], triangle[4], triangle[5]};
-    float subtri3[] = {point[0], point[1], triangle[2], triangle[3], triangle[4], triangle[5]};
-    
-	float a1 = triangleArea2D(subtri1);
-	float a2 = triangleArea2D(subtri2);
-	float a3 = triangleArea2D(subtri3);
-
-    // cout << "\tDEBUG => a: " << a << " a1: " << a1 << " + a2: " << a2 << " + a3: " << a3 << " = " << (a1+a2+a3) << endl;
-	
-	return a == (a1+a2+a3);
+    bool hasNegative = (e0 < 0) || (e1 < 0) || (e2 < 0);
+    bool hasPositive = (e0 > 0) || (e1 > 0) || (e2 > 0);
+    return !(hasNegative && hasPositive) && triangleArea2D(triangle) > 0;
 }
 
 bool collideByDotProduct(float *triangle, float *point){
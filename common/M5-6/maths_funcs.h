@@ -134,6 +134,14 @@ mat4 identity_mat4 ();
 float determinant (const mat4& mm);
 mat4 inverse (const mat4& mm);
 mat4 transpose (const mat4& mm);
+// plain loops behind the operators and functions above, which use SSE2/NEON
+// when the target has them (see maths_funcs.cpp)
+vec4 mul_scalar (const mat4& m, const vec4& v);
+mat4 mul_scalar (const mat4& a, const mat4& b);
+mat4 inverse_scalar (const mat4& mm);
+mat4 transpose_scalar (const mat4& mm);
+// "sse2", "neon" or "scalar"
+const char* maths_simd_backend ();
 // affine functions
 mat4 translate (const mat4& m, const vec3& v);
 mat4 rotate_x_deg (const mat4& m, float deg);
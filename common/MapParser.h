@@ -0,0 +1,87 @@
+#ifndef MapParser_h
+#define MapParser_h
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "TileMap.h"
+
+// Leitura dos arquivos de mapa em texto do TrabalhoGB (assets/maps/):
+//
+//   largura altura
+//   id id id ...      (uma linha por linha do mapa, largura ids cada)
+//
+// e do arquivo de objetivos, um par "linha coluna" por linha. Fica fora do
+// TrabalhoGB para o pgcc_bench medir exatamente o mesmo código.
+
+// mesmas partes que getline daria (sem a vazia depois do último delimitador),
+// sem copiar o texto inteiro para um stringstream
+inline std::vector<std::string> split(std::string_view texto, char delimitador) {
+    std::vector<std::string> partes;
+    size_t inicio = 0;
+
+    while (inicio < texto.size()) {
+        size_t fim = texto.find(delimitador, inicio);
+        if (fim == std::string_view::npos) {
+            fim = texto.size();
+        }
+        partes.push_back(std::string(texto.substr(inicio, fim - inicio)));
+        inicio = fim + 1;
+    }
+
+    return partes;
+}
+
+// números inteiros da linha, separados por espaço; o resto é ignorado
+inline std::vector<int> extrairValores(const std::string &linha) {
+    std::vector<int> valores;
+    std::vector<std::string> partes = split(linha, ' ');
+
+    for (const std::string &parte : partes) {
+        try {
+            valores.push_back(std::stoi(parte));
+        } catch (const std::invalid_argument &) {
+        }
+    }
+
+    return valores;
+}
+
+// Monta o TileMap (alocado com new) a partir do texto do mapa. Linhas com a
+// quantidade errada de ids são puladas e ficam com o tile 0.
+inline TileMap *parseMap(std::string_view texto, int &largura, int &altura) {
+    std::vector<std::string> linhas = split(texto, '\n');
+    std::vector<int> tamanhoMapa = linhas.empty() ? std::vector<int>() : extrairValores(linhas[0]);
+    if (tamanhoMapa.size() < 2 || tamanhoMapa[0] <= 0 || tamanhoMapa[1] <= 0) {
+        throw std::runtime_error("Cabeçalho do mapa inválido (esperado \"largura altura\")");
+    }
+    largura = tamanhoMapa[0];
+    altura = tamanhoMapa[1];
+
+    TileMap *mapa = new TileMap(largura, altura, 0);
+    for (int i = 1; i < (int) linhas.size() && i <= altura; ++i) {
+        std::vector<int> valoresLinha = extrairValores(linhas[i]);
+        if ((int) valoresLinha.size() == largura) {
+            for (int j = 0; j < largura; ++j) {
+                mapa->setTile(j, i - 1, (unsigned char) valoresLinha[j]);
+            }
+        }
+    }
+    return mapa;
+}
+
+// acrescenta a `objetivos` os pares (linha, coluna) do texto
+inline void parseObjectives(std::string_view texto, std::vector<std::pair<int, int>> &objetivos) {
+    std::vector<std::string> linhas = split(texto, '\n');
+    for (const std::string &linha : linhas) {
+        std::vector<int> valoresLinha = extrairValores(linha);
+        if (valoresLinha.size() >= 2) {
+            objetivos.push_back(std::make_pair(valoresLinha[0], valoresLinha[1]));
+        }
+    }
+}
+
+#endif /* MapParser_h */
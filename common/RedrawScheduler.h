@@ -0,0 +1,126 @@
+#ifndef RedrawScheduler_h
+#define RedrawScheduler_h
+
+#include <GLFW/glfw3.h>
+
+// Laço de desenho sob demanda.
+//
+// Em vez de glfwPollEvents + redesenho a cada volta, o programa marca a cena
+// como suja (invalidate) quando o estado do jogo muda e agenda redesenhos
+// futuros (scheduleAt/scheduleIn) quando algo anima. Sem nada pendente o laço
+// dorme em glfwWaitEvents e não usa CPU nem GPU; mudanças no tamanho ou
+// exposição da janela também sujam a cena.
+//
+//     RedrawScheduler redraw;
+//     redraw.install(window);
+//     while (!glfwWindowShouldClose(window)) {
+//         redraw.waitEvents();
+//         ... atualiza, chama invalidate()/scheduleIn() ...
+//         if (!redraw.beginFrame()) continue;
+//         ... desenha e glfwSwapBuffers ...
+//     }
+//
+// Com onDemand = false o comportamento é o antigo: poll e desenho contínuos.
+// Os callbacks de tamanho e refresh são globais, então há um scheduler
+// instalado por programa.
+//
+// Os pedidos e a decisão de desenhar usam o relógio de setClock (glfwGetTime
+// por padrão); o InputReplay troca pelo tempo gravado de cada volta, para a
+// reprodução desenhar exatamente os mesmos quadros.
+
+class RedrawScheduler {
+    bool onDemand;
+    bool dirty;
+    double wakeAt;  // próximo redesenho agendado (clock), < 0 = nenhum
+    double (*clock)();
+
+    static RedrawScheduler *&installed() {
+        static RedrawScheduler *scheduler = NULL;
+        return scheduler;
+    }
+
+    static void framebufferResized(GLFWwindow *, int, int) {
+        if (installed() != NULL) {
+            installed()->invalidate();
+        }
+    }
+
+    static void windowRefresh(GLFWwindow *) {
+        if (installed() != NULL) {
+            installed()->invalidate();
+        }
+    }
+
+public:
+    explicit RedrawScheduler(bool onDemand = true)
+        : onDemand(onDemand), dirty(true), wakeAt(-1.0), clock(glfwGetTime) {}
+
+    void install(GLFWwindow *window) {
+        installed() = this;
+        glfwSetFramebufferSizeCallback(window, framebufferResized);
+        glfwSetWindowRefreshCallback(window, windowRefresh);
+    }
+
+    void setClock(double (*clock)()) {
+        this->clock = clock;
+    }
+
+    void setOnDemand(bool onDemand) {
+        this->onDemand = onDemand;
+        this->dirty = true;
+    }
+
+    bool isOnDemand() const {
+        return this->onDemand;
+    }
+
+    // o próximo quadro precisa ser desenhado
+    void invalidate() {
+        this->dirty = true;
+    }
+
+    // pede um redesenho no instante `time`; vale o pedido mais próximo
+    void scheduleAt(double time) {
+        if (this->wakeAt < 0.0 || time < this->wakeAt) {
+            this->wakeAt = time;
+        }
+    }
+
+    void scheduleIn(double seconds) {
+        scheduleAt(this->clock() + seconds);
+    }
+
+    // Processa os eventos pendentes. Sob demanda, bloqueia até chegar um
+    // evento ou até o próximo redesenho agendado.
+    void waitEvents() {
+        if (!this->onDemand || this->dirty) {
+            glfwPollEvents();
+        } else if (this->wakeAt < 0.0) {
+            glfwWaitEvents();
+        } else {
+            // a espera é sempre em tempo real, mesmo com outro relógio
+            double timeout = this->wakeAt - glfwGetTime();
+            if (timeout > 0.0) {
+                glfwWaitEventsTimeout(timeout);
+            } else {
+                glfwPollEvents();
+            }
+        }
+    }
+
+    // true se este quadro deve ser desenhado; consome a marca de sujo
+    bool beginFrame() {
+        if (!this->onDemand) {
+            return true;
+        }
+        if (this->wakeAt >= 0.0 && this->clock() >= this->wakeAt) {
+            this->dirty = true;
+            this->wakeAt = -1.0;
+        }
+        bool draw = this->dirty;
+        this->dirty = false;
+        return draw;
+    }
+};
+
+#endif /* RedrawScheduler_h */
@@ -0,0 +1,178 @@
+#ifndef SpatialHash_h
+#define SpatialHash_h
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+// Hash espacial uniforme para muitos objetos do mesmo tamanho (partículas,
+// inimigos, moedas...).
+//
+// O plano é dividido em células de `cellSize` e cada célula (cx, cy) cai em
+// um de `tableSize` buckets por hash, então o mundo não precisa ter limites.
+// build() monta tudo de uma vez com counting sort: os índices dos objetos de
+// cada bucket ficam contíguos, sem alocação por objeto. Para objetos que se
+// movem, o normal é chamar build() de novo a cada quadro (O(n)).
+//
+// Cada objeto é um ponto (o centro) com meia-largura `halfSize` comum a todos;
+// consultas por ponto e por retângulo consideram essa extensão. As consultas
+// recebem um visitante `bool visit(int index)`; retornar false interrompe.
+// Buckets compartilhados por células diferentes podem trazer candidatos de
+// fora: o teste final é sempre feito contra as posições.
+
+class SpatialHash {
+    float cellSize;
+    float inverseCellSize;
+    float halfSize;
+    int tableSize;
+    const float *x;
+    const float *y;
+    int count;
+    std::vector<int> bucketStart; // tableSize + 1
+    std::vector<int> entries;     // índices dos objetos, agrupados por bucket
+    std::vector<int> bucketOfObject;
+    std::vector<int> cursor;
+
+    int cellOf(float v) const {
+        return (int) floorf(v * this->inverseCellSize);
+    }
+
+    int bucket(int cx, int cy) const {
+        uint32_t h = (uint32_t) cx * 73856093u ^ (uint32_t) cy * 19349663u;
+        return (int) (h % (uint32_t) this->tableSize);
+    }
+
+    bool overlaps(int i, float minX, float minY, float maxX, float maxY) const {
+        return this->x[i] + this->halfSize >= minX && this->x[i] - this->halfSize <= maxX &&
+               this->y[i] + this->halfSize >= minY && this->y[i] - this->halfSize <= maxY;
+    }
+
+public:
+    explicit SpatialHash(float cellSize, float halfSize = 0.0f)
+        : cellSize(cellSize), inverseCellSize(1.0f / cellSize), halfSize(halfSize), tableSize(1), x(NULL), y(NULL),
+          count(0) {}
+
+    // Indexa `count` objetos com centros em x[i], y[i]. Os arrays são
+    // referenciados (não copiados) até o próximo build().
+    void build(const float *x, const float *y, int count) {
+        this->x = x;
+        this->y = y;
+        this->count = count;
+        // ~2 buckets por objeto mantém as colisões de hash raras
+        this->tableSize = count > 0 ? 2 * count : 1;
+        this->bucketStart.assign(this->tableSize + 1, 0);
+        this->bucketOfObject.resize(count);
+        for (int i = 0; i < count; i++) {
+            int b = bucket(cellOf(x[i]), cellOf(y[i]));
+            this->bucketOfObject[i] = b;
+            this->bucketStart[b + 1]++;
+        }
+        for (int b = 0; b < this->tableSize; b++) {
+            this->bucketStart[b + 1] += this->bucketStart[b];
+        }
+        this->cursor.assign(this->bucketStart.begin(), this->bucketStart.end() - 1);
+        this->entries.resize(count);
+        for (int i = 0; i < count; i++) {
+            this->entries[this->cursor[this->bucketOfObject[i]]++] = i;
+        }
+    }
+
+    // objetos cuja caixa intersecta o retângulo
+    template <typename Visit>
+    void queryRect(float minX, float minY, float maxX, float maxY, Visit visit) const {
+        if (this->count == 0) {
+            return;
+        }
+        // os centros que interessam estão no retângulo alargado por halfSize
+        int cx0 = cellOf(minX - this->halfSize), cx1 = cellOf(maxX + this->halfSize);
+        int cy0 = cellOf(minY - this->halfSize), cy1 = cellOf(maxY + this->halfSize);
+        if ((int64_t) (cx1 - cx0 + 1) * (cy1 - cy0 + 1) > this->tableSize) {
+            // retângulo maior que a tabela: varrer tudo é mais barato
+            for (int i = 0; i < this->count; i++) {
+                if (overlaps(i, minX, minY, maxX, maxY) && !visit(i)) {
+                    return;
+                }
+            }
+            return;
+        }
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                int b = bucket(cx, cy);
+                for (int k = this->bucketStart[b]; k < this->bucketStart[b + 1]; k++) {
+                    int i = this->entries[k];
+                    // um objeto pode vir de outra célula do mesmo bucket; só
+                    // aceita quem está na célula visitada para não repetir
+                    if (cellOf(this->x[i]) != cx || cellOf(this->y[i]) != cy) {
+                        continue;
+                    }
+                    if (overlaps(i, minX, minY, maxX, maxY) && !visit(i)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    // objetos cuja caixa contém o ponto
+    template <typename Visit>
+    void queryPoint(float px, float py, Visit visit) const {
+        queryRect(px, py, px, py, visit);
+    }
+
+    // Índice do centro mais próximo de (px, py) a no máximo maxDistance, ou -1.
+    // Procura em anéis de células em volta do ponto.
+    int nearest(float px, float py, float maxDistance = FLT_MAX) const {
+        if (this->count == 0) {
+            return -1;
+        }
+        int best = -1;
+        float bestDistance2 = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+        int cx = cellOf(px), cy = cellOf(py);
+        // até onde vale procurar: a tabela inteira ou o raio máximo
+        int maxRing = maxDistance < FLT_MAX ? (int) (maxDistance * this->inverseCellSize) + 1 : this->tableSize;
+        for (int ring = 0; ring <= maxRing; ring++) {
+            // qualquer coisa fora deste anel está a pelo menos (ring - 1) células
+            if (best >= 0) {
+                float reach = (ring - 1) * this->cellSize;
+                if (reach > 0.0f && reach * reach >= bestDistance2) {
+                    break;
+                }
+            }
+            if ((int64_t) (2 * ring + 1) * (2 * ring + 1) > 4 * (int64_t) this->tableSize) {
+                // anéis maiores que a tabela: termina com uma varredura linear
+                for (int i = 0; i < this->count; i++) {
+                    float dx = this->x[i] - px, dy = this->y[i] - py;
+                    float d2 = dx * dx + dy * dy;
+                    if (d2 < bestDistance2) {
+                        bestDistance2 = d2;
+                        best = i;
+                    }
+                }
+                break;
+            }
+            for (int oy = -ring; oy <= ring; oy++) {
+                int step = (oy == -ring || oy == ring) ? 1 : 2 * ring;
+                for (int ox = -ring; ox <= ring; ox += step) {
+                    int b = bucket(cx + ox, cy + oy);
+                    for (int k = this->bucketStart[b]; k < this->bucketStart[b + 1]; k++) {
+                        int i = this->entries[k];
+                        float dx = this->x[i] - px, dy = this->y[i] - py;
+                        float d2 = dx * dx + dy * dy;
+                        if (d2 < bestDistance2) {
+                            bestDistance2 = d2;
+                            best = i;
+                        }
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    int size() const {
+        return this->count;
+    }
+};
+
+#endif /* SpatialHash_h */
@@ -0,0 +1,151 @@
+#ifndef SpriteTransforms_h
+#define SpriteTransforms_h
+
+#include <math.h>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <glad/glad.h>
+
+// Transformações de um lote de sprites 2D em estrutura de arrays (SoA).
+//
+// Cada sprite tem translação, escala e rotação; em vez de montar uma mat4 com
+// translate/rotate/scale e enviar 16 floats por sprite, o lote escreve a forma
+// afim 2x3 compacta, 6 floats por instância:
+//
+//     (eixoX.x, eixoX.y, eixoY.x, eixoY.y, translação.x, translação.y)
+//
+// com eixoX = escala.x * (cos, sen) e eixoY = escala.y * (-sen, cos). No vertex
+// shader a posição fica eixoX * p.x + eixoY * p.y + translação. O seno e o
+// cosseno são calculados só quando a rotação muda, então a escrita é só
+// multiplicação, 4 sprites por vez com SSE2.
+//
+// upload() só reenvia o buffer quando algo mudou desde o último envio.
+
+#define SPRITE_TRANSFORM_FLOATS 6
+
+class SpriteTransforms {
+    std::vector<float> x, y;
+    std::vector<float> scaleX, scaleY;
+    std::vector<float> cosR, sinR;
+    std::vector<float> packed;
+    bool dirty;
+
+public:
+    SpriteTransforms() : dirty(true) {}
+
+    int size() const {
+        return (int) this->x.size();
+    }
+
+    void clear() {
+        this->x.clear();
+        this->y.clear();
+        this->scaleX.clear();
+        this->scaleY.clear();
+        this->cosR.clear();
+        this->sinR.clear();
+        this->dirty = true;
+    }
+
+    int add(float x, float y, float scaleX, float scaleY, float rotation = 0.0f) {
+        this->x.push_back(x);
+        this->y.push_back(y);
+        this->scaleX.push_back(scaleX);
+        this->scaleY.push_back(scaleY);
+        this->cosR.push_back(cosf(rotation));
+        this->sinR.push_back(sinf(rotation));
+        this->dirty = true;
+        return size() - 1;
+    }
+
+    void setTranslate(int i, float x, float y) {
+        this->x[i] = x;
+        this->y[i] = y;
+        this->dirty = true;
+    }
+
+    void setScale(int i, float scaleX, float scaleY) {
+        this->scaleX[i] = scaleX;
+        this->scaleY[i] = scaleY;
+        this->dirty = true;
+    }
+
+    // em radianos, no sentido anti-horário
+    void setRotation(int i, float rotation) {
+        this->cosR[i] = cosf(rotation);
+        this->sinR[i] = sinf(rotation);
+        this->dirty = true;
+    }
+
+    // escreve SPRITE_TRANSFORM_FLOATS floats por sprite de [first, first + count)
+    void write(float *out, int first, int count) const {
+        const float *x = this->x.data(), *y = this->y.data();
+        const float *sx = this->scaleX.data(), *sy = this->scaleY.data();
+        const float *c = this->cosR.data(), *s = this->sinR.data();
+        int i = first;
+        int end = first + count;
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128 negate = _mm_set1_ps(-0.0f);
+        for (; i + 4 <= end; i += 4, out += 4 * SPRITE_TRANSFORM_FLOATS) {
+            __m128 vsx = _mm_loadu_ps(sx + i), vsy = _mm_loadu_ps(sy + i);
+            __m128 vc = _mm_loadu_ps(c + i), vs = _mm_loadu_ps(s + i);
+            __m128 ax = _mm_mul_ps(vsx, vc);
+            __m128 ay = _mm_mul_ps(vsx, vs);
+            __m128 bx = _mm_xor_ps(_mm_mul_ps(vsy, vs), negate);
+            __m128 by = _mm_mul_ps(vsy, vc);
+            // 4 sprites em colunas -> (ax, ay, bx, by) de cada sprite
+            _MM_TRANSPOSE4_PS(ax, ay, bx, by);
+            __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i);
+            __m128 t01 = _mm_unpacklo_ps(vx, vy); // x0 y0 x1 y1
+            __m128 t23 = _mm_unpackhi_ps(vx, vy); // x2 y2 x3 y3
+            _mm_storeu_ps(out, ax);
+            _mm_storel_pi((__m64 *) (out + 4), t01);
+            _mm_storeu_ps(out + 6, ay);
+            _mm_storeh_pi((__m64 *) (out + 10), t01);
+            _mm_storeu_ps(out + 12, bx);
+            _mm_storel_pi((__m64 *) (out + 16), t23);
+            _mm_storeu_ps(out + 18, by);
+            _mm_storeh_pi((__m64 *) (out + 22), t23);
+        }
+#endif
+        for (; i < end; i++, out += SPRITE_TRANSFORM_FLOATS) {
+            out[0] = sx[i] * c[i];
+            out[1] = sx[i] * s[i];
+            out[2] = -sy[i] * s[i];
+            out[3] = sy[i] * c[i];
+            out[4] = x[i];
+            out[5] = y[i];
+        }
+    }
+
+    // reescreve e envia o lote inteiro para `vbo`, se mudou
+    void upload(GLuint vbo) {
+        if (!this->dirty) {
+            return;
+        }
+        this->packed.resize((size_t) size() * SPRITE_TRANSFORM_FLOATS);
+        write(this->packed.data(), 0, size());
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, this->packed.size() * sizeof(float), this->packed.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        this->dirty = false;
+    }
+
+    // Liga `vbo` aos atributos location, location + 1 e location + 2 (eixoX,
+    // eixoY, translação; vec2 por instância) do VAO ligado.
+    static void setupAttributes(GLuint vbo, GLuint location) {
+        GLsizei stride = SPRITE_TRANSFORM_FLOATS * sizeof(float);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        for (GLuint k = 0; k < 3; k++) {
+            glVertexAttribPointer(location + k, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid *) (2 * k * sizeof(float)));
+            glEnableVertexAttribArray(location + k);
+            glVertexAttribDivisor(location + k, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+#endif /* SpriteTransforms_h */
@@ -0,0 +1,401 @@
+#ifndef TextRenderer_h
+#define TextRenderer_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <stb_easy_font.h>
+
+// Texto no core profile, em lote.
+//
+// Os glifos ASCII 32..126 da stb_easy_font são rasterizados uma única vez em
+// um atlas GL_R8. Cada caractere desenhado é uma instância (posição, escala,
+// cor e glifo) de um quad de 4 vértices gerados no vertex shader; draw() só
+// acumula instâncias e flush() envia tudo e desenha com uma chamada.
+//
+// O layout de cada string (deslocamento e glifo de cada caractere) fica em
+// cache, então um HUD que repete o mesmo texto custa uma cópia por quadro; se o
+// lote inteiro for igual ao do quadro anterior nem o envio acontece. Layouts
+// que ficam TEXT_LAYOUT_MAX_AGE flushes sem uso saem do cache. Textos que mudam
+// todo quadro, como cronômetros, devem usar drawUncached()/widthUncached(): o
+// layout é refeito em um rascunho reaproveitado, sem alocar e sem encher o
+// cache. Com textos repetidos e o lote já no tamanho máximo, um quadro de texto
+// não aloca nada.
+//
+// Coordenadas em pixels com origem no canto superior esquerdo, como a
+// stb_easy_font; scale multiplica o tamanho do glifo (12 px de altura de linha).
+
+#define TEXT_FIRST_CHAR 32
+#define TEXT_LAST_CHAR 126
+#define TEXT_CELL_WIDTH 8
+#define TEXT_CELL_HEIGHT 12
+#define TEXT_ATLAS_COLUMNS 16
+#define TEXT_LAYOUT_MAX_AGE 120
+
+class TextRenderer {
+    struct LayoutGlyph {
+        float dx, dy;
+        GLushort glyph;
+    };
+
+    struct Layout {
+        std::vector<LayoutGlyph> glyphs;
+        float width;
+        unsigned int lastUsed;
+    };
+
+    struct GlyphInstance {
+        GLfloat x, y, scale;
+        GLubyte color[4];
+        GLushort glyph;
+        GLushort padding;
+    };
+
+    GLuint atlas;
+    GLuint program;
+    GLint viewportLocation;
+    int sentViewport[2];      // último viewport enviado ao programa
+    GLuint vao;
+    GLuint instanceVBO;
+    size_t instanceCapacity;  // em instâncias
+    int atlasWidth, atlasHeight;
+    int advance[TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1];
+
+    std::unordered_map<std::string, Layout> layouts;
+    std::string key;  // chave da busca no cache, reaproveitada
+    Layout scratch;   // layout dos textos sem cache
+    std::vector<GlyphInstance> batch;
+    std::vector<GlyphInstance> uploaded;  // cópia do que está no buffer
+    unsigned int frame;
+
+    static GLuint compile(const char *source, GLenum type) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::TEXT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return shader;
+    }
+
+    bool createProgram() {
+        const char *vertexSource = R"(#version 400
+            layout(location = 0) in vec3 glyphPosition;  // x, y, escala
+            layout(location = 1) in vec4 glyphColor;
+            layout(location = 2) in uint glyph;
+
+            uniform vec2 viewport;
+            uniform vec2 cellSize;
+            uniform vec2 atlasSize;
+            uniform int atlasColumns;
+
+            out vec2 uv;
+            out vec4 color;
+
+            void main()
+            {
+                // triangle strip: (0,0), (1,0), (0,1), (1,1)
+                vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+                vec2 pixel = glyphPosition.xy + corner * cellSize * glyphPosition.z;
+                gl_Position = vec4(pixel.x / viewport.x * 2.0 - 1.0, 1.0 - pixel.y / viewport.y * 2.0, 0.0, 1.0);
+                vec2 cell = vec2(int(glyph) % atlasColumns, int(glyph) / atlasColumns);
+                uv = (cell + corner) * cellSize / atlasSize;
+                color = glyphColor;
+            })";
+        const char *fragmentSource = R"(#version 400
+            in vec2 uv;
+            in vec4 color;
+            out vec4 fragColor;
+
+            uniform sampler2D atlas;
+
+            void main()
+            {
+                float coverage = texture(atlas, uv).r;
+                if (coverage == 0.0)
+                {
+                    discard;
+                }
+                fragColor = vec4(color.rgb, color.a * coverage);
+            })";
+
+        GLuint vs = compile(vertexSource, GL_VERTEX_SHADER);
+        GLuint fs = compile(fragmentSource, GL_FRAGMENT_SHADER);
+        this->program = glCreateProgram();
+        glAttachShader(this->program, vs);
+        glAttachShader(this->program, fs);
+        glLinkProgram(this->program);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+
+        GLint success;
+        glGetProgramiv(this->program, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(this->program, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::TEXT::LINKING_FAILED\n" << infoLog << std::endl;
+            return false;
+        }
+
+        // só o viewport muda depois daqui (ver flush)
+        this->viewportLocation = glGetUniformLocation(this->program, "viewport");
+        this->sentViewport[0] = this->sentViewport[1] = -1;
+        glUseProgram(this->program);
+        glUniform2f(glGetUniformLocation(this->program, "cellSize"), TEXT_CELL_WIDTH, TEXT_CELL_HEIGHT);
+        glUniform2f(glGetUniformLocation(this->program, "atlasSize"), (float) this->atlasWidth, (float) this->atlasHeight);
+        glUniform1i(glGetUniformLocation(this->program, "atlasColumns"), TEXT_ATLAS_COLUMNS);
+        glUniform1i(glGetUniformLocation(this->program, "atlas"), 0);
+        glUseProgram(0);
+        return true;
+    }
+
+    // rasteriza os quads da stb_easy_font de cada caractere em sua célula
+    void createAtlas() {
+        int glyphCount = TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1;
+        int rows = (glyphCount + TEXT_ATLAS_COLUMNS - 1) / TEXT_ATLAS_COLUMNS;
+        this->atlasWidth = TEXT_ATLAS_COLUMNS * TEXT_CELL_WIDTH;
+        this->atlasHeight = rows * TEXT_CELL_HEIGHT;
+        std::vector<GLubyte> pixels(this->atlasWidth * this->atlasHeight, 0);
+
+        // 4 vértices de 16 bytes (x, y, z, cor) por quad
+        static float quads[4 * 4 * 64];
+        for (int c = TEXT_FIRST_CHAR; c <= TEXT_LAST_CHAR; c++) {
+            int glyph = c - TEXT_FIRST_CHAR;
+            char text[2] = {(char) c, 0};
+            this->advance[glyph] = stb_easy_font_width(text);
+            int quadCount = stb_easy_font_print(0.0f, 0.0f, text, NULL, quads, sizeof(quads));
+            int cellX = (glyph % TEXT_ATLAS_COLUMNS) * TEXT_CELL_WIDTH;
+            int cellY = (glyph / TEXT_ATLAS_COLUMNS) * TEXT_CELL_HEIGHT;
+            for (int q = 0; q < quadCount; q++) {
+                const float *v = &quads[q * 16];
+                int x0 = (int) v[0], y0 = (int) v[1];   // vértice 0: canto superior esquerdo
+                int x1 = (int) v[8], y1 = (int) v[9];   // vértice 2: canto inferior direito
+                for (int y = y0; y < y1 && y < TEXT_CELL_HEIGHT; y++) {
+                    for (int x = x0; x < x1 && x < TEXT_CELL_WIDTH; x++) {
+                        if (x >= 0 && y >= 0) {
+                            pixels[(cellY + y) * this->atlasWidth + cellX + x] = 255;
+                        }
+                    }
+                }
+            }
+        }
+
+        glGenTextures(1, &this->atlas);
+        glBindTexture(GL_TEXTURE_2D, this->atlas);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, this->atlasWidth, this->atlasHeight, 0, GL_RED,
+                     GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void layOut(const char *text, Layout &result) {
+        result.glyphs.clear();
+        result.width = 0.0f;
+        float x = 0.0f, y = 0.0f;
+        for (size_t i = 0; text[i] != '\0'; i++) {
+            unsigned char c = (unsigned char) text[i];
+            if (c == '\n') {
+                x = 0.0f;
+                y += TEXT_CELL_HEIGHT;
+                continue;
+            }
+            if (c < TEXT_FIRST_CHAR || c > TEXT_LAST_CHAR) {
+                c = '?'; // fora do atlas (inclui bytes de UTF-8)
+            }
+            GLushort glyph = (GLushort) (c - TEXT_FIRST_CHAR);
+            if (c != ' ') {
+                LayoutGlyph placed = {x, y, glyph};
+                result.glyphs.push_back(placed);
+            }
+            x += this->advance[glyph];
+            if (x > result.width) {
+                result.width = x;
+            }
+        }
+    }
+
+    const Layout &layout(const char *text) {
+        this->key.assign(text);
+        std::unordered_map<std::string, Layout>::iterator found = this->layouts.find(this->key);
+        if (found != this->layouts.end()) {
+            found->second.lastUsed = this->frame;
+            return found->second;
+        }
+        Layout &result = this->layouts[this->key];
+        result.lastUsed = this->frame;
+        layOut(text, result);
+        return result;
+    }
+
+    float append(const Layout &placed, float x, float y, float scale, float r, float g, float b, float a) {
+        GlyphInstance instance;
+        instance.scale = scale;
+        instance.color[0] = (GLubyte) (r * 255.0f + 0.5f);
+        instance.color[1] = (GLubyte) (g * 255.0f + 0.5f);
+        instance.color[2] = (GLubyte) (b * 255.0f + 0.5f);
+        instance.color[3] = (GLubyte) (a * 255.0f + 0.5f);
+        instance.padding = 0;
+        for (size_t i = 0; i < placed.glyphs.size(); i++) {
+            instance.x = x + placed.glyphs[i].dx * scale;
+            instance.y = y + placed.glyphs[i].dy * scale;
+            instance.glyph = placed.glyphs[i].glyph;
+            this->batch.push_back(instance);
+        }
+        return placed.width * scale;
+    }
+
+    void evictOldLayouts() {
+        std::unordered_map<std::string, Layout>::iterator it = this->layouts.begin();
+        while (it != this->layouts.end()) {
+            if (this->frame - it->second.lastUsed > TEXT_LAYOUT_MAX_AGE) {
+                it = this->layouts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+public:
+    TextRenderer() : atlas(0), program(0), viewportLocation(-1), vao(0), instanceVBO(0), instanceCapacity(0),
+                     atlasWidth(0), atlasHeight(0), frame(0) {
+        memset(this->advance, 0, sizeof(this->advance));
+        this->sentViewport[0] = this->sentViewport[1] = -1;
+    }
+
+    ~TextRenderer() {
+        glDeleteTextures(1, &this->atlas);
+        glDeleteBuffers(1, &this->instanceVBO);
+        glDeleteVertexArrays(1, &this->vao);
+        glDeleteProgram(this->program);
+    }
+
+    TextRenderer(const TextRenderer &) = delete;
+    TextRenderer &operator=(const TextRenderer &) = delete;
+
+    // precisa de um contexto OpenGL atual
+    bool init() {
+        createAtlas();
+
+        glGenVertexArrays(1, &this->vao);
+        glBindVertexArray(this->vao);
+        glGenBuffers(1, &this->instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (GLvoid *) offsetof(GlyphInstance, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribDivisor(0, 1);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GlyphInstance), (GLvoid *) offsetof(GlyphInstance, color));
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, sizeof(GlyphInstance), (GLvoid *) offsetof(GlyphInstance, glyph));
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+
+        return createProgram();
+    }
+
+    // Acrescenta `text` ao lote; (x, y) é o canto superior esquerdo. Retorna a
+    // largura em pixels da linha mais larga.
+    float draw(const char *text, float x, float y, float scale = 1.0f,
+               float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f) {
+        return append(layout(text), x, y, scale, r, g, b, a);
+    }
+
+    float draw(const std::string &text, float x, float y, float scale = 1.0f,
+               float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f) {
+        return draw(text.c_str(), x, y, scale, r, g, b, a);
+    }
+
+    // como draw(), sem passar pelo cache (texto que muda todo quadro)
+    float drawUncached(const char *text, float x, float y, float scale = 1.0f,
+                       float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f) {
+        layOut(text, this->scratch);
+        return append(this->scratch, x, y, scale, r, g, b, a);
+    }
+
+    // Desenha o lote inteiro com uma chamada e o esvazia. viewportWidth e
+    // viewportHeight são o tamanho em pixels do sistema de coordenadas do texto.
+    // Deixa o programa do texto em uso; o blending volta ao estado anterior.
+    void flush(int viewportWidth, int viewportHeight) {
+        this->frame++;
+        if (this->frame % TEXT_LAYOUT_MAX_AGE == 0) {
+            evictOldLayouts();
+        }
+        if (this->batch.empty()) {
+            return;
+        }
+
+        size_t bytes = this->batch.size() * sizeof(GlyphInstance);
+        bool changed = this->batch.size() != this->uploaded.size() ||
+                       memcmp(this->batch.data(), this->uploaded.data(), bytes) != 0;
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        if (this->batch.size() > this->instanceCapacity) {
+            this->instanceCapacity = this->batch.size() * 2;
+            glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(GlyphInstance), NULL, GL_DYNAMIC_DRAW);
+            changed = true;
+        }
+        if (changed) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, this->batch.data());
+            this->uploaded = this->batch;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        GLboolean blending = glIsEnabled(GL_BLEND);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glUseProgram(this->program);
+        if (viewportWidth != this->sentViewport[0] || viewportHeight != this->sentViewport[1]) {
+            glUniform2f(this->viewportLocation, (float) viewportWidth, (float) viewportHeight);
+            this->sentViewport[0] = viewportWidth;
+            this->sentViewport[1] = viewportHeight;
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, this->atlas);
+        glBindVertexArray(this->vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) this->batch.size());
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        if (!blending) {
+            glDisable(GL_BLEND);
+        }
+        this->batch.clear();
+    }
+
+    // largura em pixels (escala 1) da linha mais larga de `text`
+    float width(const char *text) {
+        return layout(text).width;
+    }
+
+    float width(const std::string &text) {
+        return width(text.c_str());
+    }
+
+    float widthUncached(const char *text) {
+        layOut(text, this->scratch);
+        return this->scratch.width;
+    }
+
+    size_t cachedLayouts() const {
+        return this->layouts.size();
+    }
+};
+
+#endif /* TextRenderer_h */
@@ -0,0 +1,113 @@
+#ifndef TileMapTexture_h
+#define TileMapTexture_h
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "TileMap.h"
+
+// Mapa isométrico desenhado pela GPU a partir dos ids dos tiles.
+//
+// Os ids vão para uma textura inteira GL_R8UI, 1 byte por tile, com o texel
+// (coluna, linha) = tile (coluna, linha) do TileMap. O cenário inteiro é um
+// único quad cobrindo o mapa: o fragment shader (trecho de glsl()) descobre em
+// qual losango o pixel cai, lê o id com texelFetch e amostra o tileset. O
+// custo de vértices não depende do tamanho do mapa, e editar um tile é um
+// glTexSubImage2D de um texel (setTile).
+//
+// Convenção do TrabalhoGB: o tile (linha i, coluna j) ocupa a caixa de
+// tileW x tileH com canto em origem + ((j - i) * tileW / 2, (i + j) * tileH / 2),
+// com o losango inscrito na caixa.
+
+class TileMapTexture {
+    GLuint texture;
+    int width, height;
+
+public:
+    TileMapTexture() : texture(0), width(0), height(0) {}
+
+    // (re)cria a textura com o mapa inteiro
+    void upload(TileMap &map) {
+        this->width = map.getWidth();
+        this->height = map.getHeight();
+        std::vector<unsigned char> ids((size_t) this->width * this->height);
+        for (int row = 0; row < this->height; row++) {
+            for (int col = 0; col < this->width; col++) {
+                ids[col + row * this->width] = (unsigned char) map.getTile(col, row);
+            }
+        }
+        if (this->texture == 0) {
+            glGenTextures(1, &this->texture);
+        }
+        glBindTexture(GL_TEXTURE_2D, this->texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, this->width, this->height, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                     ids.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        // texturas inteiras só ficam completas sem filtro nem mipmaps
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // muda o tile no TileMap (bitboards inclusive) e o texel correspondente.
+    // Ainda sem chamador: o mapa do TrabalhoGB não muda depois do upload.
+    void setTile(TileMap &map, int col, int row, unsigned char tile) {
+        map.setTile(col, row, tile);
+        glBindTexture(GL_TEXTURE_2D, this->texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, col, row, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, &tile);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void bind(GLenum unit) const {
+        glActiveTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, this->texture);
+    }
+
+    void release() {
+        glDeleteTextures(1, &this->texture);
+        this->texture = 0;
+    }
+
+    // bytes na GPU
+    size_t bytes() const {
+        return (size_t) this->width * this->height;
+    }
+
+    // Trecho GLSL para o fragment shader. isoTileAt recebe a posição na tela
+    // e devolve o tile (coluna, linha), o id dele e a posição dentro da caixa
+    // do tile, de (0, 0) a (1, 1), na mesma orientação das coordenadas de
+    // textura do tileset; false fora do mapa. Uniforms: tileIds (a textura),
+    // isoOrigin (vértice de cima do losango do tile (0, 0)) e isoTileSize
+    // (largura e altura do losango).
+    static std::string glsl() {
+        return R"(
+        uniform usampler2D tileIds;
+        uniform vec2 isoOrigin;
+        uniform vec2 isoTileSize;
+
+        bool isoTileAt(vec2 p, out ivec2 tile, out uint id, out vec2 local)
+        {
+            vec2 q = (p - isoOrigin) / (0.5 * isoTileSize);
+            vec2 f = 0.5 * vec2(q.y + q.x, q.y - q.x); // (coluna, linha) contínuos
+            tile = ivec2(floor(f));
+            id = 0u;
+            local = vec2(0.0);
+            if (any(lessThan(tile, ivec2(0))) || any(greaterThanEqual(tile, textureSize(tileIds, 0)))) {
+                return false;
+            }
+            vec2 d = f - vec2(tile);
+            local = 0.5 * vec2(d.x - d.y + 1.0, d.x + d.y);
+            id = texelFetch(tileIds, tile, 0).r;
+            return true;
+        }
+        )";
+    }
+};
+
+#endif /* TileMapTexture_h */
@@ -0,0 +1,205 @@
+#ifndef Trace_h
+#define Trace_h
+
+// Instrumentação leve de quadros no formato Chrome trace (abre em
+// chrome://tracing ou em ui.perfetto.dev).
+//
+//   TRACE_ZONE("nome");            zona do ponto até o fim do escopo
+//   TRACE_COUNTER("nome", valor);  amostra de um contador
+//   TRACE_FRAME();                 marca o início de um quadro
+//   TRACE_THREAD_NAME("nome");     nome da thread atual no trace
+//   TRACE_DUMP("arquivo.json");    grava o trace agora
+//
+// Só existe com PGCC_TRACE definido (opção PGCC_TRACE do CMake); sem ele as
+// macros viram nada e este header não inclui nem define coisa alguma.
+//
+// Cada thread escreve em um anel próprio de PGCC_TRACE_EVENTS eventos, sem
+// lock: um evento é gravado e só então o contador do anel avança. Quando o
+// anel enche, os eventos mais antigos são sobrescritos. Na saída do programa o
+// trace é gravado em $PGCC_TRACE_FILE (ou pgcc_trace.json no diretório atual).
+// Nomes precisam ser literais (ou durar até o fim do programa): só o ponteiro
+// é guardado.
+
+#if defined(PGCC_TRACE)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#ifndef PGCC_TRACE_EVENTS
+#define PGCC_TRACE_EVENTS (1 << 16)
+#endif
+
+#define TRACE_EVENT_ZONE 0
+#define TRACE_EVENT_COUNTER 1
+#define TRACE_EVENT_FRAME 2
+
+struct TraceEvent {
+    const char *name;
+    int64_t start;    // ns desde o início do trace
+    int64_t duration; // zonas
+    double value;     // contadores
+    int type;
+};
+
+struct TraceThread {
+    int id;
+    const char *name;
+    std::atomic<uint64_t> written; // eventos já gravados (o anel guarda os últimos)
+    TraceEvent events[PGCC_TRACE_EVENTS];
+};
+
+class Tracer {
+    std::mutex lock; // só para registrar threads e gravar o arquivo
+    std::vector<TraceThread *> threads;
+    std::chrono::steady_clock::time_point origin;
+
+    Tracer() : origin(std::chrono::steady_clock::now()) {
+        atexit(dumpAtExit);
+    }
+
+    static void dumpAtExit() {
+        const char *path = getenv("PGCC_TRACE_FILE");
+        get().dump(path != NULL ? path : "pgcc_trace.json");
+    }
+
+    // anel da thread atual, criado no primeiro evento; nunca é liberado, para
+    // continuar legível na gravação da saída
+    TraceThread *thread() {
+        static thread_local TraceThread *current = NULL;
+        if (current == NULL) {
+            current = new TraceThread();
+            current->name = NULL;
+            current->written.store(0);
+            std::lock_guard<std::mutex> guard(this->lock);
+            current->id = (int) this->threads.size();
+            this->threads.push_back(current);
+        }
+        return current;
+    }
+
+    static void writeName(FILE *file, const char *name) {
+        fputc('"', file);
+        for (const char *c = name; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') {
+                fputc('\\', file);
+            }
+            fputc(*c, file);
+        }
+        fputc('"', file);
+    }
+
+public:
+    // nunca destruído: os destrutores globais rodam antes do dumpAtExit
+    static Tracer &get() {
+        static Tracer *instance = new Tracer();
+        return *instance;
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->origin)
+            .count();
+    }
+
+    void emit(int type, const char *name, int64_t start, int64_t duration, double value) {
+        TraceThread *t = thread();
+        uint64_t n = t->written.load(std::memory_order_relaxed);
+        TraceEvent &event = t->events[n % PGCC_TRACE_EVENTS];
+        event.name = name;
+        event.start = start;
+        event.duration = duration;
+        event.value = value;
+        event.type = type;
+        t->written.store(n + 1, std::memory_order_release);
+    }
+
+    void counter(const char *name, double value) {
+        emit(TRACE_EVENT_COUNTER, name, now(), 0, value);
+    }
+
+    void frame() {
+        emit(TRACE_EVENT_FRAME, "frame", now(), 0, 0.0);
+    }
+
+    void nameThread(const char *name) {
+        thread()->name = name;
+    }
+
+    // Grava todos os anéis em JSON. Pode ser chamado a qualquer momento; um
+    // evento sendo escrito por outra thread durante a gravação pode sair
+    // truncado ou faltar.
+    bool dump(const char *path) {
+        std::lock_guard<std::mutex> guard(this->lock);
+        FILE *file = fopen(path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Não foi possível gravar o trace em %s\n", path);
+            return false;
+        }
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"pgcc\"}}");
+        for (size_t k = 0; k < this->threads.size(); k++) {
+            TraceThread *t = this->threads[k];
+            if (t->name != NULL) {
+                fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", t->id);
+                writeName(file, t->name);
+                fprintf(file, "}}");
+            }
+            uint64_t written = t->written.load(std::memory_order_acquire);
+            uint64_t first = written > PGCC_TRACE_EVENTS ? written - PGCC_TRACE_EVENTS : 0;
+            for (uint64_t i = first; i < written; i++) {
+                const TraceEvent &e = t->events[i % PGCC_TRACE_EVENTS];
+                fprintf(file, ",\n{\"name\":");
+                writeName(file, e.name);
+                fprintf(file, ",\"pid\":1,\"tid\":%d,\"ts\":%.3f", t->id, e.start / 1000.0);
+                if (e.type == TRACE_EVENT_ZONE) {
+                    fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f}", e.duration / 1000.0);
+                } else if (e.type == TRACE_EVENT_COUNTER) {
+                    fprintf(file, ",\"ph\":\"C\",\"args\":{\"value\":%.17g}}", e.value);
+                } else {
+                    fprintf(file, ",\"ph\":\"i\",\"s\":\"g\"}");
+                }
+            }
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+        return true;
+    }
+};
+
+// zona com o tempo do construtor ao destrutor
+class TraceZone {
+    const char *name;
+    int64_t start;
+
+public:
+    explicit TraceZone(const char *name) : name(name), start(Tracer::get().now()) {}
+
+    ~TraceZone() {
+        Tracer &tracer = Tracer::get();
+        tracer.emit(TRACE_EVENT_ZONE, this->name, this->start, tracer.now() - this->start, 0.0);
+    }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_COUNTER(name, value) Tracer::get().counter(name, (double) (value))
+#define TRACE_FRAME() Tracer::get().frame()
+#define TRACE_THREAD_NAME(name) Tracer::get().nameThread(name)
+#define TRACE_DUMP(path) Tracer::get().dump(path)
+
+#else
+
+#define TRACE_ZONE(name) ((void) 0)
+#define TRACE_COUNTER(name, value) ((void) 0)
+#define TRACE_FRAME() ((void) 0)
+#define TRACE_THREAD_NAME(name) ((void) 0)
+#define TRACE_DUMP(path) ((void) 0)
+
+#endif /* PGCC_TRACE */
+
+#endif /* Trace_h */
@@ -0,0 +1,212 @@
+#ifndef TriangleSet_h
+#define TriangleSet_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Teste ponto-em-triângulo em lote, para picking.
+//
+// Cada triângulo vira três funções de aresta E(p) = a * p.x + b * p.y + c,
+// orientadas para que o interior tenha as três >= 0 (a borda conta como
+// dentro). Os coeficientes ficam em SoA, então testar um ponto contra todos os
+// triângulos é um laço de multiplicações e um mínimo, 8 triângulos por vez com
+// AVX2 (PGCC_NATIVE_ARCH). pointsInside() faz o contrário: muitos pontos
+// (também SoA) contra um triângulo.
+//
+// Os índices são estáveis: remove() só desliga o triângulo, e set() pode
+// reaproveitar o índice depois. Triângulos degenerados nunca são atingidos.
+// Cada set() recebe um número de sequência, e pick() devolve o triângulo
+// gravado por último entre os atingidos, não o de maior índice: quem usa os
+// índices como anel (VivencialTriangulos) continua acertando depois de dar
+// a volta.
+
+class TriangleSet {
+    // coeficientes das arestas 0 (v0->v1), 1 (v1->v2) e 2 (v2->v0)
+    std::vector<float> a0, b0, c0, a1, b1, c1, a2, b2, c2;
+    // sequence[i]: ordem em que o índice i foi gravado por set() (0 = nunca)
+    std::vector<uint32_t> sequence;
+    uint32_t nextSequence;
+
+    struct Edges {
+        float a[3], b[3], c[3];
+    };
+
+    static Edges edges(float x0, float y0, float x1, float y1, float x2, float y2) {
+        Edges e;
+        float x[3] = {x0, x1, x2};
+        float y[3] = {y0, y1, y2};
+        float area2 = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+        // no sentido horário as três arestas trocam de sinal
+        float sign = area2 < 0.0f ? -1.0f : 1.0f;
+        for (int k = 0; k < 3; k++) {
+            int next = (k + 1) % 3;
+            float dx = x[next] - x[k], dy = y[next] - y[k];
+            e.a[k] = -dy * sign;
+            e.b[k] = dx * sign;
+            e.c[k] = (dy * x[k] - dx * y[k]) * sign;
+        }
+        if (area2 == 0.0f) {
+            for (int k = 0; k < 3; k++) {
+                e.a[k] = e.b[k] = 0.0f;
+                e.c[k] = -1.0f; // nenhum ponto passa
+            }
+        }
+        return e;
+    }
+
+    void store(int i, const Edges &e) {
+        this->a0[i] = e.a[0]; this->b0[i] = e.b[0]; this->c0[i] = e.c[0];
+        this->a1[i] = e.a[1]; this->b1[i] = e.b[1]; this->c1[i] = e.c[1];
+        this->a2[i] = e.a[2]; this->b2[i] = e.b[2]; this->c2[i] = e.c[2];
+    }
+
+    bool insideOne(int i, float px, float py) const {
+        return this->a0[i] * px + this->b0[i] * py + this->c0[i] >= 0.0f &&
+               this->a1[i] * px + this->b1[i] * py + this->c1[i] >= 0.0f &&
+               this->a2[i] * px + this->b2[i] * py + this->c2[i] >= 0.0f;
+    }
+
+#if defined(__AVX2__)
+    static __m256 madd(__m256 a, __m256 b, __m256 c) {
+#if defined(__FMA__)
+        return _mm256_fmadd_ps(a, b, c);
+#else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+    }
+
+    // bit k = triângulo first + k contém (px, py)
+    int mask8(int first, __m256 px, __m256 py) const {
+        __m256 e0 = madd(_mm256_loadu_ps(&this->a0[first]), px,
+                         madd(_mm256_loadu_ps(&this->b0[first]), py, _mm256_loadu_ps(&this->c0[first])));
+        __m256 e1 = madd(_mm256_loadu_ps(&this->a1[first]), px,
+                         madd(_mm256_loadu_ps(&this->b1[first]), py, _mm256_loadu_ps(&this->c1[first])));
+        __m256 e2 = madd(_mm256_loadu_ps(&this->a2[first]), px,
+                         madd(_mm256_loadu_ps(&this->b2[first]), py, _mm256_loadu_ps(&this->c2[first])));
+        __m256 lowest = _mm256_min_ps(e0, _mm256_min_ps(e1, e2));
+        return _mm256_movemask_ps(_mm256_cmp_ps(lowest, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+#endif
+
+public:
+    TriangleSet() : nextSequence(0) {}
+
+    int size() const {
+        return (int) this->a0.size();
+    }
+
+    // entradas novas ficam desligadas (c = -1: nenhum ponto passa)
+    void resize(int count) {
+        this->a0.resize(count, 0.0f); this->b0.resize(count, 0.0f); this->c0.resize(count, -1.0f);
+        this->a1.resize(count, 0.0f); this->b1.resize(count, 0.0f); this->c1.resize(count, -1.0f);
+        this->a2.resize(count, 0.0f); this->b2.resize(count, 0.0f); this->c2.resize(count, -1.0f);
+        this->sequence.resize(count, 0);
+    }
+
+    int add(float x0, float y0, float x1, float y1, float x2, float y2) {
+        int i = size();
+        resize(i + 1);
+        set(i, x0, y0, x1, y1, x2, y2);
+        return i;
+    }
+
+    void set(int i, float x0, float y0, float x1, float y1, float x2, float y2) {
+        store(i, edges(x0, y0, x1, y1, x2, y2));
+        this->sequence[i] = ++this->nextSequence;
+    }
+
+    void remove(int i) {
+        store(i, edges(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+    }
+
+    bool contains(int i, float px, float py) const {
+        return insideOne(i, px, py);
+    }
+
+    // o triângulo gravado por último (maior sequência) que contém o ponto, ou -1
+    int pick(float px, float py) const {
+        int n = size();
+        int best = -1;
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 vx = _mm256_set1_ps(px), vy = _mm256_set1_ps(py);
+        for (; i + 8 <= n; i += 8) {
+            for (int mask = mask8(i, vx, vy); mask != 0; mask &= mask - 1) {
+                int hit = i + __builtin_ctz((unsigned) mask);
+                if (best < 0 || this->sequence[hit] > this->sequence[best]) {
+                    best = hit;
+                }
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            if (insideOne(i, px, py) && (best < 0 || this->sequence[i] > this->sequence[best])) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // acrescenta a `out` todos os triângulos que contêm o ponto, em ordem crescente
+    int hits(float px, float py, std::vector<int> &out) const {
+        size_t before = out.size();
+        int n = size();
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 vx = _mm256_set1_ps(px), vy = _mm256_set1_ps(py);
+        for (; i + 8 <= n; i += 8) {
+            int mask = mask8(i, vx, vy);
+            for (; mask != 0; mask &= mask - 1) {
+                out.push_back(i + __builtin_ctz((unsigned) mask));
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            if (insideOne(i, px, py)) {
+                out.push_back(i);
+            }
+        }
+        return (int) (out.size() - before);
+    }
+
+    // inside[k] = 1 se (px[k], py[k]) está no triângulo; retorna quantos estão
+    static int pointsInside(const float *px, const float *py, int count,
+                            float x0, float y0, float x1, float y1, float x2, float y2, uint8_t *inside) {
+        Edges e = edges(x0, y0, x1, y1, x2, y2);
+        int total = 0;
+        int k = 0;
+#if defined(__AVX2__)
+        __m256 a[3], b[3], c[3];
+        for (int j = 0; j < 3; j++) {
+            a[j] = _mm256_set1_ps(e.a[j]);
+            b[j] = _mm256_set1_ps(e.b[j]);
+            c[j] = _mm256_set1_ps(e.c[j]);
+        }
+        for (; k + 8 <= count; k += 8) {
+            __m256 x = _mm256_loadu_ps(px + k), y = _mm256_loadu_ps(py + k);
+            __m256 lowest = madd(a[0], x, madd(b[0], y, c[0]));
+            lowest = _mm256_min_ps(lowest, madd(a[1], x, madd(b[1], y, c[1])));
+            lowest = _mm256_min_ps(lowest, madd(a[2], x, madd(b[2], y, c[2])));
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(lowest, _mm256_setzero_ps(), _CMP_GE_OQ));
+            for (int j = 0; j < 8; j++) {
+                inside[k + j] = (mask >> j) & 1;
+            }
+            total += __builtin_popcount((unsigned) mask);
+        }
+#endif
+        for (; k < count; k++) {
+            bool in = e.a[0] * px[k] + e.b[0] * py[k] + e.c[0] >= 0.0f &&
+                      e.a[1] * px[k] + e.b[1] * py[k] + e.c[1] >= 0.0f &&
+                      e.a[2] * px[k] + e.b[2] * py[k] + e.c[2] >= 0.0f;
+            inside[k] = in;
+            total += in;
+        }
+        return total;
+    }
+};
+
+#endif /* TriangleSet_h */
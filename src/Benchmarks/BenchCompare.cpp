@@ -0,0 +1,575 @@
+#include <ctype.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// pgcc_bench_compare: compara um resultado do pgcc_bench (--json) com uma
+// linha de base gravada na mesma máquina e falha quando algum benchmark ficou
+// mais lento do que a tolerância permite. É o teste perf_gate do CTest (ver
+// PGCC_PERF_GATE no CMakelists.txt).
+//
+// Uso: pgcc_bench_compare <base.json> <resultado.json> [tolerancias.json]
+//                            [-- pgcc_bench opções...]
+//
+// Com um comando depois de "--", o pgcc_bench é rodado antes (gravando em
+// resultado.json) e, enquanto algum benchmark passar do limite, a suíte é
+// rodada de novo, até RERUN_ATTEMPTS vezes, ficando o menor tempo de cada
+// benchmark: em uma máquina compartilhada um processo inteiro pode sair lento
+// (vizinhos, migração de CPU), e isso não derruba o teste; uma regressão real
+// sim.
+//
+// A comparação é pelo min_time (menor rodada, ns por iteração), que sofre
+// bem menos com interrupções do que a mediana. Quando os dois arquivos têm
+// calibration_time (ver BenchHarness.h) e a máquina está mais lenta agora do
+// que quando a base foi gravada, o tempo atual é dividido pela razão entre as
+// calibrações (coluna calib.). Mais tempo é menos vazão, então o mesmo
+// limite vale para carga, quadro e kernels. O arquivo de tolerâncias é um
+// objeto JSON de prefixo de nome -> fração aceita de piora; vale o prefixo
+// mais longo que casar e "default" para o resto:
+//
+//     {"default": 0.25, "scene/": 0.15, "filters/": 0.35}
+//
+// Base e resultado precisam vir da mesma configuração: build_type e
+// maths_simd_backend do "context" iguais. Uma build Debug ou com
+// PGCC_NATIVE_ARCH (AVX2) comparada com a base Release/sse2 falha com o
+// código 3 em vez de passar ou regredir por acaso. O número de CPUs não
+// entra: a suíte é de uma thread.
+//
+// Sem o arquivo da base não há o que comparar: sai com 77 (o CTest marca o
+// teste como pulado) e mostra como gravar uma, antes de rodar o pgcc_bench.
+//
+// Códigos de saída: 0 sem regressão, 1 regressão ou benchmark sumido,
+// 2 entrada inválida, 3 base de outra configuração, 77 sem base.
+
+using namespace std;
+
+const int EXIT_MISMATCH = 3;
+const int EXIT_NO_BASELINE = 77; // SKIP_RETURN_CODE do perf_gate
+const double DEFAULT_TOLERANCE = 0.25;
+const int RERUN_ATTEMPTS = 4; // novas rodadas da suíte antes de acusar regressão
+
+// JSON mínimo: o suficiente para os arquivos do pgcc_bench
+struct Json
+{
+    enum Type
+    {
+        NONE,
+        NUMBER,
+        TEXT,
+        ARRAY,
+        OBJECT
+    };
+    Type type;
+    double number;
+    string text;
+    vector<Json> items;
+    vector<pair<string, Json>> members;
+
+    Json() : type(NONE), number(0.0) {}
+
+    const Json *find(const string &key) const
+    {
+        for (size_t i = 0; i < this->members.size(); i++)
+        {
+            if (this->members[i].first == key)
+            {
+                return &this->members[i].second;
+            }
+        }
+        return NULL;
+    }
+};
+
+class JsonReader
+{
+    const string &text;
+    size_t at;
+
+    void skipSpace()
+    {
+        while (this->at < this->text.size() && isspace((unsigned char)this->text[this->at]))
+        {
+            this->at++;
+        }
+    }
+
+    bool accept(char c)
+    {
+        skipSpace();
+        if (this->at < this->text.size() && this->text[this->at] == c)
+        {
+            this->at++;
+            return true;
+        }
+        return false;
+    }
+
+    bool readString(string &out)
+    {
+        if (!accept('"'))
+        {
+            return false;
+        }
+        while (this->at < this->text.size() && this->text[this->at] != '"')
+        {
+            if (this->text[this->at] == '\\' && this->at + 1 < this->text.size())
+            {
+                this->at++;
+            }
+            out += this->text[this->at++];
+        }
+        return accept('"');
+    }
+
+public:
+    explicit JsonReader(const string &text) : text(text), at(0) {}
+
+    bool read(Json &value)
+    {
+        skipSpace();
+        if (this->at >= this->text.size())
+        {
+            return false;
+        }
+        char c = this->text[this->at];
+        if (c == '{')
+        {
+            value.type = Json::OBJECT;
+            this->at++;
+            if (accept('}'))
+            {
+                return true;
+            }
+            do
+            {
+                pair<string, Json> member;
+                if (!readString(member.first) || !accept(':') || !read(member.second))
+                {
+                    return false;
+                }
+                value.members.push_back(member);
+            } while (accept(','));
+            return accept('}');
+        }
+        if (c == '[')
+        {
+            value.type = Json::ARRAY;
+            this->at++;
+            if (accept(']'))
+            {
+                return true;
+            }
+            do
+            {
+                value.items.push_back(Json());
+                if (!read(value.items.back()))
+                {
+                    return false;
+                }
+            } while (accept(','));
+            return accept(']');
+        }
+        if (c == '"')
+        {
+            value.type = Json::TEXT;
+            return readString(value.text);
+        }
+        // número, true, false ou null: só números interessam
+        size_t start = this->at;
+        while (this->at < this->text.size() && (isalnum((unsigned char)this->text[this->at]) ||
+                                                strchr("+-.", this->text[this->at]) != NULL))
+        {
+            this->at++;
+        }
+        if (this->at == start)
+        {
+            return false;
+        }
+        value.type = Json::NUMBER;
+        value.number = atof(this->text.substr(start, this->at - start).c_str());
+        return true;
+    }
+
+    bool atEnd()
+    {
+        skipSpace();
+        return this->at == this->text.size();
+    }
+};
+
+bool loadJson(const char *path, Json &value)
+{
+    ifstream file(path);
+    if (!file.is_open())
+    {
+        cerr << "Não foi possível abrir " << path << endl;
+        return false;
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+    string text = buffer.str();
+    JsonReader reader(text);
+    if (!reader.read(value) || !reader.atEnd() || value.type != Json::OBJECT)
+    {
+        cerr << "JSON inválido em " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+string contextValue(const Json &results, const char *key)
+{
+    const Json *context = results.find("context");
+    const Json *value = context != NULL ? context->find(key) : NULL;
+    if (value != NULL && value->type == Json::NUMBER)
+    {
+        stringstream out;
+        out << value->number;
+        return out.str();
+    }
+    return value != NULL && value->type == Json::TEXT ? value->text : string();
+}
+
+struct BenchTime
+{
+    string name;
+    double time;        // min_time em ns
+    double calibration; // calibration_time em ns; 0 = arquivo sem calibração
+};
+
+bool readTimes(const Json &results, const char *path, vector<BenchTime> &times)
+{
+    const Json *benchmarks = results.find("benchmarks");
+    if (benchmarks == NULL || benchmarks->type != Json::ARRAY)
+    {
+        cerr << path << " não tem a lista \"benchmarks\"" << endl;
+        return false;
+    }
+    for (size_t i = 0; i < benchmarks->items.size(); i++)
+    {
+        const Json *name = benchmarks->items[i].find("name");
+        const Json *time = benchmarks->items[i].find("min_time");
+        const Json *calibration = benchmarks->items[i].find("calibration_time");
+        const Json *unit = benchmarks->items[i].find("time_unit");
+        if (name == NULL || time == NULL || time->type != Json::NUMBER)
+        {
+            cerr << path << ": benchmark " << i << " sem name/min_time" << endl;
+            return false;
+        }
+        if (unit != NULL && unit->text != "ns")
+        {
+            cerr << path << ": " << name->text << " não está em ns" << endl;
+            return false;
+        }
+        BenchTime entry;
+        entry.name = name->text;
+        entry.time = time->number;
+        entry.calibration =
+            calibration != NULL && calibration->type == Json::NUMBER && calibration->number > 0.0 ? calibration->number
+                                                                                                 : 0.0;
+        times.push_back(entry);
+    }
+    return true;
+}
+
+const BenchTime *findTime(const vector<BenchTime> &times, const string &name)
+{
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        if (times[i].name == name)
+        {
+            return &times[i];
+        }
+    }
+    return NULL;
+}
+
+// quanto a máquina estava mais lenta na medida atual do que quando a base foi
+// gravada. Só desconta lentidão: uma máquina que parece mais rápida não pode
+// esconder uma regressão.
+double speedFactor(const BenchTime &base, const BenchTime &current)
+{
+    if (base.calibration <= 0.0 || current.calibration <= base.calibration)
+    {
+        return 1.0;
+    }
+    return current.calibration / base.calibration;
+}
+
+// tempo atual na velocidade da máquina da base
+double normalized(const BenchTime &base, const BenchTime &current)
+{
+    return current.time / speedFactor(base, current);
+}
+
+double toleranceFor(const Json &tolerances, const string &name)
+{
+    double tolerance = DEFAULT_TOLERANCE;
+    size_t matched = 0;
+    for (size_t i = 0; i < tolerances.members.size(); i++)
+    {
+        const string &prefix = tolerances.members[i].first;
+        const Json &value = tolerances.members[i].second;
+        if (value.type != Json::NUMBER)
+        {
+            continue;
+        }
+        if (prefix == "default" && matched == 0)
+        {
+            tolerance = value.number;
+        }
+        else if (prefix.size() > matched && name.compare(0, prefix.size(), prefix) == 0)
+        {
+            tolerance = value.number;
+            matched = prefix.size();
+        }
+    }
+    return tolerance;
+}
+
+string percent(double fraction)
+{
+    stringstream out;
+    out << showpos << fixed << setprecision(1) << fraction * 100.0 << "%";
+    return out.str();
+}
+
+string shellQuote(const string &arg)
+{
+    string out = "\"";
+    for (size_t i = 0; i < arg.size(); i++)
+    {
+        if (arg[i] == '"' || arg[i] == '\\' || arg[i] == '$' || arg[i] == '`')
+        {
+            out += '\\';
+        }
+        out += arg[i];
+    }
+    return out + "\"";
+}
+
+// roda o comando do pgcc_bench com --json=path
+bool runBench(const vector<string> &command, const string &path)
+{
+    string line;
+    for (size_t i = 0; i < command.size(); i++)
+    {
+        line += shellQuote(command[i]) + " ";
+    }
+    line += shellQuote("--json=" + path);
+    // a tabela do pgcc_bench repetiria a da comparação; erros seguem no stderr
+#if defined(_WIN32)
+    line += " > NUL";
+#else
+    line += " > /dev/null";
+#endif
+    cout.flush();
+    if (system(line.c_str()) != 0)
+    {
+        cerr << "Falhou: " << line << endl;
+        return false;
+    }
+    return true;
+}
+
+bool regressed(const BenchTime &base, const BenchTime *measured, double tolerance)
+{
+    return measured != NULL && normalized(base, *measured) / base.time - 1.0 > tolerance;
+}
+
+// Roda a suíte de novo e fica, para cada benchmark, com a medida de menor
+// tempo corrigido. A suíte inteira, e não só o benchmark suspeito, para que
+// as novas medidas se espalhem no tempo: em máquinas compartilhadas os
+// períodos lentos duram dezenas de segundos.
+bool remeasure(const vector<string> &command, const string &resultPath, const vector<BenchTime> &baseTimes,
+               vector<BenchTime> &currentTimes)
+{
+    string path = resultPath + ".rerun";
+    Json rerun;
+    vector<BenchTime> times;
+    if (!runBench(command, path) || !loadJson(path.c_str(), rerun) || !readTimes(rerun, path.c_str(), times))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < currentTimes.size(); i++)
+    {
+        const BenchTime *base = findTime(baseTimes, currentTimes[i].name);
+        const BenchTime *again = findTime(times, currentTimes[i].name);
+        if (base != NULL && again != NULL && normalized(*base, *again) < normalized(*base, currentTimes[i]))
+        {
+            currentTimes[i] = *again;
+        }
+    }
+    return true;
+}
+
+void printUpdateHint(const vector<string> &command, const string &basePath)
+{
+    cout << "Para gravar uma nova base (nesta máquina, build Release):" << endl << " ";
+    for (size_t i = 0; i < command.size(); i++)
+    {
+        cout << " " << command[i];
+    }
+    cout << (command.empty() ? " pgcc_bench" : "") << " --json=" << basePath << endl;
+}
+
+int main(int argc, char **argv)
+{
+    // argumentos depois de "--": comando do pgcc_bench a rodar antes
+    vector<string> files, command;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "--")
+        {
+            command.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        files.push_back(argv[i]);
+    }
+    if (files.size() < 2 || files.size() > 3)
+    {
+        cerr << "Uso: " << argv[0] << " <base.json> <resultado.json> [tolerancias.json] [-- pgcc_bench opções...]"
+             << endl;
+        return 2;
+    }
+    const string &resultPath = files[1];
+    if (!ifstream(files[0].c_str()).is_open())
+    {
+        cout << "Sem base em " << files[0] << ": nada a comparar, teste pulado." << endl;
+        printUpdateHint(command, files[0]);
+        return EXIT_NO_BASELINE;
+    }
+    if (!command.empty() && !runBench(command, resultPath))
+    {
+        return 2;
+    }
+
+    Json baseline, current, tolerances;
+    if (!loadJson(files[0].c_str(), baseline) || !loadJson(resultPath.c_str(), current) ||
+        (files.size() == 3 && !loadJson(files[2].c_str(), tolerances)))
+    {
+        return 2;
+    }
+
+    // tempos de configurações diferentes não dizem nada sobre regressões
+    const char *keys[] = {"build_type", "maths_simd_backend"};
+    bool mismatch = false;
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+    {
+        string before = contextValue(baseline, keys[i]);
+        string after = contextValue(current, keys[i]);
+        if (before != after)
+        {
+            cout << "Configuração diferente da base: " << keys[i] << " = " << (after.empty() ? "?" : after)
+                 << ", base = " << (before.empty() ? "?" : before) << endl;
+            mismatch = true;
+        }
+    }
+    if (mismatch)
+    {
+        string baseBuild = contextValue(baseline, "build_type");
+        if (contextValue(current, "build_type") != baseBuild)
+        {
+            // "release" -> -DCMAKE_BUILD_TYPE=Release
+            if (!baseBuild.empty())
+            {
+                baseBuild[0] = (char)toupper((unsigned char)baseBuild[0]);
+            }
+            cout << "Configure a build com -DCMAKE_BUILD_TYPE=" << baseBuild << "." << endl;
+        }
+        else
+        {
+            printUpdateHint(command, files[0]);
+        }
+        return EXIT_MISMATCH;
+    }
+
+    vector<BenchTime> baseTimes, currentTimes;
+    if (!readTimes(baseline, files[0].c_str(), baseTimes) || !readTimes(current, resultPath.c_str(), currentTimes))
+    {
+        return 2;
+    }
+
+    int reruns = 0;
+    while (!command.empty() && reruns < RERUN_ATTEMPTS)
+    {
+        bool suspect = false;
+        for (size_t i = 0; i < baseTimes.size(); i++)
+        {
+            suspect = suspect || regressed(baseTimes[i], findTime(currentTimes, baseTimes[i].name),
+                                           toleranceFor(tolerances, baseTimes[i].name));
+        }
+        if (!suspect || !remeasure(command, resultPath, baseTimes, currentTimes))
+        {
+            break;
+        }
+        reruns++;
+    }
+
+    cout << left << setw(44) << "benchmark" << right << setw(14) << "base (ns)" << setw(14) << "atual (ns)"
+         << setw(8) << "calib." << setw(10) << "var." << setw(9) << "limite" << endl;
+    vector<string> failures;
+    for (size_t i = 0; i < baseTimes.size(); i++)
+    {
+        const BenchTime &base = baseTimes[i];
+        const string &name = base.name;
+        double before = base.time;
+        double tolerance = toleranceFor(tolerances, name);
+        const BenchTime *found = findTime(currentTimes, name);
+        if (found == NULL)
+        {
+            cout << left << setw(44) << name << right << setw(14) << setprecision(5) << before << setw(14) << "-"
+                 << "  SUMIU" << endl;
+            failures.push_back(name + " não está no resultado");
+            continue;
+        }
+        const BenchTime &measured = *found;
+        double after = normalized(base, measured);
+        double change = after / before - 1.0;
+        cout << left << setw(44) << name << right << setw(14) << setprecision(5) << before << setw(14) << after
+             << setw(8) << fixed << setprecision(2) << speedFactor(base, measured) << defaultfloat << setw(10)
+             << percent(change) << setw(9) << percent(tolerance);
+        if (change > tolerance)
+        {
+            cout << "  REGREDIU";
+            failures.push_back(name + ": " + percent(change) + " (limite " + percent(tolerance) + ")");
+        }
+        else if (change < -tolerance)
+        {
+            cout << "  melhorou";
+        }
+        cout << endl;
+    }
+    for (size_t i = 0; i < currentTimes.size(); i++)
+    {
+        if (findTime(baseTimes, currentTimes[i].name) == NULL)
+        {
+            cout << left << setw(44) << currentTimes[i].name << right << setw(14) << "-" << setw(14)
+                 << setprecision(5) << currentTimes[i].time << "  novo (fora da base)" << endl;
+        }
+    }
+
+    if (reruns > 0)
+    {
+        cout << endl << "Suíte medida " << reruns + 1 << " vezes; vale o menor tempo de cada benchmark" << endl;
+    }
+    if (!failures.empty())
+    {
+        cout << endl << failures.size() << " regressão(ões) de desempenho:" << endl;
+        for (size_t i = 0; i < failures.size(); i++)
+        {
+            cout << "  " << failures[i] << endl;
+        }
+        cout << "Se a mudança é esperada, atualize a base. ";
+        printUpdateHint(command, files[0]);
+        return 1;
+    }
+    cout << endl << "Sem regressões em " << baseTimes.size() << " benchmarks" << endl;
+    return 0;
+}
@@ -0,0 +1,278 @@
+#ifndef BenchHarness_h
+#define BenchHarness_h
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Harness mínimo de micro-benchmarks do pgcc_bench, sem dependências.
+//
+// Um benchmark é um corpo `void body(long iterations)` que roda o kernel
+// `iterations` vezes; a preparação fica fora do corpo, então não entra na
+// medida. O harness dobra as iterações até uma rodada levar --min-time
+// segundos, repete essa rodada --repetitions vezes e guarda a mediana e o
+// mínimo em ns por iteração. `items` é quanto uma iteração processa (pixels,
+// tiles, matrizes...) e vira a vazão em itens por segundo.
+//
+// Depois de cada rodada o harness mede também um laço escalar fixo
+// (calibrate) e guarda o menor tempo dele como calibration_time do
+// benchmark. Quando a máquina inteira fica mais lenta por um tempo (outra
+// carga, frequência da CPU), o laço fica mais lento junto; o
+// pgcc_bench_compare usa a razão para comparar resultados medidos em
+// momentos diferentes.
+//
+// Opções:
+//   --filter=<trecho>    só os benchmarks cujo nome contém o trecho
+//   --min-time=<s>       duração mínima de cada rodada (padrão 0.1)
+//   --repetitions=<n>    rodadas medidas por benchmark (padrão 5)
+//   --json=<arquivo>     resultados em JSON ("-" = saída padrão)
+//
+// O JSON segue os nomes de campo do Google Benchmark (name, iterations,
+// real_time, time_unit, items_per_second) para servir às mesmas ferramentas
+// de comparação; min_time e calibration_time são extras.
+
+struct BenchResult
+{
+    std::string name;
+    long iterations;
+    int repetitions;
+    double medianNs; // por iteração
+    double minNs;
+    double calibrationNs; // menor tempo do laço de calibração, por iteração
+    double items;         // por iteração
+};
+
+// impede que o compilador descarte um resultado que ninguém lê
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+const double BENCH_CALIBRATION_SECONDS = 0.002; // duração de uma medida do laço de calibração
+
+class BenchRunner
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::string filter;
+    double minSeconds;
+    int repetitions;
+    std::string jsonPath;
+    std::vector<std::pair<std::string, std::string>> context;
+    std::vector<BenchResult> results;
+    long calibrationIterations;
+
+    static std::string option(const std::string &arg, const char *name)
+    {
+        std::string prefix = std::string("--") + name + "=";
+        return arg.compare(0, prefix.size(), prefix) == 0 ? arg.substr(prefix.size()) : std::string();
+    }
+
+    static std::string quote(const std::string &text)
+    {
+        std::string out = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    template <typename Body>
+    static double secondsFor(Body &body, long iterations)
+    {
+        Clock::time_point start = Clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // laço de referência: cadeia de dependências escalar, sem memória, que o
+    // compilador não consegue vetorizar nem resolver em forma fechada
+    static void calibrate(long iterations)
+    {
+        unsigned int x = 1;
+        for (long i = 0; i < iterations; i++)
+        {
+            x = x * 1664525u + 1013904223u;
+            x ^= x >> 13;
+        }
+        doNotOptimize(x);
+    }
+
+    // a tabela vai para stderr quando o JSON ocupa a saída padrão
+    std::ostream &console() const
+    {
+        return this->jsonPath == "-" ? std::cerr : std::cout;
+    }
+
+    void writeJson(std::ostream &out) const
+    {
+        out << "{\n  \"context\": {\n";
+        for (size_t i = 0; i < this->context.size(); i++)
+        {
+            out << "    " << quote(this->context[i].first) << ": " << quote(this->context[i].second) << ",\n";
+        }
+        out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n  },\n";
+        out << "  \"benchmarks\": [\n";
+        out << std::setprecision(6);
+        for (size_t i = 0; i < this->results.size(); i++)
+        {
+            const BenchResult &r = this->results[i];
+            out << "    {\"name\": " << quote(r.name) << ", \"iterations\": " << r.iterations
+                << ", \"repetitions\": " << r.repetitions << ", \"real_time\": " << r.medianNs
+                << ", \"min_time\": " << r.minNs << ", \"calibration_time\": " << r.calibrationNs
+                << ", \"time_unit\": \"ns\", \"items_per_second\": " << r.items * 1e9 / r.medianNs << "}"
+                << (i + 1 < this->results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+public:
+    BenchRunner(int argc, char **argv) : minSeconds(0.1), repetitions(5), calibrationIterations(0)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            std::string value;
+            if (!(value = option(arg, "filter")).empty())
+            {
+                this->filter = value;
+            }
+            else if (!(value = option(arg, "min-time")).empty())
+            {
+                this->minSeconds = atof(value.c_str());
+            }
+            else if (!(value = option(arg, "repetitions")).empty())
+            {
+                this->repetitions = atoi(value.c_str());
+            }
+            else if (!(value = option(arg, "json")).empty())
+            {
+                this->jsonPath = value;
+            }
+            else
+            {
+                std::cerr << "Opção desconhecida: " << arg << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (this->minSeconds <= 0.0 || this->repetitions <= 0)
+        {
+            std::cerr << "--min-time e --repetitions precisam ser positivos" << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        char date[32];
+        time_t now = time(NULL);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+        addContext("date", date);
+#ifdef NDEBUG
+        addContext("build_type", "release");
+#else
+        addContext("build_type", "debug");
+#endif
+    }
+
+    void addContext(const std::string &key, const std::string &value)
+    {
+        this->context.push_back(std::make_pair(key, value));
+    }
+
+    template <typename Body>
+    void run(const std::string &name, double items, Body body)
+    {
+        if (name.find(this->filter) == std::string::npos)
+        {
+            return;
+        }
+
+        // aquece e calibra: dobra até a rodada durar o mínimo
+        long iterations = 1;
+        while (secondsFor(body, iterations) < this->minSeconds && iterations < (1L << 30))
+        {
+            iterations *= 2;
+        }
+
+        if (this->calibrationIterations == 0)
+        {
+            this->calibrationIterations = 1024;
+            while (secondsFor(calibrate, this->calibrationIterations) < BENCH_CALIBRATION_SECONDS)
+            {
+                this->calibrationIterations *= 2;
+            }
+        }
+
+        // cada rodada seguida de uma medida do laço de calibração, para que os
+        // dois vejam a máquina no mesmo estado
+        std::vector<double> samples, reference;
+        for (int k = 0; k < this->repetitions; k++)
+        {
+            samples.push_back(secondsFor(body, iterations) * 1e9 / iterations);
+            reference.push_back(secondsFor(calibrate, this->calibrationIterations) * 1e9 /
+                                this->calibrationIterations);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.repetitions = this->repetitions;
+        result.medianNs = samples[samples.size() / 2];
+        result.minNs = samples[0];
+        result.calibrationNs = *std::min_element(reference.begin(), reference.end());
+        result.items = items;
+        this->results.push_back(result);
+
+        console() << std::left << std::setw(40) << name << std::right << std::setw(14) << std::setprecision(5)
+                  << result.medianNs << " ns  " << std::setw(12) << items * 1e3 / result.medianNs
+                  << " Mitens/s" << std::endl;
+    }
+
+    // grava o JSON, se pedido; retorna o código de saída do programa
+    int finish() const
+    {
+        if (this->jsonPath.empty())
+        {
+            return EXIT_SUCCESS;
+        }
+        if (this->jsonPath == "-")
+        {
+            writeJson(std::cout);
+            return EXIT_SUCCESS;
+        }
+        std::ofstream file(this->jsonPath);
+        if (!file.is_open())
+        {
+            std::cerr << "Não foi possível gravar " << this->jsonPath << std::endl;
+            return EXIT_FAILURE;
+        }
+        writeJson(file);
+        console() << "Resultados gravados em " << this->jsonPath << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const std::vector<BenchResult> &getResults() const
+    {
+        return this->results;
+    }
+};
+
+#endif /* BenchHarness_h */
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include "JobSystem.h"
+
+// Micro-benchmark do JobSystem: mede o custo de agendamento por tarefa.
+//
+//  - run+wait: N tarefas vazias agendadas uma a uma e esperadas por um contador
+//  - parallelFor grão 1: N tarefas geradas pela divisão recursiva do intervalo
+//  - dependências: cadeia de tarefas, cada uma liberada pela anterior
+//
+// Uso: JobSystemBench [tarefas] [threads extras]
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+void emptyJob(void *, int, int)
+{
+}
+
+double nanosPerJob(Clock::time_point start, int jobCount)
+{
+    return chrono::duration<double, nano>(Clock::now() - start).count() / jobCount;
+}
+
+int main(int argc, char **argv)
+{
+    int jobCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    int workers = argc > 2 ? atoi(argv[2]) : 0;
+    if (jobCount <= 0)
+    {
+        cerr << "Número de tarefas inválido: " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    JobSystem jobs(workers);
+    cout << "threads: " << jobs.workerCount() << ", tarefas: " << jobCount << endl;
+
+    // aquece as threads e as filas
+    jobs.parallelFor(0, jobCount, 1, [](int, int) {});
+
+    Clock::time_point start = Clock::now();
+    JobCounter counter;
+    for (int i = 0; i < jobCount; i++)
+    {
+        jobs.run(emptyJob, NULL, i, i + 1, &counter);
+    }
+    jobs.wait(counter);
+    cout << "run + wait:          " << nanosPerJob(start, jobCount) << " ns/tarefa" << endl;
+
+    start = Clock::now();
+    jobs.parallelFor(0, jobCount, 1, [](int, int) {});
+    cout << "parallelFor grão 1:  " << nanosPerJob(start, jobCount) << " ns/tarefa" << endl;
+
+    int chainLength = jobCount < 100000 ? jobCount : 100000;
+    vector<JobCounter> counters(chainLength);
+    start = Clock::now();
+    for (int i = 0; i < chainLength; i++)
+    {
+        jobs.run(emptyJob, NULL, i, i + 1, &counters[i], i > 0 ? &counters[i - 1] : NULL);
+    }
+    jobs.wait(counters[chainLength - 1]);
+    cout << "cadeia dependente:   " << nanosPerJob(start, chainLength) << " ns/tarefa" << endl;
+
+    return EXIT_SUCCESS;
+}
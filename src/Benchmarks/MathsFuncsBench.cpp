@@ -0,0 +1,159 @@
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "maths_funcs.h"
+
+// Micro-benchmark das matrizes de common/M5-6/maths_funcs: cada operação roda
+// no caminho escalar (*_scalar), no backend SIMD (operadores, inverse e
+// transpose) e na GLM, sobre as mesmas matrizes.
+//
+// Uso: MathsFuncsBench [operações]
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+const int MATRIX_COUNT = 1024; // cabe no L1/L2: mede as contas, não a memória
+
+double nanosPerOp(Clock::time_point start, int opCount)
+{
+    return chrono::duration<double, nano>(Clock::now() - start).count() / opCount;
+}
+
+// impede que o compilador descarte os resultados
+float sink = 0.0f;
+
+void report(const char *name, double scalar, double simd, double glmTime)
+{
+    cout << name << "  escalar " << scalar << " ns, " << maths_simd_backend() << " " << simd << " ns, glm "
+         << glmTime << " ns  (" << scalar / simd << "x)" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    int opCount = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (opCount <= 0)
+    {
+        cerr << "Número de operações inválido: " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    vector<mat4> mats(MATRIX_COUNT);
+    vector<glm::mat4> glmMats(MATRIX_COUNT);
+    vector<vec4> vecs(MATRIX_COUNT);
+    vector<glm::vec4> glmVecs(MATRIX_COUNT);
+    srand(1);
+    for (int i = 0; i < MATRIX_COUNT; i++)
+    {
+        for (int k = 0; k < 16; k++)
+        {
+            // diagonal dominante: todas invertíveis
+            mats[i].m[k] = (rand() / (float)RAND_MAX - 0.5f) + (k % 5 == 0 ? 4.0f : 0.0f);
+            glmMats[i][k / 4][k % 4] = mats[i].m[k];
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            vecs[i].v[k] = rand() / (float)RAND_MAX;
+            glmVecs[i][k] = vecs[i].v[k];
+        }
+    }
+    cout << "backend: " << maths_simd_backend() << ", operações: " << opCount << endl;
+
+    // mat4 * mat4: encadeia para o resultado depender da iteração anterior
+    mat4 acc = identity_mat4();
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        acc = mul_scalar(mats[i % MATRIX_COUNT], mats[(i + 1) % MATRIX_COUNT]);
+        sink += acc.m[i & 15];
+    }
+    double scalar = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        acc = mats[i % MATRIX_COUNT] * mats[(i + 1) % MATRIX_COUNT];
+        sink += acc.m[i & 15];
+    }
+    double simd = nanosPerOp(start, opCount);
+    glm::mat4 glmAcc(1.0f);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        glmAcc = glmMats[i % MATRIX_COUNT] * glmMats[(i + 1) % MATRIX_COUNT];
+        sink += glmAcc[(i >> 2) & 3][i & 3];
+    }
+    report("mat4 * mat4", scalar, simd, nanosPerOp(start, opCount));
+
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        vec4 v = mul_scalar(mats[i % MATRIX_COUNT], vecs[(i + 7) % MATRIX_COUNT]);
+        sink += v.v[i & 3];
+    }
+    scalar = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        vec4 v = mats[i % MATRIX_COUNT] * vecs[(i + 7) % MATRIX_COUNT];
+        sink += v.v[i & 3];
+    }
+    simd = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        glm::vec4 v = glmMats[i % MATRIX_COUNT] * glmVecs[(i + 7) % MATRIX_COUNT];
+        sink += v[i & 3];
+    }
+    report("mat4 * vec4", scalar, simd, nanosPerOp(start, opCount));
+
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        acc = inverse_scalar(mats[i % MATRIX_COUNT]);
+        sink += acc.m[i & 15];
+    }
+    scalar = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        acc = inverse(mats[i % MATRIX_COUNT]);
+        sink += acc.m[i & 15];
+    }
+    simd = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        glmAcc = glm::inverse(glmMats[i % MATRIX_COUNT]);
+        sink += glmAcc[(i >> 2) & 3][i & 3];
+    }
+    report("inverse    ", scalar, simd, nanosPerOp(start, opCount));
+
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        acc = transpose_scalar(mats[i % MATRIX_COUNT]);
+        sink += acc.m[i & 15];
+    }
+    scalar = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        acc = transpose(mats[i % MATRIX_COUNT]);
+        sink += acc.m[i & 15];
+    }
+    simd = nanosPerOp(start, opCount);
+    start = Clock::now();
+    for (int i = 0; i < opCount; i++)
+    {
+        glmAcc = glm::transpose(glmMats[i % MATRIX_COUNT]);
+        sink += glmAcc[(i >> 2) & 3][i & 3];
+    }
+    report("transpose  ", scalar, simd, nanosPerOp(start, opCount));
+
+    cout << "(soma de controle " << sink << ")" << endl;
+    return EXIT_SUCCESS;
+}
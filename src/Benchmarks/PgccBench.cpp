@@ -0,0 +1,402 @@
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "BenchHarness.h"
+
+#include "ColorSimilarity.h"
+#include "Entities.h"
+#include "FrameArena.h"
+#include "ImageFilters.h"
+#include "MapParser.h"
+#include "SlideView.h"
+#include "ltMath.h"
+#include "maths_funcs.h"
+
+// pgcc_bench: micro-benchmarks dos kernels quentes do repositório, sempre
+// chamando o mesmo código que os programas usam.
+//
+//  - map/*      leitura dos mapas do TrabalhoGB (MapParser.h)
+//  - iso/*      posições isométricas: instâncias das entidades e SlideView
+//  - colors/*   eliminação de cores do JogoDasCores (ColorSimilarity.h)
+//  - filters/*  filtros do exemplo_03 em uma thread (ImageFilters.h)
+//  - ltmath/*   triangleCollidePoint2D
+//  - maths/*    matrizes de maths_funcs, backend SIMD e escalar
+//  - scene/*    cena do TrabalhoGB sem janela: carga (mapa, objetivos,
+//               entidades) e a CPU de um quadro (passo, colisão, instâncias)
+//
+// Uso: pgcc_bench [--filter=...] [--min-time=s] [--repetitions=n] [--json=arquivo]
+// (ver BenchHarness.h). Os dados são gerados com semente fixa.
+
+using namespace std;
+
+float random01()
+{
+    return rand() / (float)RAND_MAX;
+}
+
+// texto no formato de assets/maps: cabeçalho e ids 0..6 do tilesetIso
+string makeMapText(int width, int height)
+{
+    string text = to_string(width) + " " + to_string(height) + "\n";
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            text += to_string(rand() % 7);
+            text += j + 1 < width ? " " : "\n";
+        }
+    }
+    return text;
+}
+
+void mapBenchmarks(BenchRunner &bench)
+{
+    string line = "3 1 5 0 2 4 5 5 1 0 3 2 4 4 1";
+    bench.run("map/extrairValores", 15, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            vector<int> values = extrairValores(line);
+            doNotOptimize(values.data());
+        }
+    });
+
+    int sizes[] = {15, 256};
+    for (int s = 0; s < 2; s++)
+    {
+        string text = makeMapText(sizes[s], sizes[s]);
+        bench.run("map/parseMap/" + to_string(sizes[s]), sizes[s] * sizes[s], [&](long n) {
+            for (long k = 0; k < n; k++)
+            {
+                int width, height;
+                TileMap *map = parseMap(text, width, height);
+                doNotOptimize(map);
+                delete map;
+            }
+        });
+    }
+
+    string objectivesText;
+    for (int i = 0; i < 64; i++)
+    {
+        objectivesText += to_string(rand() % 15) + " " + to_string(rand() % 15) + "\n";
+    }
+    bench.run("map/parseObjectives", 64, [&](long n) {
+        vector<pair<int, int>> objectives;
+        for (long k = 0; k < n; k++)
+        {
+            objectives.clear();
+            parseObjectives(objectivesText, objectives);
+            doNotOptimize(objectives.data());
+        }
+    });
+}
+
+void isoBenchmarks(BenchRunner &bench)
+{
+    const int entityCount = 64 * 1024;
+    EntityStore entities;
+    entities.reserve(entityCount);
+    for (int i = 0; i < entityCount; i++)
+    {
+        entities.create(rand() % 256, rand() % 256, 0, 0.0f);
+    }
+    vector<EntityInstance> instances(entityCount);
+    bench.run("iso/buildEntityInstances", entityCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            buildEntityInstances(entities, 53.0f, 26.5f, 373.5f, 100.0f, 0, entityCount, instances.data());
+            doNotOptimize(instances.data());
+        }
+    });
+
+    // chamada virtual por tile, como nos exemplos do M6
+    const int gridSize = 256;
+    SlideView slide;
+    TilemapView *view = &slide;
+    vector<float> x(gridSize * gridSize), y(gridSize * gridSize);
+    bench.run("iso/SlideView/computeDrawPosition", gridSize * gridSize, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int row = 0; row < gridSize; row++)
+            {
+                for (int col = 0; col < gridSize; col++)
+                {
+                    view->computeDrawPosition(col, row, 64.0f, 32.0f, x[row * gridSize + col], y[row * gridSize + col]);
+                }
+            }
+            doNotOptimize(x.data());
+        }
+    });
+}
+
+void colorBenchmarks(BenchRunner &bench)
+{
+    // tolerância 0: nada é eliminado, então toda iteração varre o mesmo tanto
+    int sizes[] = {48, 4096, 1024 * 1024};
+    for (int s = 0; s < 3; s++)
+    {
+        int count = sizes[s];
+        ColorSimilarity colors;
+        colors.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            colors.setColor(i, random01(), random01(), random01());
+        }
+        vector<int> out;
+        bench.run("colors/eliminateSimilar/scan/" + to_string(count), count, [&](long n) {
+            for (long k = 0; k < n; k++)
+            {
+                out.clear();
+                doNotOptimize(colors.eliminateSimilar(k % count, 0.0f, out));
+            }
+        });
+    }
+
+    // índice por buckets com a tolerância do jogo: depois da primeira
+    // iteração a vizinhança já foi eliminada e só sobra a visita aos buckets
+    const int count = 1024 * 1024;
+    ColorSimilarity colors;
+    colors.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        colors.setColor(i, random01(), random01(), random01());
+    }
+    colors.buildIndex(16);
+    vector<int> out;
+    bench.run("colors/eliminateSimilar/index/" + to_string(count), 1, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            out.clear();
+            doNotOptimize(colors.eliminateSimilar(0, 0.2f, out));
+        }
+    });
+}
+
+// Cena no formato do TrabalhoGB, em uma thread e sem OpenGL, com muitas
+// entidades para o custo por quadro ser medível: scene/load é a carga (o que
+// o jogo faz antes do primeiro quadro) e scene/frame um quadro de CPU.
+void sceneBenchmarks(BenchRunner &bench)
+{
+    const int mapSize = 256;
+    const int entityCount = 64 * 1024;
+    string mapText = makeMapText(mapSize, mapSize);
+    string objectivesText;
+    for (int i = 0; i < 64; i++)
+    {
+        objectivesText += to_string(rand() % mapSize) + " " + to_string(rand() % mapSize) + "\n";
+    }
+
+    bench.run("scene/load", entityCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            int width, height;
+            TileMap *map = parseMap(mapText, width, height);
+            map->setTileFlags(5, TILE_BLOCKED); // água
+            map->setTileFlags(3, TILE_HAZARD);  // lava
+            vector<pair<int, int>> objectives;
+            parseObjectives(objectivesText, objectives);
+            EntityStore entities;
+            entities.reserve(entityCount);
+            for (int i = 0; i < entityCount; i++)
+            {
+                entities.create(i % width, (i / width) % height, 0, 0.0f);
+            }
+            doNotOptimize(entities.col.data());
+            doNotOptimize(objectives.data());
+            delete map;
+        }
+    });
+
+    int width, height;
+    TileMap *map = parseMap(mapText, width, height);
+    map->setTileFlags(5, TILE_BLOCKED);
+    map->setTileFlags(3, TILE_HAZARD);
+    EntityStore entities;
+    entities.reserve(entityCount);
+    for (int i = 0; i < entityCount; i++)
+    {
+        entities.create(rand() % width, rand() % height, 0, 0.0f);
+    }
+    vector<int32_t> steps(entityCount);
+    for (int i = 0; i < entityCount; i++)
+    {
+        steps[i] = rand() % 3 - 1;
+    }
+    FrameArena arena;
+    bench.run("scene/frame", entityCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            arena.reset();
+            for (int i = 0; i < entityCount; i++)
+            {
+                entities.moveCol[i] = steps[i];
+                entities.moveRow[i] = steps[(i + k) % entityCount];
+            }
+            moveEntities(entities, *map, 0, entityCount);
+            collideEntities(entities, *map, 0, entityCount);
+            EntityInstance *out = arena.allocate<EntityInstance>(entityCount);
+            buildEntityInstances(entities, 53.0f, 26.5f, 373.5f, 100.0f, 0, entityCount, out);
+            doNotOptimize(out);
+        }
+    });
+    delete map;
+}
+
+void filterBenchmarks(BenchRunner &bench)
+{
+    const int width = 1024, height = 768;
+    const int pixels = width * height;
+    vector<unsigned char> work(pixels * 3);
+    for (size_t i = 0; i < work.size(); i++)
+    {
+        work[i] = (unsigned char)(rand() & 0xff);
+    }
+
+    // o chroma-key só apaga na primeira passada (os pixels pretos ficam fora
+    // da tolerância), depois o trabalho por iteração é sempre o mesmo
+    bench.run("filters/chromaKey", pixels, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            chromaKeyPixels(work.data(), 0, pixels, 0, 255, 0, 0.3);
+            doNotOptimize(work.data());
+        }
+    });
+    bench.run("filters/grayScale", pixels, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            grayScalePixels(work.data(), 0, pixels, 0.2125, 0.7154, 0.0721);
+            doNotOptimize(work.data());
+        }
+    });
+    bench.run("filters/colorize", pixels, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            colorizePixels(work.data(), 0, pixels, 40, 0, 80);
+            doNotOptimize(work.data());
+        }
+    });
+    bench.run("filters/negative", pixels, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            negativePixels(work.data(), 0, pixels);
+            doNotOptimize(work.data());
+        }
+    });
+}
+
+void ltMathBenchmarks(BenchRunner &bench)
+{
+    const int pointCount = 4096;
+    float triangle[6] = {100.0f, 100.0f, 500.0f, 150.0f, 250.0f, 450.0f};
+    vector<float> points(pointCount * 2);
+    for (int i = 0; i < pointCount * 2; i++)
+    {
+        points[i] = random01() * 600.0f;
+    }
+    bench.run("ltmath/triangleCollidePoint2D", pointCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            int inside = 0;
+            for (int i = 0; i < pointCount; i++)
+            {
+                inside += triangleCollidePoint2D(triangle, &points[i * 2]);
+            }
+            doNotOptimize(inside);
+        }
+    });
+}
+
+void mathsBenchmarks(BenchRunner &bench)
+{
+    const int matrixCount = 1024; // cabe no L1/L2: mede as contas, não a memória
+    vector<mat4> mats(matrixCount), out(matrixCount);
+    vector<vec4> vecs(matrixCount), outVecs(matrixCount);
+    for (int i = 0; i < matrixCount; i++)
+    {
+        for (int k = 0; k < 16; k++)
+        {
+            // diagonal dominante: todas invertíveis
+            mats[i].m[k] = (random01() - 0.5f) + (k % 5 == 0 ? 4.0f : 0.0f);
+        }
+        vecs[i] = vec4(random01(), random01(), random01(), 1.0f);
+    }
+
+    bench.run("maths/mat4*mat4", matrixCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int i = 0; i < matrixCount; i++)
+            {
+                out[i] = mats[i] * mats[(i + 1) % matrixCount];
+            }
+            doNotOptimize(out.data());
+        }
+    });
+    bench.run("maths/mat4*mat4/scalar", matrixCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int i = 0; i < matrixCount; i++)
+            {
+                out[i] = mul_scalar(mats[i], mats[(i + 1) % matrixCount]);
+            }
+            doNotOptimize(out.data());
+        }
+    });
+    bench.run("maths/mat4*vec4", matrixCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int i = 0; i < matrixCount; i++)
+            {
+                outVecs[i] = mats[i] * vecs[i];
+            }
+            doNotOptimize(outVecs.data());
+        }
+    });
+    bench.run("maths/inverse", matrixCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int i = 0; i < matrixCount; i++)
+            {
+                out[i] = inverse(mats[i]);
+            }
+            doNotOptimize(out.data());
+        }
+    });
+    bench.run("maths/inverse/scalar", matrixCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int i = 0; i < matrixCount; i++)
+            {
+                out[i] = inverse_scalar(mats[i]);
+            }
+            doNotOptimize(out.data());
+        }
+    });
+    bench.run("maths/transpose", matrixCount, [&](long n) {
+        for (long k = 0; k < n; k++)
+        {
+            for (int i = 0; i < matrixCount; i++)
+            {
+                out[i] = transpose(mats[i]);
+            }
+            doNotOptimize(out.data());
+        }
+    });
+}
+
+int main(int argc, char **argv)
+{
+    BenchRunner bench(argc, argv);
+    bench.addContext("maths_simd_backend", maths_simd_backend());
+    srand(1);
+
+    mapBenchmarks(bench);
+    isoBenchmarks(bench);
+    colorBenchmarks(bench);
+    filterBenchmarks(bench);
+    ltMathBenchmarks(bench);
+    mathsBenchmarks(bench);
+    sceneBenchmarks(bench);
+
+    return bench.finish();
+}
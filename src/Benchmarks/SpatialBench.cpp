@@ -0,0 +1,165 @@
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "AabbTree.h"
+#include "SpatialHash.h"
+
+// Micro-benchmark das estruturas espaciais 2D (common/AabbTree.h e
+// common/SpatialHash.h) com 10k, 100k e 1M objetos quadrados espalhados em um
+// mundo de densidade constante:
+//
+//  - construção (inserção na árvore, build do hash)
+//  - move: 10% dos objetos andam um pouco (árvore: refit pela margem)
+//  - consultas por ponto, por retângulo e vizinho mais próximo
+//  - a varredura linear, para comparação, nas consultas por ponto
+//
+// Uso: SpatialBench [consultas]
+
+using namespace std;
+
+typedef chrono::high_resolution_clock Clock;
+
+const float OBJECT_HALF_SIZE = 0.5f;
+const float WORLD_DENSITY = 0.25f; // objetos por unidade de área
+const float QUERY_HALF_SIZE = 4.0f;
+
+double nanosPer(Clock::time_point start, int count)
+{
+    return chrono::duration<double, nano>(Clock::now() - start).count() / count;
+}
+
+float random01()
+{
+    return rand() / (float)RAND_MAX;
+}
+
+Aabb2 boxAround(float x, float y, float halfSize)
+{
+    Aabb2 box = {x - halfSize, y - halfSize, x + halfSize, y + halfSize};
+    return box;
+}
+
+void run(int objectCount, int queryCount)
+{
+    float worldSize = sqrtf(objectCount / WORLD_DENSITY);
+    vector<float> x(objectCount), y(objectCount);
+    for (int i = 0; i < objectCount; i++)
+    {
+        x[i] = random01() * worldSize;
+        y[i] = random01() * worldSize;
+    }
+    vector<float> qx(queryCount), qy(queryCount);
+    for (int i = 0; i < queryCount; i++)
+    {
+        qx[i] = random01() * worldSize;
+        qy[i] = random01() * worldSize;
+    }
+    long found = 0;
+
+    cout << objectCount << " objetos" << endl;
+
+    // árvore
+    AabbTree tree(0.25f);
+    vector<int> leaves(objectCount);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < objectCount; i++)
+    {
+        leaves[i] = tree.insert(boxAround(x[i], y[i], OBJECT_HALF_SIZE), i);
+    }
+    cout << "  árvore: inserção " << nanosPer(start, objectCount) << " ns/objeto, altura " << tree.height() << endl;
+
+    int moveCount = objectCount / 10;
+    start = Clock::now();
+    int reinserted = 0;
+    for (int i = 0; i < moveCount; i++)
+    {
+        int id = rand() % objectCount;
+        x[id] += (random01() - 0.5f) * 0.4f;
+        y[id] += (random01() - 0.5f) * 0.4f;
+        reinserted += tree.move(leaves[id], boxAround(x[id], y[id], OBJECT_HALF_SIZE));
+    }
+    cout << "  árvore: move " << nanosPer(start, moveCount) << " ns/objeto (" << reinserted << " reinseridos de "
+         << moveCount << ")" << endl;
+
+    start = Clock::now();
+    for (int q = 0; q < queryCount; q++)
+    {
+        tree.queryPoint(qx[q], qy[q], [&](int) { found++; return true; });
+    }
+    cout << "  árvore: ponto " << nanosPer(start, queryCount) << " ns";
+    start = Clock::now();
+    for (int q = 0; q < queryCount; q++)
+    {
+        tree.queryRect(boxAround(qx[q], qy[q], QUERY_HALF_SIZE), [&](int) { found++; return true; });
+    }
+    cout << ", retângulo " << nanosPer(start, queryCount) << " ns";
+    start = Clock::now();
+    for (int q = 0; q < queryCount; q++)
+    {
+        found += tree.nearest(qx[q], qy[q], [&](int i) {
+            float dx = x[i] - qx[q], dy = y[i] - qy[q];
+            return dx * dx + dy * dy;
+        }) >= 0;
+    }
+    cout << ", mais próximo " << nanosPer(start, queryCount) << " ns" << endl;
+
+    // hash
+    SpatialHash hash(2.0f * OBJECT_HALF_SIZE, OBJECT_HALF_SIZE);
+    start = Clock::now();
+    hash.build(x.data(), y.data(), objectCount);
+    cout << "  hash: build " << nanosPer(start, objectCount) << " ns/objeto" << endl;
+
+    start = Clock::now();
+    for (int q = 0; q < queryCount; q++)
+    {
+        hash.queryPoint(qx[q], qy[q], [&](int) { found++; return true; });
+    }
+    cout << "  hash: ponto " << nanosPer(start, queryCount) << " ns";
+    start = Clock::now();
+    for (int q = 0; q < queryCount; q++)
+    {
+        hash.queryRect(qx[q] - QUERY_HALF_SIZE, qy[q] - QUERY_HALF_SIZE, qx[q] + QUERY_HALF_SIZE,
+                       qy[q] + QUERY_HALF_SIZE, [&](int) { found++; return true; });
+    }
+    cout << ", retângulo " << nanosPer(start, queryCount) << " ns";
+    start = Clock::now();
+    for (int q = 0; q < queryCount; q++)
+    {
+        found += hash.nearest(qx[q], qy[q]) >= 0;
+    }
+    cout << ", mais próximo " << nanosPer(start, queryCount) << " ns" << endl;
+
+    // varredura linear, com poucas consultas para não dominar o tempo
+    int linearCount = queryCount / 100 > 0 ? queryCount / 100 : 1;
+    start = Clock::now();
+    for (int q = 0; q < linearCount; q++)
+    {
+        for (int i = 0; i < objectCount; i++)
+        {
+            found += boxAround(x[i], y[i], OBJECT_HALF_SIZE).contains(qx[q], qy[q]);
+        }
+    }
+    cout << "  linear: ponto " << nanosPer(start, linearCount) << " ns" << endl;
+
+    cout << "  (soma de controle " << found << ")" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    int queryCount = argc > 1 ? atoi(argv[1]) : 100000;
+    if (queryCount <= 0)
+    {
+        cerr << "Número de consultas inválido: " << argv[1] << endl;
+        exit(EXIT_FAILURE);
+    }
+    srand(1);
+    int sizes[] = {10000, 100000, 1000000};
+    for (int s = 0; s < 3; s++)
+    {
+        run(sizes[s], queryCount);
+    }
+    return EXIT_SUCCESS;
+}
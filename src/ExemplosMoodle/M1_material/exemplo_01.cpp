@@ -1,6 +1,7 @@
 #include <glad/glad.h> // Carregamento dos ponteiros para funções OpenGL
 #include <GLFW/glfw3.h> // GLFW biblioteca para interface com SO (janela, mouse, teclado, ...)
 #include <iostream>      // biblioteca padrão C para I/O
+#include "Trace.h"
 
 using namespace std;
 
@@ -173,6 +174,7 @@ int main () {
   // 5.4 - Finalmente, loop de desenho. Note que até o momento pipeline não foi utilizado!
   glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
   while (!glfwWindowShouldClose (window)) {
+    TRACE_FRAME();
     glClear (GL_COLOR_BUFFER_BIT);
 
     // Define shader_programme como o shader a ser utilizado
@@ -186,10 +188,16 @@ int main () {
 
     // 5.4.2 - Este comando faz controle double buffering, obtendo imagem do framebuffer 
     //         gerado pela OpenGL para renderização no contexto gráfico (window).
-    glfwSwapBuffers (window);
+    {
+      TRACE_ZONE("swapBuffers");
+      glfwSwapBuffers (window);
+    }
 
     // Processa eventos da GLFW
-    glfwPollEvents();
+    {
+      TRACE_ZONE("pollEvents");
+      glfwPollEvents();
+    }
   }
 
   // 6 - Ao final, terminar / remover GLFW da memória.
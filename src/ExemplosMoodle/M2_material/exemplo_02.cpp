@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "Trace.h"
 
 const GLint WIDTH = 800, HEIGHT = 600;
 glm::mat4 matrix = glm::mat4(1);
@@ -112,7 +113,11 @@ int main() {
     glBindVertexArray( 0 );
     
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("pollEvents");
+            glfwPollEvents();
+        }
         
         const int state = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
         if (state == GLFW_PRESS) {
@@ -145,7 +150,10 @@ int main() {
         glDrawArrays( GL_TRIANGLES, 0, 3);
         glBindVertexArray( 0 );
         
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
     
     glfwTerminate();
@@ -6,8 +6,15 @@
 #include <sstream>
 #include <math.h>
 
+#include "JobSystem.h"
+#include "ImageFilters.h"
+
 using namespace std;
 
+// os filtros são independentes por pixel: cada pedaço da imagem vai para uma thread
+JobSystem jobs;
+const int PIXEL_GRAIN = 16 * 1024;
+
 unsigned char *open(string file, int &width, int &height) {
     ifstream arq(file);
     char BUFFER[1024];
@@ -57,13 +64,6 @@ void save(string file, unsigned char *data, int &w, int &h) {
     arq.close();
 }
 
-double dist(int &r1, int &g1, int &b1, int &r2, int &g2, int &b2) {
-    double r = r1 - r2;
-    double g = g1 - g2;
-    double b = b1 - b2;
-    return sqrt(r*r + g*g + b*b);
-}
-
 void chromaKey(unsigned char *data, int w, int h) {
     int r, g, b;
     cout << "Cor-chave: " << endl;
@@ -79,20 +79,9 @@ void chromaKey(unsigned char *data, int w, int h) {
     cin >> t;
     
 
-    double dmax = 441.6729559301;
-
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
-        double d = dist(r, g, b, ri, gi, bi);
-        if (d/dmax < t) {
-            data[i] = 0;
-            data[i+1] = 0;
-            data[i+2] = 0;
-        }
-    }
+    jobs.parallelFor(0, w * h, PIXEL_GRAIN, [&](int first, int last) {
+        chromaKeyPixels(data, first, last, r, g, b, t);
+    });
 }
 
 void grayScale(unsigned char *data, int w, int h) {
@@ -108,14 +97,9 @@ void grayScale(unsigned char *data, int w, int h) {
         bw = 0.0721;
     }
 
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
-
-        data[i] = data[i+1] = data[i+2] = (int)(ri * rw + gi * gw + bi * bw);
-    }
+    jobs.parallelFor(0, w * h, PIXEL_GRAIN, [&](int first, int last) {
+        grayScalePixels(data, first, last, rw, gw, bw);
+    });
 }
 
 void colorize(unsigned char *data, int w, int h) {
@@ -128,29 +112,15 @@ void colorize(unsigned char *data, int w, int h) {
     cout << "\tB: ";
     cin >> b;
     
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
-
-        data[i]   = ri | r;
-        data[i+1] = gi | g;
-        data[i+2] = bi | b;
-    }
+    jobs.parallelFor(0, w * h, PIXEL_GRAIN, [&](int first, int last) {
+        colorizePixels(data, first, last, r, g, b);
+    });
 }
 
 void negative(unsigned char *data, int w, int h) {
-    int length = w * h * 3;
-    for (int i = 0; i < length; i += 3) {
-        int ri = data[i] & 0xff;
-        int gi = data[i+1] & 0xff;
-        int bi = data[i+2] & 0xff;
-
-        data[i]   = ri ^ 255;
-        data[i+1] = gi ^ 255;
-        data[i+2] = bi ^ 255;
-    }
+    jobs.parallelFor(0, w * h, PIXEL_GRAIN, [&](int first, int last) {
+        negativePixels(data, first, last);
+    });
 }
 
 int main() {
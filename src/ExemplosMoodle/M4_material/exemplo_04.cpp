@@ -15,11 +15,13 @@
 // STB_IMAGE
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include "Trace.h"
 
 const GLint WIDTH = 800, HEIGHT = 600;
 glm::mat4 matrix = glm::mat4(1);
 
 bool load_texture (const char* file_name, GLuint* tex) {
+    TRACE_ZONE("load_texture");
     int x, y, n;
     int force_channels = 4;
     glEnable(GL_TEXTURE_2D);
@@ -178,7 +180,11 @@ int main() {
 
     
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("pollEvents");
+            glfwPollEvents();
+        }
         
         const int state = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
         if (state == GLFW_PRESS) {
@@ -212,7 +218,10 @@ int main() {
         glDrawArrays( GL_TRIANGLES, 0, 3);
         glBindVertexArray( 0 );
         
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
     
     glfwTerminate();
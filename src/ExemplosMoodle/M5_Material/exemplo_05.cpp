@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "Layer.h"
+#include "Trace.h"
 
 using namespace std;
 
@@ -30,6 +31,7 @@ GLFWwindow *g_window = NULL;
 
 int loadTexture(unsigned int &texture, char *filename)
 {
+	TRACE_ZONE("loadTexture");
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
 
@@ -219,6 +221,7 @@ int main()
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	while (!glfwWindowShouldClose(g_window))
 	{
+		TRACE_FRAME();
 		_update_fps_counter(g_window);
 		double current_seconds = glfwGetTime();
 
@@ -246,7 +249,10 @@ int main()
 			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 		}
 
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 		if (GLFW_PRESS == glfwGetKey(g_window, GLFW_KEY_ESCAPE))
 		{
 			glfwSetWindowShouldClose(g_window, 1);
@@ -260,7 +266,10 @@ int main()
 			PARALLAX_RATE -= 0.001f;
 		}
 		// put the stuff we've been drawing onto the display
-		glfwSwapBuffers(g_window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(g_window);
+		}
 	}
 
 	// close GL context and any other GLFW resources
@@ -2,6 +2,7 @@
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "gl_utils.h"
+#include "Trace.h"
 #include <glad/glad.h> // Carregamento dos ponteiros para funções OpenGL
 #include <GLFW/glfw3.h>
 #include <assert.h>
@@ -161,6 +162,7 @@ int main()
 	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 	while (!glfwWindowShouldClose(g_window))
 	{
+		TRACE_FRAME();
 		_update_fps_counter(g_window);
 		double current_seconds = glfwGetTime();
 
@@ -199,7 +201,10 @@ int main()
 
 		glBindVertexArray(VAO);
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 		if (GLFW_PRESS == glfwGetKey(g_window, GLFW_KEY_ESCAPE))
 		{
 			glfwSetWindowShouldClose(g_window, 1);
@@ -212,7 +217,10 @@ int main()
 		{
 			acao = (acao + (acao - 1)) % 4;
 		}
-		glfwSwapBuffers(g_window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(g_window);
+		}
 	}
 
 	// close GL context and any other GLFW resources
@@ -17,6 +17,7 @@
 #include "DiamondView.h"
 #include "SlideView.h"
 #include "ltMath.h"
+#include "Trace.h"
 #include <fstream>
 
 
@@ -47,6 +48,7 @@ TileMap *tmap = NULL;
 GLFWwindow *g_window = NULL;
 
 TileMap * readMap (char *filename) {
+    TRACE_ZONE("readMap");
     ifstream arq(filename);
     int w, h;
     arq >> w >> h;
@@ -66,6 +68,7 @@ TileMap * readMap (char *filename) {
 
 int loadTexture(unsigned int &texture, char *filename)
 {
+	TRACE_ZONE("loadTexture");
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
 
@@ -314,6 +317,7 @@ int main()
 	// glEnable(GL_DEPTH_TEST);
 	while (!glfwWindowShouldClose(g_window))
 	{
+		TRACE_FRAME();
 		_update_fps_counter(g_window);
 		double current_seconds = glfwGetTime();
 
@@ -353,7 +357,10 @@ int main()
             
         }
 
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 		if (GLFW_PRESS == glfwGetKey(g_window, GLFW_KEY_ESCAPE))
 		{
 			glfwSetWindowShouldClose(g_window, 1);
@@ -374,7 +381,10 @@ int main()
         }
         
 		// put the stuff we've been drawing onto the display
-		glfwSwapBuffers(g_window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(g_window);
+		}
 	}
 
 	// close GL context and any other GLFW resources
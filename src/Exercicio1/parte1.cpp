@@ -1,6 +1,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include "Trace.h"
 
 #define WIDTH 800
 #define HEIGHT 600
@@ -47,7 +48,11 @@ int main()
 
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("pollEvents");
+            glfwPollEvents();
+        }
 
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
         glClear(GL_COLOR_BUFFER_BIT);
@@ -62,7 +67,10 @@ int main()
 
         glBindVertexArray(0);
 
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
 
     glfwTerminate();
@@ -78,6 +86,7 @@ void drawTriangle(GLuint VAO, GLint colorLoc, float r, float g, float b)
 
 GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
 {
+    TRACE_ZONE("createTriangle");
     GLfloat vertices[] = {
         x0, y0, 0.0f,
         x1, y1, 0.0f,
@@ -103,6 +112,7 @@ GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2
 
 GLuint createShader(GLchar *shaderSource, GLenum shaderType)
 {
+    TRACE_ZONE("createShader");
     GLuint shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &shaderSource, NULL);
     glCompileShader(shader);
@@ -128,6 +138,7 @@ void assertShaderCompilationStatus(GLuint shader)
 
 int createShaderProgram()
 {
+    TRACE_ZONE("createShaderProgram");
     GLuint vertexShader = createShader(R"(
         #version 400
         layout (location = 0) in vec3 position;
@@ -158,6 +169,7 @@ int createShaderProgram()
 
 int createShaderProgram(GLuint vertexShader, GLuint fragmentShader)
 {
+    TRACE_ZONE("linkShaderProgram");
     GLuint shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
@@ -200,6 +212,7 @@ GLFWwindow *makeWindow(int width, int height, const char *title)
 }
 void setupGlad()
 {
+    TRACE_ZONE("setupGlad");
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
@@ -10,6 +10,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "Trace.h"
 
 using namespace glm;
 
@@ -70,7 +71,11 @@ int main()
 
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("pollEvents");
+            glfwPollEvents();
+        }
 
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
         glClear(GL_COLOR_BUFFER_BIT);
@@ -88,7 +93,10 @@ int main()
 
         glBindVertexArray(0);
 
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
 
     glfwTerminate();
@@ -106,6 +114,7 @@ void drawTriangle(Triangle triangle, GLint colorLoc)
 
 Triangle createTriangle(float x, float y, float r, float g, float b, float size)
 {
+    TRACE_ZONE("createTriangle");
     Triangle triangle;
     triangle.r = r;
     triangle.g = g;
@@ -119,6 +128,7 @@ Triangle createTriangle(float x, float y, float r, float g, float b, float size)
 
 void initializeTriangleVao(Triangle &triangle)
 {
+    TRACE_ZONE("initializeTriangleVao");
     GLfloat vertices[] = {
         triangle.posX - triangle.size, triangle.posY + triangle.size, 0.0f,
         triangle.posX, triangle.posY - triangle.size, 0.0f,
@@ -144,6 +154,7 @@ void initializeTriangleVao(Triangle &triangle)
 
 GLuint createShader(GLchar *shaderSource, GLenum shaderType)
 {
+    TRACE_ZONE("createShader");
     GLuint shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &shaderSource, NULL);
     glCompileShader(shader);
@@ -169,6 +180,7 @@ void assertShaderCompilationStatus(GLuint shader)
 
 int createShaderProgram()
 {
+    TRACE_ZONE("createShaderProgram");
     GLuint vertexShader = createShader(R"(
         #version 400
         layout (location = 0) in vec3 position;
@@ -200,6 +212,7 @@ int createShaderProgram()
 
 int createShaderProgram(GLuint vertexShader, GLuint fragmentShader)
 {
+    TRACE_ZONE("linkShaderProgram");
     GLuint shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
@@ -242,6 +255,7 @@ GLFWwindow *makeWindow(int width, int height, const char *title)
 }
 void setupGlad()
 {
+    TRACE_ZONE("setupGlad");
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
@@ -45,6 +45,10 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// Clipes de animação avaliados no vertex shader
+#include "AnimationClips.h"
+#include "Trace.h"
+
 using namespace glm;
 
 
@@ -57,6 +61,8 @@ struct Sprite
 	float ds, dt;
 	int iAnimation, iFrame;
 	int nAnimations, nFrames;
+	int clip; // -1 = sem animação
+	float clipStart;
 
 };
 
@@ -71,17 +77,29 @@ int loadTexture(string filePath, int &width, int &height);
 // Dimensões da janela (pode ser alterado em tempo de execução)
 const GLuint WIDTH = 800, HEIGHT = 600;
 
+// Clipes carregados de assets/animations/sprites.clips
+AnimationClipTable clips;
+
 // Código fonte do Vertex Shader (em GLSL): ainda hardcoded
+// (a linha #version e a função clipRect são acrescentadas em setupShader)
 const GLchar *vertexShaderSource = R"(
- #version 400
  layout (location = 0) in vec3 position;
  layout (location = 1) in vec2 texc;
  out vec2 tex_coord;
  uniform mat4 model;
  uniform mat4 projection;
+ uniform int clip;
+ uniform int direction;
+ uniform float clipStart;
  void main()
  {
 	tex_coord = vec2(texc.s, 1.0 - texc.t);
+	if (clip >= 0)
+	{
+		// texc cobre uma célula da folha: desloca para o quadro atual do clipe
+		vec4 cell = clipRect(clip, direction, clipStart);
+		tex_coord = vec2(texc.s, cell.w - texc.t) + cell.xy;
+	}
 	gl_Position = projection * model * vec4(position, 1.0);
  }
  )";
@@ -154,6 +172,13 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
+	// Clipes de animação (layout das folhas, quadros, fps e modo de repetição)
+	if (!clips.loadFromFile("../assets/animations/sprites.clips"))
+	{
+		glfwTerminate();
+		return -1;
+	}
+
 	// Compilando e buildando o programa de shader
 	GLuint shaderID = setupShader();
 
@@ -163,8 +188,16 @@ int main()
 
 	// Gerando um buffer simples, com a geometria de um triângulo
 	Sprite vampirao;
-	vampirao.nAnimations = 4;
-	vampirao.nFrames = 6;
+	vampirao.clip = clips.find("vampire_walk");
+	if (vampirao.clip < 0)
+	{
+		std::cerr << "Clipe vampire_walk não encontrado" << std::endl;
+		glfwTerminate();
+		return -1;
+	}
+	vampirao.clipStart = 0.0;
+	vampirao.nAnimations = clips.get(vampirao.clip).rows;
+	vampirao.nFrames = clips.get(vampirao.clip).columns;
 	vampirao.VAO = setupSprite(vampirao.nAnimations,vampirao.nFrames,vampirao.ds,vampirao.dt);
 	vampirao.position = vec3(400.0, 150.0, 0.0);
 	vampirao.dimensions = vec3(imgWidth/vampirao.nFrames*4,imgHeight/vampirao.nAnimations*4,1.0);
@@ -181,6 +214,8 @@ int main()
 	background.dimensions = vec3(imgWidth/background.nFrames*0.5,imgHeight/background.nAnimations*0.5,1.0);
 	background.iAnimation = 0;
 	background.iFrame = 0;
+	background.clip = -1;
+	background.clipStart = 0.0;
 
 	
 
@@ -201,6 +236,10 @@ int main()
 	mat4 projection = ortho(0.0, 800.0, 0.0, 600.0, -1.0, 1.0);
 	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
 
+	// Envia a tabela de clipes: a partir daqui o quadro de cada sprite é
+	// calculado no vertex shader com o uniform "time"
+	clips.upload(shaderID);
+
 	glEnable(GL_DEPTH_TEST); // Habilita o teste de profundidade
 	glDepthFunc(GL_ALWAYS); // Testa a cada ciclo
 
@@ -218,6 +257,7 @@ int main()
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		TRACE_FRAME();
 		// Este trecho de código é totalmente opcional: calcula e mostra a contagem do FPS na barra de título
 		{
 			double curr_s = glfwGetTime();		// Obtém o tempo atual.
@@ -240,7 +280,10 @@ int main()
 		}
 
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
@@ -261,14 +304,17 @@ int main()
 
 		currTime = glfwGetTime();
 		deltaT = currTime - lastTime;
+		glUniform1f(glGetUniformLocation(shaderID, "time"), (float)currTime);
 
 		if (deltaT >= 1.0/FPS)
 		{
 			background.iFrame = (background.iFrame + 1) % 100;
+			lastTime = currTime;
 		}
 		offsetTexBg.s = background.iFrame * 0.01;
 		offsetTexBg.t = 0.0;
 		glUniform2f(glGetUniformLocation(shaderID, "offsetTex"),offsetTexBg.s, offsetTexBg.t);
+		glUniform1i(glGetUniformLocation(shaderID, "clip"), background.clip);
 
 		glBindVertexArray(background.VAO); // Conectando ao buffer de geometria
 		glBindTexture(GL_TEXTURE_2D, background.texID); // Conectando ao buffer de textura
@@ -287,17 +333,11 @@ int main()
 		model = scale(model,vampirao.dimensions);
 		glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
 
-		vec2 offsetTex;
-
-		if (deltaT >= 1.0/FPS)
-		{
-			vampirao.iFrame = (vampirao.iFrame + 1) % vampirao.nFrames; // incremento "circular"
-			lastTime = currTime;
-		}
-
-		offsetTex.s = vampirao.iFrame * vampirao.ds;
-		offsetTex.t = 0.0;
-		glUniform2f(glGetUniformLocation(shaderID, "offsetTex"),offsetTex.s, offsetTex.t);
+		// O quadro sai do clipe no vertex shader; a linha da folha é a direção
+		glUniform2f(glGetUniformLocation(shaderID, "offsetTex"), 0.0, 0.0);
+		glUniform1i(glGetUniformLocation(shaderID, "clip"), vampirao.clip);
+		glUniform1i(glGetUniformLocation(shaderID, "direction"), vampirao.iAnimation);
+		glUniform1f(glGetUniformLocation(shaderID, "clipStart"), vampirao.clipStart);
 
 		glBindVertexArray(vampirao.VAO); // Conectando ao buffer de geometria
 		glBindTexture(GL_TEXTURE_2D, vampirao.texID); // Conectando ao buffer de textura
@@ -308,7 +348,10 @@ int main()
 		//---------------------------------------------------------------------------
 
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(window);
+		}
 	}
 		
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
@@ -332,9 +375,12 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 //  A função retorna o identificador do programa de shader
 int setupShader()
 {
+	TRACE_ZONE("setupShader");
 	// Vertex shader
+	string vertexSource = "#version 400\n" + AnimationClipTable::glsl() + vertexShaderSource;
+	const GLchar *vertexSourcePtr = vertexSource.c_str();
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+	glShaderSource(vertexShader, 1, &vertexSourcePtr, NULL);
 	glCompileShader(vertexShader);
 	// Checando erros de compilação (exibição via log no terminal)
 	GLint success;
@@ -384,6 +430,7 @@ int setupShader()
 // A função retorna o identificador do VAO
 int setupSprite(int nAnimations, int nFrames, float &ds, float &dt)
 {
+	TRACE_ZONE("setupSprite");
 
 	ds = 1.0 / (float) nFrames;
 	dt = 1.0 / (float) nAnimations;
@@ -440,6 +487,7 @@ int setupSprite(int nAnimations, int nFrames, float &ds, float &dt)
 
 int loadTexture(string filePath, int &width, int &height)
 {
+	TRACE_ZONE("loadTexture");
 	GLuint texID;
 
 	// Gera o identificador da textura na memória
@@ -39,6 +39,7 @@ using namespace std;
 // STB_IMAGE
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
+#include "Trace.h"
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
@@ -161,6 +162,7 @@ int main()
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		TRACE_FRAME();
 		// Este trecho de código é totalmente opcional: calcula e mostra a contagem do FPS na barra de título
 		{
 			double curr_s = glfwGetTime();		// Obtém o tempo atual.
@@ -183,7 +185,10 @@ int main()
 		}
 
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
@@ -205,7 +210,10 @@ int main()
 		// glBindVertexArray(0); // Desnecessário aqui, pois não há múltiplos VAOs
 
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(window);
+		}
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
@@ -230,6 +238,7 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 //  A função retorna o identificador do programa de shader
 int setupShader()
 {
+	TRACE_ZONE("setupShader");
 	// Vertex shader
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
@@ -282,6 +291,7 @@ int setupShader()
 // A função retorna o identificador do VAO
 int setupSprite()
 {
+	TRACE_ZONE("setupSprite");
 	// Aqui setamos as coordenadas x, y e z do triângulo e as armazenamos de forma
 	// sequencial, já visando mandar para o VBO (Vertex Buffer Objects)
 	// Cada atributo do vértice (coordenada, cores, coordenadas de textura, normal, etc)
@@ -335,6 +345,7 @@ int setupSprite()
 
 int loadTexture(string filePath)
 {
+	TRACE_ZONE("loadTexture");
 	GLuint texID;
 
 	// Gera o identificador da textura na memória
@@ -3,30 +3,60 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
-#include "../../build/_deps/stb_image-src/stb_easy_font.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "ColorSimilarity.h"
+#include "RedrawScheduler.h"
+#include "TextRenderer.h"
+#include "Trace.h"
+#include "GlStats.h"
+#include "InputReplay.h"
+#include "AllocTracker.h"
 
 const GLuint WIDTH = 800;
 const GLuint HEIGHT = 600;
-const int COLUMNS = 8;
-const int ROWS = 6;
-const GLuint RECTANGLE_WIDTH = 100;
-const GLuint RECTANGLE_HEIGHT = 100;
 const float TOLERANCE = 0.2f;
-const float MAXIMUM_DISTANCE = sqrt(3.0f);
+// a partir deste número de retângulos os cliques usam o índice por buckets
+const int SIMILARITY_INDEX_MINIMUM = 256 * 1024;
+const int SIMILARITY_BUCKETS = 16;
 const char *WINDOW_TITLE = "Jogo das Cores - Módulo 3";
 bool finished = false;
 float attempts = 0;
-
+bool showFrameTime = false; // F3 liga o tempo de quadro no canto da tela
+
+// tamanho da grade (jogoDasCores [colunas linhas]); os retângulos dividem a janela
+int columns = 8;
+int rows = 6;
+float rectangleWidth;
+float rectangleHeight;
+
+// Dados por instância da grade, na ordem i * columns + j. Posição e cor só
+// mudam ao reiniciar; a marca de eliminado (similarity.flags()) fica em um
+// buffer separado de um byte por retângulo, atualizado só nos retângulos que
+// mudam a cada clique.
 struct Rectangle
 {
-    glm::vec3 position;
-    glm::vec3 dimensions;
+    glm::vec2 position;
     glm::vec3 color;
-    bool eliminated;
 };
 
-Rectangle grid[ROWS][COLUMNS];
+std::vector<Rectangle> grid;
+ColorSimilarity similarity;         // cores em SoA e marcas de eliminado
+std::vector<int> changedRectangles; // eliminados desde o último envio à GPU
+GLuint gridVBO = 0;
+GLuint eliminatedVBO = 0;
+
+// a cena só muda com cliques e com o R: sem eles o laço fica dormindo
+RedrawScheduler redraw;
+InputReplay input; // PGCC_RECORD / PGCC_REPLAY (ver InputReplay.h)
+
+// dica, placar e tempo de quadro, desenhados em uma chamada; criado depois do
+// contexto e destruído antes do glfwTerminate
+TextRenderer *text = NULL;
 
 // initial setup (GLAD, GL hints and window configuration)
 void setupGlConfiguration()
@@ -53,11 +83,13 @@ void setViewportDimensions(GLFWwindow *window)
 }
 void setupGlad()
 {
+    TRACE_ZONE("setupGlad");
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
         exit(EXIT_FAILURE);
     }
+    GlStats::initFromEnvironment(); // PGCC_GL_STATS=<quadros>
 
     std::cout << "GLAD inicializado com sucesso!" << std::endl;
 }
@@ -88,6 +120,7 @@ GLFWwindow *makeWindow(GLuint width, GLuint height, const char *title)
 
 void initializeGlfw()
 {
+    TRACE_ZONE("initializeGlfw");
     if (!glfwInit())
     {
         std::cerr << "Falha ao inicializar GLFW" << std::endl;
@@ -146,6 +179,7 @@ void assertShaderCompilationStatus(GLuint shader)
 
 GLuint createShader(GLchar *shaderSource, GLenum shaderType)
 {
+    TRACE_ZONE("createShader");
     GLuint shader = glCreateShader(shaderType);
     if (!shader)
     {
@@ -177,23 +211,31 @@ void assertProgramLinkingStatus(GLuint shaderProgram)
 
 GLuint createShaderProgram()
 {
+    TRACE_ZONE("createShaderProgram");
     const GLuint vertexShader = createShader(R"(
         #version 400 
         layout(location = 0) in vec3 position;
+        layout(location = 1) in vec2 rectanglePosition;   // por instância
+        layout(location = 2) in vec3 rectangleColor;      // por instância
+        layout(location = 3) in float rectangleEliminated; // por instância, 0 ou 1
         uniform mat4 projection;
-        uniform mat4 model;
+        uniform vec2 rectangleSize;
+        out vec3 vertexColor;
         void main() {
-	        gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
+            // eliminado vira um quad degenerado: nenhum fragmento é gerado
+            vec2 corner = position.xy * rectangleSize * (1.0 - rectangleEliminated);
+            gl_Position = projection * vec4(rectanglePosition + corner, position.z, 1.0);
+            vertexColor = rectangleColor;
         }
     )",
                                              GL_VERTEX_SHADER);
 
     const GLuint fragmentShader = createShader(R"(
         #version 400
-        uniform vec4 inputColor;
+        in vec3 vertexColor;
         out vec4 color;
         void main() {
-            color = inputColor * vec4(1.0); // Ensure inputColor is used
+            color = vec4(vertexColor, 1.0);
         }
     )",
                                                GL_FRAGMENT_SHADER);
@@ -211,42 +253,81 @@ GLuint createShaderProgram()
 
 bool areAllSquaresEliminated()
 {
-    for (int i = 0; i < ROWS; i++)
+    return similarity.remaining() == 0;
+}
+
+// envia a grade inteira (posições, cores e marcas) para os buffers de instância
+void uploadGrid()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+    glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(Rectangle), grid.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, eliminatedVBO);
+    glBufferData(GL_ARRAY_BUFFER, similarity.size(), similarity.flags(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    changedRectangles.clear();
+}
+
+// Envia só as marcas dos retângulos eliminados desde o último envio. Índices
+// consecutivos viram um único glBufferSubData.
+void uploadChangedRectangles()
+{
+    if (changedRectangles.empty())
+    {
+        return;
+    }
+    // com o índice por buckets os índices não chegam em ordem
+    if (!std::is_sorted(changedRectangles.begin(), changedRectangles.end()))
     {
-        for (int j = 0; j < COLUMNS; j++)
+        std::sort(changedRectangles.begin(), changedRectangles.end());
+    }
+    const GLubyte *flags = similarity.flags();
+    glBindBuffer(GL_ARRAY_BUFFER, eliminatedVBO);
+    size_t first = 0;
+    while (first < changedRectangles.size())
+    {
+        size_t last = first + 1;
+        while (last < changedRectangles.size() && changedRectangles[last] == changedRectangles[last - 1] + 1)
         {
-            if (!grid[i][j].eliminated)
-            {
-                return false; // Found a square that is not eliminated
-            }
+            last++;
         }
+        int start = changedRectangles[first];
+        int count = changedRectangles[last - 1] - start + 1;
+        glBufferSubData(GL_ARRAY_BUFFER, start, count, flags + start);
+        first = last;
     }
-    return true; // All squares are eliminated
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    changedRectangles.clear();
 }
 
 void initializeGrid()
 {
+    TRACE_ZONE("initializeGrid");
 
     finished = false;
     attempts = 0;
-    for (int i = 0; i < ROWS; i++)
+    grid.resize(rows * columns);
+    similarity.resize(rows * columns);
+    glm::vec2 initialPosition = glm::vec2(rectangleWidth / 2, rectangleHeight / 2);
+    for (int i = 0; i < rows; i++)
     {
-        for (int j = 0; j < COLUMNS; j++)
+        for (int j = 0; j < columns; j++)
         {
-            Rectangle rectangle;
-            glm::vec2 initialPosition = glm::vec2(RECTANGLE_WIDTH / 2, RECTANGLE_HEIGHT / 2);
-            rectangle.position = glm::vec3(initialPosition.x + j * RECTANGLE_WIDTH, initialPosition.y + i * RECTANGLE_HEIGHT, 0.0f);
-            rectangle.dimensions = glm::vec3(RECTANGLE_WIDTH, RECTANGLE_HEIGHT, 1.0f);
+            Rectangle &rectangle = grid[i * columns + j];
+            rectangle.position = glm::vec2(initialPosition.x + j * rectangleWidth, initialPosition.y + i * rectangleHeight);
 
             float r = rand() % 256 / 255.0f;
             float g = rand() % 256 / 255.0f;
             float b = rand() % 256 / 255.0f;
 
             rectangle.color = glm::vec3(r, g, b);
-            rectangle.eliminated = false;
-            grid[i][j] = rectangle;
+            similarity.setColor(i * columns + j, r, g, b);
         }
     }
+    if (rows * columns >= SIMILARITY_INDEX_MINIMUM)
+    {
+        similarity.buildIndex(SIMILARITY_BUCKETS);
+    }
+    uploadGrid();
 }
 
 // callbacks
@@ -261,6 +342,18 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
     {
         std::cout << "Reiniciando o jogo" << std::endl;
         initializeGrid();
+        redraw.invalidate();
+    }
+
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+    {
+        showFrameTime = !showFrameTime;
+        redraw.invalidate();
+    }
+
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+    {
+        GlStats::toggle();
     }
 }
 
@@ -269,35 +362,22 @@ void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods)
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
     {
         double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
+        input.cursorPos(window, &xpos, &ypos);
         std::cout << "Clique do mouse: " << xpos << ", " << ypos << std::endl;
-        int x = xpos / RECTANGLE_WIDTH;
-        int y = ypos / RECTANGLE_HEIGHT;
-
-        Rectangle &selectedRectangle = grid[y][x];
-        selectedRectangle.eliminated = true;
+        int x = xpos / rectangleWidth;
+        int y = ypos / rectangleHeight;
+        if (xpos < 0 || ypos < 0 || x >= columns || y >= rows)
+        {
+            return; // fora da grade
+        }
 
         std::cout << "Quadrado selecionado: " << x << ", " << y << std::endl;
 
-        glm::vec3 currentColor = selectedRectangle.color;
-
-        for (int i = 0; i < ROWS; i++)
-        {
-            for (int j = 0; j < COLUMNS; j++)
-            {
-                float distance = sqrt(pow(currentColor.r - grid[i][j].color.r, 2) +
-                                      pow(currentColor.g - grid[i][j].color.g, 2) +
-                                      pow(currentColor.b - grid[i][j].color.b, 2));
-
-                float normalizedDistance = distance / MAXIMUM_DISTANCE;
-                if (normalizedDistance < TOLERANCE)
-                {
-                    grid[i][j].eliminated = true;
-                }
-            }
-        }
+        // o próprio retângulo clicado tem distância 0 e também é eliminado
+        similarity.eliminateSimilar(y * columns + x, TOLERANCE, changedRectangles);
 
         attempts++;
+        redraw.invalidate();
 
         std::cout << "Pontuanção Atual: " << 100.0f / sqrt(attempts) << std::endl;
         if (areAllSquaresEliminated())
@@ -310,6 +390,7 @@ void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods)
 
 GLuint createRectangle()
 {
+    TRACE_ZONE("createRectangle");
     GLfloat vertices[] = {
         -0.5, 0.5, 0.0,  // Top-left
         -0.5, -0.5, 0.0, // Bottom-left
@@ -332,31 +413,81 @@ GLuint createRectangle()
     glVertexAttribPointer(POSITION_ATTRIBUTE_LOCATION, POSITION_ATTRIBUTE_SIZE, GL_FLOAT, GL_FALSE, POSITION_ATTRIBUTE_SIZE * sizeof(GLfloat), (GLvoid *)0);
     glEnableVertexAttribArray(0);
 
+    // atributos por instância: um retângulo da grade por instância
+    glGenBuffers(1, &gridVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Rectangle), (GLvoid *)offsetof(Rectangle, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Rectangle), (GLvoid *)offsetof(Rectangle, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glGenBuffers(1, &eliminatedVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, eliminatedVBO);
+    glVertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(GLubyte), (GLvoid *)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
     return VAO;
 }
 
-void renderText(const char *text, float x, float y)
+// texto com sombra preta, para ficar legível sobre qualquer cor da grade;
+// textos que mudam todo quadro não passam pelo cache de layouts
+void drawHudText(const char *line, float x, float y, bool cached = true)
 {
-    static char buffer[99999]; // pode armazenar até 99999 vértices
-    int num_quads;
-
-    num_quads = stb_easy_font_print(x, y, (char *)text, nullptr, buffer, sizeof(buffer));
+    const float scale = 2.0f;
+    if (cached)
+    {
+        text->draw(line, x + scale, y + scale, scale, 0.0f, 0.0f, 0.0f);
+        text->draw(line, x, y, scale);
+    }
+    else
+    {
+        text->drawUncached(line, x + scale, y + scale, scale, 0.0f, 0.0f, 0.0f);
+        text->drawUncached(line, x, y, scale);
+    }
+}
 
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(2, GL_FLOAT, 16, buffer);
-    glDrawArrays(GL_QUADS, 0, num_quads * 4);
-    glDisableClientState(GL_VERTEX_ARRAY);
+void drawHud(double frameTime)
+{
+    char line[64];
+    drawHudText("Pressione R para reiniciar o jogo", 10.0f, 10.0f);
+    snprintf(line, sizeof(line), "Tentativas: %d", (int)attempts);
+    drawHudText(line, 10.0f, 40.0f);
+    snprintf(line, sizeof(line), "Pontuacao: %.1f", attempts > 0 ? 100.0f / sqrt(attempts) : 100.0f);
+    drawHudText(line, 10.0f, 70.0f);
+    if (showFrameTime)
+    {
+        snprintf(line, sizeof(line), "quadro: %.2f ms", frameTime * 1000.0);
+        drawHudText(line, WIDTH - 10.0f - 2.0f * text->widthUncached(line), 10.0f, false);
+    }
+    text->flush(WIDTH, HEIGHT);
 }
 
-int main()
+int main(int argc, char **argv)
 {
     std::cout << "Jogo das Cores - Módulo 3 - Leonardo Meinerz Ramos" << std::endl;
 
+    if (argc > 2)
+    {
+        columns = atoi(argv[1]);
+        rows = atoi(argv[2]);
+        if (columns <= 0 || rows <= 0)
+        {
+            std::cerr << "Tamanho de grade inválido: " << argv[1] << "x" << argv[2] << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    rectangleWidth = (float)WIDTH / columns;
+    rectangleHeight = (float)HEIGHT / rows;
+
     initializeGlfw();
     setupGlConfiguration();
+    input.initFromEnvironment();
 
     GLFWwindow *window = makeWindow(WIDTH, HEIGHT, WINDOW_TITLE);
 
@@ -378,22 +509,42 @@ int main()
     }
     glfwSetKeyCallback(window, keyCallback);
     glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    redraw.install(window);
+    input.install(window, redraw);
 
     GLuint rectangleVAO = createRectangle();
     std::cout << "VAO do retângulo criado com sucesso!" << std::endl;
 
+    text = new TextRenderer();
+    if (!text->init())
+    {
+        std::cerr << "Falha ao criar o renderizador de texto" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
     initializeGrid();
 
     glm::mat4 projection = glm::ortho(0.0f, (float)WIDTH, (float)HEIGHT, 0.0f, -1.0f, 1.0f);
     glUniformMatrix4fv(glGetUniformLocation(shaderId, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
     std::cout << "Matriz de projeção definida!" << std::endl;
 
-    GLint colorLocation = glGetUniformLocation(shaderId, "inputColor");
+    glUniform2f(glGetUniformLocation(shaderId, "rectangleSize"), rectangleWidth, rectangleHeight);
     checkOpenGLError("Uniform Location Retrieval");
 
+    double frameTime = 0.0; // CPU gasta no último quadro desenhado
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("waitEvents");
+            input.waitEvents(redraw);
+        }
+        if (!redraw.beginFrame())
+        {
+            continue;
+        }
+        AllocTracker::beginFrame();
+        double frameStart = glfwGetTime();
 
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -401,46 +552,29 @@ int main()
         glLineWidth(10);
         glPointSize(20);
 
+        glUseProgram(shaderId);
         glBindVertexArray(rectangleVAO);
 
-        renderText("Pressione R para reiniciar o jogo", 10.0f, 20.0f);
-        for (int i = 0; i < ROWS; i++)
-        {
-            for (int j = 0; j < COLUMNS; j++)
-            {
-                Rectangle &currentRectangle = grid[i][j];
-                if (currentRectangle.eliminated)
-                {
-                    continue; // Skip rendering for eliminated rectangles
-                }
-                glm::mat4 model = glm::mat4(1);
-                model = translate(model, currentRectangle.position);
-                model = scale(model, currentRectangle.dimensions);
-
-                GLint modelLocation = glGetUniformLocation(shaderId, "model");
-                if (modelLocation == -1)
-                {
-                    std::cerr << "Erro: Uniform 'model' não encontrado no shader!" << std::endl;
-                    exit(EXIT_FAILURE);
-                }
-                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
-
-                if (colorLocation == -1)
-                {
-                    std::cerr << "Erro: Uniform 'inputColor' não encontrado no shader!" << std::endl;
-                    exit(EXIT_FAILURE);
-                }
-                glUniform4f(colorLocation, currentRectangle.color.r, currentRectangle.color.g, currentRectangle.color.b, 1.0f);
-
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            }
-        }
+        // a grade inteira em uma chamada; só os cliques desde o último
+        // quadro são enviados
+        uploadChangedRectangles();
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, rows * columns);
 
         glBindVertexArray(0);
 
-        glfwSwapBuffers(window);
+        drawHud(frameTime);
+        frameTime = glfwGetTime() - frameStart;
+
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
+        GlStats::frame();
+        AllocTracker::endFrame();
+        input.endFrame();
     }
 
+    delete text;
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
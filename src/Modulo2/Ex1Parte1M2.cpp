@@ -28,6 +28,7 @@ using namespace std;
 using namespace glm;
 
 #include <cmath>
+#include "Trace.h"
 
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
@@ -135,8 +136,12 @@ int main()
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		TRACE_FRAME();
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
@@ -164,7 +169,10 @@ int main()
 		glBindVertexArray(0); // Desconectando o buffer de geometria
 
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(window);
+		}
 	}
 	// Pede pra OpenGL desalocar os buffers
 	//glDeleteVertexArrays(1, &VAO);
@@ -189,6 +197,7 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 //  A função retorna o identificador do programa de shader
 int setupShader()
 {
+	TRACE_ZONE("setupShader");
 	// Vertex shader
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
@@ -241,6 +250,7 @@ int setupShader()
 // A função retorna o identificador do VAO
 int setupGeometry()
 {
+	TRACE_ZONE("setupGeometry");
 	// Aqui setamos as coordenadas x, y e z do triângulo e as armazenamos de forma
 	// sequencial, já visando mandar para o VBO (Vertex Buffer Objects)
 	// Cada atributo do vértice (coordenada, cores, coordenadas de textura, normal, etc)
@@ -288,6 +298,7 @@ int setupGeometry()
 
 GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
 {
+	TRACE_ZONE("createTriangle");
 	GLuint VAO;
 
 	GLfloat vertices[] = {
@@ -29,12 +29,27 @@ using namespace glm;
 
 #include <cmath>
 
+// Desenho sob demanda: só redesenha quando um triângulo é adicionado
+#include "RedrawScheduler.h"
+RedrawScheduler redraw;
+
+// Todos os triângulos ficam em um único VBO e são desenhados com uma chamada
+#include "GeometryPool.h"
+GeometryPool *pool = NULL; // criado depois do contexto, destruído antes do glfwTerminate
+
+// Picking dos triângulos (botão direito): a árvore de AABBs acha os candidatos
+// sob o cursor e o teste ponto-em-triângulo decide
+#include "AabbTree.h"
+#include "TriangleSet.h"
+#include "Trace.h"
+
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 
 // Protótipos das funções
-GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2);
+int createTriangle(float x0, float y0, float x1, float y1, float x2, float y2, vec3 color);
+void addTriangle(vec3 position, vec3 dimensions);
 int setupShader();
 int setupGeometry();
 
@@ -45,23 +60,25 @@ const GLuint WIDTH = 800, HEIGHT = 600;
 const GLchar *vertexShaderSource = R"(
 #version 400
 layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 vertexColor;
 uniform mat4 projection;
-uniform mat4 model;
+out vec3 color;
 void main()	
 {
-	//...pode ter mais linhas de código aqui!
-	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
+	// os vértices já chegam transformados (em pixels) do pool
+	gl_Position = projection * vec4(position.x, position.y, position.z, 1.0);
+	color = vertexColor;
 }
 )";
 
 // Código fonte do Fragment Shader (em GLSL): ainda hardcoded
 const GLchar *fragmentShaderSource = R"(
 #version 400
-uniform vec4 inputColor;
-out vec4 color;
+in vec3 color;
+out vec4 fragColor;
 void main()
 {
-	color = inputColor;
+	fragColor = vec4(color, 1.0);
 }
 )";
 
@@ -70,9 +87,13 @@ struct Triangle
 	vec3 position;
 	vec3 dimensions;
 	vec3 color;
+	int geometry; // id no pool
+	int proxy; // folha em broadPhase
 };
 
 vector<Triangle> triangles;
+TriangleSet hitTest; // um por triângulo, no mesmo índice de triangles
+AabbTree broadPhase; // caixa de cada triângulo; data = índice em triangles
 
 vector <vec3> colors;
 int iColor = 0;
@@ -103,6 +124,7 @@ int main()
 	// Fazendo o registro da função de callback para a janela GLFW
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	redraw.install(window);
 
 	// GLAD: carrega todos os ponteiros d funções da OpenGL
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -145,23 +167,16 @@ int main()
 	// Compilando e buildando o programa de shader
 	GLuint shaderID = setupShader();
 
-	
-	GLuint VAO = createTriangle(-0.5,-0.5,0.5,-0.5,0.0,0.5);
-	
-	Triangle tri;
-	tri.position = vec3(400.0,300.0,0.0);
-	tri.dimensions = vec3(100.0,100.0,1.0);
-	tri.color = vec3(colors[iColor].r, colors[iColor].g, colors[iColor].b);
-	iColor = (iColor + 1) % colors.size();
-	triangles.push_back(tri);
+	// Layout dos vértices do pool: posição (x, y, z) e cor (r, g, b)
+	pool = new GeometryPool();
+	pool->addAttribute(0, 3);
+	pool->addAttribute(1, 3);
+	pool->init();
 
+	addTriangle(vec3(400.0,300.0,0.0), vec3(100.0,100.0,1.0));
 
-	glUseProgram(shaderID);
 
-	// Enviando a cor desejada (vec4) para o fragment shader
-	// Utilizamos a variáveis do tipo uniform em GLSL para armazenar esse tipo de info
-	// que não está nos buffers
-	GLint colorLoc = glGetUniformLocation(shaderID, "inputColor");
+	glUseProgram(shaderID);
 
 	// Matriz de projeção paralela ortográfica
 	// mat4 projection = ortho(-10.0, 10.0, -10.0, 10.0, -1.0, 1.0);
@@ -171,8 +186,17 @@ int main()
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		TRACE_FRAME();
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		// (dorme enquanto nada mudar na cena)
+		{
+			TRACE_ZONE("waitEvents");
+			redraw.waitEvents();
+		}
+		if (!redraw.beginFrame())
+		{
+			continue;
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
@@ -181,25 +205,9 @@ int main()
 		glLineWidth(10);
 		glPointSize(20);
 
-		glBindVertexArray(VAO); // Conectando ao buffer de geometria
+		// Todos os triângulos em uma única chamada de desenho
+		pool->draw(GL_TRIANGLES);
 
-		for (int i = 0; i < triangles.size(); i++)
-		{
-			// Matriz de modelo: transformações na geometria (objeto)
-			mat4 model = mat4(1); // matriz identidade
-			// Translação
-			model = translate(model,vec3(triangles[i].position.x,triangles[i].position.y,0.0));
-
-			model = rotate(model,radians(180.0f),vec3(0.0,0.0,1.0));
-			// Escala
-			model = scale(model,vec3(triangles[i].dimensions.x,triangles[i].dimensions.y,1.0));
-			glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-
-			glUniform4f(colorLoc, triangles[i].color.r, triangles[i].color.g, triangles[i].color.b, 1.0f); // enviando cor para variável uniform inputColor
-			// Chamada de desenho - drawcall
-			// Poligono Preenchido - GL_TRIANGLES
-			glDrawArrays(GL_TRIANGLES, 0, 3);
-		}
 		// Desenho com contorno (linhas)
 		// glUniform4f(colorLoc, 1.0f, 0.0f, 1.0f, 1.0f); //enviando cor para variável uniform inputColor
 		// glDrawArrays(GL_LINE_LOOP, 0, 3); //Desenha T0
@@ -209,14 +217,16 @@ int main()
 		// glUniform4f(colorLoc, 1.0f, 1.0f, 0.0f, 1.0f); //enviando cor para variável uniform inputColor
 		// glDrawArrays(GL_POINTS, 0, 6);
 
-		glBindVertexArray(0); // Desconectando o buffer de geometria
-
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(window);
+		}
 	}
 	// Pede pra OpenGL desalocar os buffers
 	//glDeleteVertexArrays(1, &VAO);
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
+	delete pool;
 	glfwTerminate();
 	return 0;
 }
@@ -237,6 +247,7 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 //  A função retorna o identificador do programa de shader
 int setupShader()
 {
+	TRACE_ZONE("setupShader");
 	// Vertex shader
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
@@ -289,6 +300,7 @@ int setupShader()
 // A função retorna o identificador do VAO
 int setupGeometry()
 {
+	TRACE_ZONE("setupGeometry");
 	// Aqui setamos as coordenadas x, y e z do triângulo e as armazenamos de forma
 	// sequencial, já visando mandar para o VBO (Vertex Buffer Objects)
 	// Cada atributo do vértice (coordenada, cores, coordenadas de textura, normal, etc)
@@ -334,49 +346,49 @@ int setupGeometry()
 	return VAO;
 }
 
-GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
+// Acrescenta ao pool um triângulo com os vértices já transformados e a cor
+// repetida nos três; retorna o id da primitiva no pool
+int createTriangle(float x0, float y0, float x1, float y1, float x2, float y2, vec3 color)
 {
-	GLuint VAO;
-
+	TRACE_ZONE("createTriangle");
 	GLfloat vertices[] = {
-		// x    y    z
-		// T0
-		x0, y0, 0.0, // v0
-		x1, y1, 0.0, // v1
-		x2, y2, 0.0, // v2
+		// x    y    z    r    g    b
+		x0, y0, 0.0, color.r, color.g, color.b, // v0
+		x1, y1, 0.0, color.r, color.g, color.b, // v1
+		x2, y2, 0.0, color.r, color.g, color.b, // v2
 	};
 
-	GLuint VBO;
-	// Geração do identificador do VBO
-	glGenBuffers(1, &VBO);
-	// Faz a conexão (vincula) do buffer como um buffer de array
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	// Envia os dados do array de floats para o buffer da OpenGl
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	// Geração do identificador do VAO (Vertex Array Object)
-	glGenVertexArrays(1, &VAO);
-	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vértices
-	// e os ponteiros para os atributos
-	glBindVertexArray(VAO);
-	// Para cada atributo do vertice, criamos um "AttribPointer" (ponteiro para o atributo), indicando:
-	//  Localização no shader * (a localização dos atributos devem ser correspondentes no layout especificado no vertex shader)
-	//  Numero de valores que o atributo tem (por ex, 3 coordenadas xyz)
-	//  Tipo do dado
-	//  Se está normalizado (entre zero e um)
-	//  Tamanho em bytes
-	//  Deslocamento a partir do byte zero
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid *)0);
-	glEnableVertexAttribArray(0);
-
-	// Observe que isso é permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vértice
-	// atualmente vinculado - para que depois possamos desvincular com segurança
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return pool->allocate(vertices, 3);
+}
 
-	// Desvincula o VAO (é uma boa prática desvincular qualquer buffer ou array para evitar bugs medonhos)
-	glBindVertexArray(0);
+// Cria um triângulo na posição e tamanho dados com a próxima cor da paleta.
+// A matriz de modelo é aplicada aqui, uma vez, em vez de a cada quadro.
+void addTriangle(vec3 position, vec3 dimensions)
+{
+	Triangle tri;
+	tri.position = position;
+	tri.dimensions = dimensions;
+	tri.color = vec3(colors[iColor].r, colors[iColor].g, colors[iColor].b);
+	iColor = (iColor + 1) % colors.size();
 
-	return VAO;
+	// Matriz de modelo: transformações na geometria (objeto)
+	mat4 model = mat4(1); // matriz identidade
+	// Translação
+	model = translate(model,vec3(tri.position.x,tri.position.y,0.0));
+
+	model = rotate(model,radians(180.0f),vec3(0.0,0.0,1.0));
+	// Escala
+	model = scale(model,vec3(tri.dimensions.x,tri.dimensions.y,1.0));
+
+	vec4 v0 = model * vec4(-0.5, -0.5, 0.0, 1.0);
+	vec4 v1 = model * vec4(0.5, -0.5, 0.0, 1.0);
+	vec4 v2 = model * vec4(0.0, 0.5, 0.0, 1.0);
+	tri.geometry = createTriangle(v0.x, v0.y, v1.x, v1.y, v2.x, v2.y, tri.color);
+	Aabb2 box = {fminf(v0.x, fminf(v1.x, v2.x)), fminf(v0.y, fminf(v1.y, v2.y)),
+				 fmaxf(v0.x, fmaxf(v1.x, v2.x)), fmaxf(v0.y, fmaxf(v1.y, v2.y))};
+	tri.proxy = broadPhase.insert(box, triangles.size());
+	triangles.push_back(tri);
+	hitTest.add(v0.x, v0.y, v1.x, v1.y, v2.x, v2.y);
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
@@ -387,12 +399,30 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 		glfwGetCursorPos(window, &xpos, &ypos);
 		cout << xpos << "  " << ypos << endl;
 
-		Triangle tri;
-		tri.position = vec3(xpos,ypos,0.0);
-		tri.dimensions = vec3(100.0,100.0,1.0);
-		tri.color = vec3(colors[iColor].r, colors[iColor].g, colors[iColor].b);
-		iColor = (iColor + 1) % colors.size();
-		triangles.push_back(tri);
+		addTriangle(vec3(xpos,ypos,0.0), vec3(100.0,100.0,1.0));
+		redraw.invalidate();
 		
 	}
+	else if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
+	{
+		// remove o triângulo de cima (o último criado) sob o cursor
+		double xpos, ypos;
+		glfwGetCursorPos(window, &xpos, &ypos);
+		int i = -1;
+		broadPhase.queryPoint(xpos, ypos, [&](int candidate) {
+			if (candidate > i && hitTest.contains(candidate, xpos, ypos))
+			{
+				i = candidate;
+			}
+			return true;
+		});
+		if (i >= 0)
+		{
+			pool->release(triangles[i].geometry);
+			triangles[i].geometry = -1;
+			hitTest.remove(i);
+			broadPhase.remove(triangles[i].proxy);
+			redraw.invalidate();
+		}
+	}
 }
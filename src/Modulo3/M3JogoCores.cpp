@@ -30,6 +30,9 @@ using namespace glm;
 #include <cmath>
 #include <ctime>
 
+#include "ColorSimilarity.h"
+#include "Trace.h"
+
 // Protótipo da função de callback de teclado
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
@@ -44,7 +47,6 @@ void eliminarSimilares(float tolerancia);
 const GLuint WIDTH = 800, HEIGHT = 600;
 const GLuint ROWS = 6, COLS = 8;
 const GLuint QUAD_WIDTH = 100, QUAD_HEIGHT = 100;
-const float dMax = sqrt(3.0);
 
 // Código fonte do Vertex Shader (em GLSL): ainda hardcoded
 const GLchar *vertexShaderSource = R"(
@@ -87,6 +89,9 @@ int iSelected = -1;
 // Criação da grid de quadrados
 Quad grid[ROWS][COLS];
 
+// cores da grid em SoA (índice i * COLS + j), para eliminarSimilares
+ColorSimilarity similarity;
+
 // Função MAIN
 int main()
 {
@@ -140,6 +145,7 @@ int main()
 	GLuint VAO = createQuad();
 
 	// Inicializar a grid
+	similarity.resize(ROWS * COLS);
 	for (int i = 0; i < ROWS; i++)
 	{
 		for (int j = 0; j < COLS; j++)
@@ -155,6 +161,7 @@ int main()
 			quad.color = vec3(r, g, b);
 			quad.eliminated = false;
 			grid[i][j] = quad;
+			similarity.setColor(i * COLS + j, r, g, b);
 		}
 	}
 
@@ -180,8 +187,12 @@ int main()
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		TRACE_FRAME();
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
-		glfwPollEvents();
+		{
+			TRACE_ZONE("pollEvents");
+			glfwPollEvents();
+		}
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
@@ -222,7 +233,10 @@ int main()
 		glBindVertexArray(0); // Desconectando o buffer de geometria
 
 		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		{
+			TRACE_ZONE("swapBuffers");
+			glfwSwapBuffers(window);
+		}
 	}
 	// Pede pra OpenGL desalocar os buffers
 	// glDeleteVertexArrays(1, &VAO);
@@ -247,6 +261,7 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 //  A função retorna o identificador do programa de shader
 int setupShader()
 {
+	TRACE_ZONE("setupShader");
 	// Vertex shader
 	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
@@ -309,6 +324,7 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 
 GLuint createQuad()
 {
+	TRACE_ZONE("createQuad");
 	GLuint VAO;
 
 	GLfloat vertices[] = {
@@ -355,23 +371,12 @@ GLuint createQuad()
 
 void eliminarSimilares(float tolerancia)
 {
-	int x = iSelected % COLS;
-	int y = iSelected / COLS;
-	vec3 C = grid[y][x].color;
-	grid[y][x].eliminated = true;
-	for (int i = 0; i < ROWS; i++)
+	// distância ao quadrado contra tolerância ao quadrado, 8 cores por vez
+	vector<int> eliminados;
+	similarity.eliminateSimilar(iSelected, tolerancia, eliminados);
+	for (int indice : eliminados)
 	{
-		for (int j=0; j < COLS; j++)
-		{
-			vec3 O = grid[i][j].color;
-			float d = sqrt(pow(C.r-O.r,2) + pow(C.g-O.g,2) + pow(C.b-O.b,2));
-			float dd = d/dMax;
-			if (dd <= tolerancia)
-			{
-				grid[i][j].eliminated = true;
-			}
-
-		}
+		grid[indice / COLS][indice % COLS].eliminated = true;
 	}
 	iSelected = -1;
 }
@@ -4,12 +4,35 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <vector>
 #include "../../build/_deps/stb_image-src/stb_easy_font.h"
 
+// STB_IMAGE
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Layer.h"
+#include "JobSystem.h"
+#include "ParallaxCompositor.h"
+#include "Trace.h"
+
 const GLuint WIDTH = 800;
 const GLuint HEIGHT = 600;
 const char *WINDOW_TITLE = "Paralaxe - Vivencial - Módulo 4";
 
+const int LAYER_COUNT = 6;
+const float CAMERA_SPEED = 0.25f; // unidades de textura por segundo para ratex = 1
+
+// Com streaming, cada camada vira uma faixa de LEVEL_SEGMENTS cópias do PNG
+// (15360 px, mais que o GL_MAX_TEXTURE_SIZE de muitas placas) e só as páginas
+// perto da tela ficam na GPU. Sem streaming, cada camada é uma textura inteira.
+const bool STREAM_LAYERS = true;
+const int LEVEL_SEGMENTS = 8;
+const int PAGE_WIDTH = 256;
+const int PAGE_POOL = 96;
+
+JobSystem jobs;
+
 // initial setup (GLAD, GL hints and window configuration)
 void setupGlConfiguration()
 {
@@ -35,6 +58,7 @@ void setViewportDimensions(GLFWwindow *window)
 }
 void setupGlad()
 {
+    TRACE_ZONE("setupGlad");
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
@@ -70,6 +94,7 @@ GLFWwindow *makeWindow(GLuint width, GLuint height, const char *title)
 
 void initializeGlfw()
 {
+    TRACE_ZONE("initializeGlfw");
     if (!glfwInit())
     {
         std::cerr << "Falha ao inicializar GLFW" << std::endl;
@@ -124,137 +149,128 @@ void assertShaderCompilationStatus(GLuint shader)
     }
 }
 
-GLuint createShader(GLchar *shaderSource, GLenum shaderType)
-{
-    GLuint shader = glCreateShader(shaderType);
-    if (!shader)
-    {
-        std::cerr << "Erro ao criar shader" << std::endl;
-        exit(EXIT_FAILURE);
-    }
-
-    glShaderSource(shader, 1, &shaderSource, nullptr);
-    glCompileShader(shader);
-    checkOpenGLError("Shader Complilation");
-
-    assertShaderCompilationStatus(shader);
-    return shader;
-}
-
-void assertProgramLinkingStatus(GLuint shaderProgram)
+// callbacks
+void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
-    GLint success;
-    GLchar infoLog[512];
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << infoLog << std::endl;
-        exit(EXIT_FAILURE);
+        glfwSetWindowShouldClose(window, GL_TRUE);
     }
 }
 
-GLuint createShaderProgram()
-{
-    const GLuint vertexShader = createShader(R"(
-        #version 400 
-        layout(location = 0) in vec3 position;
-        uniform mat4 projection;
-        uniform mat4 model;
-        void main() {
-	        gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
-        }
-    )",
-                                             GL_VERTEX_SHADER);
-
-    const GLuint fragmentShader = createShader(R"(
-        #version 400
-        uniform vec4 inputColor;
-        out vec4 color;
-        void main() {
-            color = inputColor * vec4(1.0); // Ensure inputColor is used
-        }
-    )",
-                                               GL_FRAGMENT_SHADER);
-
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    checkOpenGLError("Shader Program Linking");
-    assertProgramLinkingStatus(shaderProgram);
-
-    std::cout << "Shader program criado e vinculado com sucesso!" << std::endl;
-    return shaderProgram;
-}
-
-// callbacks
-void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
+// camadas de assets/backgrounds/layers: 1.png é o fundo (opaco), 6.png a frente
+std::vector<Layer *> createLayers()
 {
-    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+    TRACE_ZONE("createLayers");
+    static char filenames[LAYER_COUNT][64];
+    const float rates[LAYER_COUNT] = {0.0f, 0.1f, 0.25f, 0.45f, 0.7f, 1.0f};
+    std::vector<Layer *> layers;
+    for (int i = 0; i < LAYER_COUNT; ++i)
     {
-        glfwSetWindowShouldClose(window, GL_TRUE);
+        snprintf(filenames[i], sizeof(filenames[i]), "../assets/backgrounds/layers/%d.png", i + 1);
+        Layer *layer = new Layer;
+        layer->filename = filenames[i];
+        layer->z = 0.0f;
+        layer->tid = 0;
+        layer->offsetx = 0.0f;
+        layer->offsety = 0.0f;
+        layer->ratex = rates[i];
+        layer->ratey = 0.0f;
+        layers.push_back(layer);
     }
+    return layers;
 }
 
 int main()
 {
-    std::cout << "Jogo das Cores - Módulo 3 - Leonardo Meinerz Ramos" << std::endl;
+    std::cout << "Paralaxe - Vivencial - Módulo 4" << std::endl;
 
     initializeGlfw();
     setupGlConfiguration();
 
     GLFWwindow *window = makeWindow(WIDTH, HEIGHT, WINDOW_TITLE);
-
-    GLuint shaderId = createShaderProgram();
-    glUseProgram(shaderId);
-
     glfwSetKeyCallback(window, keyCallback);
 
-    glm::mat4 projection = glm::ortho(0.0f, (float)WIDTH, (float)HEIGHT, 0.0f, -1.0f, 1.0f);
-    glUniformMatrix4fv(glGetUniformLocation(shaderId, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    std::cout << "Matriz de projeção definida!" << std::endl;
-
-    GLint colorLocation = glGetUniformLocation(shaderId, "inputColor");
-    checkOpenGLError("Uniform Location Retrieval");
-    if (colorLocation == -1)
+    std::vector<Layer *> layers = createLayers();
+    // no heap para serem destruídos antes do glfwTerminate (liberam objetos GL)
+    ParallaxCompositor *compositor = new ParallaxCompositor();
+    BackgroundStreamer *streamer = NULL;
+    bool loaded;
+    if (STREAM_LAYERS)
     {
-        std::cerr << "Erro: Uniform 'inputColor' não encontrado no shader!" << std::endl;
+        streamer = new BackgroundStreamer(&jobs, PAGE_WIDTH, PAGE_POOL);
+        for (size_t i = 0; i < layers.size(); ++i)
+        {
+            std::vector<std::string> segments(LEVEL_SEGMENTS, layers[i]->filename);
+            streamer->addStrip(segments);
+        }
+        loaded = streamer->getStripCount() == (int)layers.size() && streamer->createTextures() &&
+                 compositor->loadStreamed(streamer);
+    }
+    else
+    {
+        loaded = compositor->load(layers, &jobs);
+    }
+    if (!loaded)
+    {
+        glfwTerminate();
         exit(EXIT_FAILURE);
     }
+    checkOpenGLError("Carregamento das camadas");
+    std::cout << compositor->getLayerCount() << " camadas carregadas!" << std::endl;
+
+    float cameraX = 0.0f;
+    double previousTime = glfwGetTime();
 
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glLineWidth(10);
-        glPointSize(20);
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("pollEvents");
+            glfwPollEvents();
+        }
 
-        glm::mat4 model = glm::mat4(1);
-        // model = translate(model, currentRectangle.position);
-        // model = scale(model, currentRectangle.dimensions);
+        double now = glfwGetTime();
+        float dt = (float)(now - previousTime);
+        previousTime = now;
 
-        GLint modelLocation = glGetUniformLocation(shaderId, "model");
-        if (modelLocation == -1)
+        // setas movem a câmera; cada camada anda ratex vezes esse deslocamento
+        float cameraVelocity = 0.0f;
+        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        {
+            cameraVelocity += CAMERA_SPEED;
+        }
+        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
         {
-            std::cerr << "Erro: Uniform 'model' não encontrado no shader!" << std::endl;
-            exit(EXIT_FAILURE);
+            cameraVelocity -= CAMERA_SPEED;
         }
-        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+        cameraX += cameraVelocity * dt;
 
-        // glUniform4f(colorLocation, currentRectangle.color.r, currentRectangle.color.g, currentRectangle.color.b, 1.0f);
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
 
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        if (streamer != NULL)
+        {
+            // troca páginas e pré-carrega na direção do movimento
+            streamer->update(layers, cameraX, cameraVelocity, (float)width / (float)height);
+        }
 
-        glBindVertexArray(0);
+        // sem glClear: o compositor escreve todos os pixels
+        compositor->draw(layers, cameraX, 0.0f, width, height);
 
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
 
+    delete compositor;
+    delete streamer;
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+        delete layers[i];
+    }
     glfwTerminate();
     return 0;
-}
\ No newline at end of file
+}
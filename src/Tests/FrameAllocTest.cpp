@@ -0,0 +1,148 @@
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include "AllocTracker.h"
+#include "ColorSimilarity.h"
+#include "Entities.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "SpriteTransforms.h"
+#include "TileMap.h"
+
+// Teste de "zero alocações por quadro" (ctest -R frame_alloc).
+//
+// Roda, sem janela, o trabalho de CPU que os laços principais fazem a cada
+// quadro — instâncias de entidades montadas em paralelo em uma FrameArena,
+// movimento e colisão contra o TileMap, o lote de SpriteTransforms refeito e a
+// eliminação de cores do JogoDasCores — e falha se algum quadro depois do
+// aquecimento chamar o operator new. Precisa de PGCC_ALLOC_TRACKING: o
+// CMakelists.txt liga para este executável em qualquer build e, nas builds
+// Debug, para todos os programas do diretório (COMPILE_DEFINITIONS).
+//
+// Uso: FrameAllocTest [quadros]
+
+using namespace std;
+
+const int ENTITY_COUNT = 100000;
+const int ENTITY_GRAIN = 4096;
+const int MAP_SIZE = 256;
+const int SPRITE_COUNT = 256;
+const int COLOR_CELLS = 64 * 64;
+const int WARMUP_FRAMES = ALLOC_TRACKER_WARMUP - 1; // o quadro de verificação já conta no aquecimento
+
+void *volatile escaped; // impede o compilador de remover a alocação proposital
+
+unsigned int nextRandom(unsigned int &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 100;
+    if (!AllocTracker::enabled())
+    {
+        cerr << "FrameAllocTest precisa ser compilado com PGCC_ALLOC_TRACKING" << endl;
+        return 1;
+    }
+
+    // o próprio rastreador precisa enxergar uma alocação dentro do quadro
+    AllocTracker::beginFrame();
+    escaped = new int[4];
+    AllocFrameStats sanity = AllocTracker::endFrame();
+    delete[] (int *)escaped;
+    if (sanity.allocations == 0)
+    {
+        cerr << "alocação proposital não foi contada" << endl;
+        return 1;
+    }
+
+    JobSystem jobs;
+    FrameArena arena;
+
+    TileMap map(MAP_SIZE, MAP_SIZE, 0);
+    for (int row = 0; row < MAP_SIZE; row += 7)
+    {
+        for (int col = 0; col < MAP_SIZE; col += 5)
+        {
+            map.setTile(col, row, (col + row) % 3 == 0 ? 5 : 3);
+        }
+    }
+    map.setTileFlags(5, TILE_BLOCKED);
+    map.setTileFlags(3, TILE_HAZARD);
+
+    unsigned int seed = 12345;
+    EntityStore entities;
+    entities.reserve(ENTITY_COUNT);
+    for (int i = 0; i < ENTITY_COUNT; i++)
+    {
+        entities.create(nextRandom(seed) % MAP_SIZE, nextRandom(seed) % MAP_SIZE, 0, 0.0f);
+    }
+
+    SpriteTransforms sprites;
+    vector<float> packed(SPRITE_COUNT * SPRITE_TRANSFORM_FLOATS);
+
+    ColorSimilarity similarity;
+    similarity.resize(COLOR_CELLS);
+    for (int i = 0; i < COLOR_CELLS; i++)
+    {
+        similarity.setColor(i, (nextRandom(seed) % 256) / 255.0f, (nextRandom(seed) % 256) / 255.0f,
+                            (nextRandom(seed) % 256) / 255.0f);
+    }
+    similarity.buildIndex(16);
+    vector<int> eliminated;
+    eliminated.reserve(COLOR_CELLS);
+
+    int allocatingFrames = 0;
+    for (int frame = 0; frame < WARMUP_FRAMES + frames; frame++)
+    {
+        AllocTracker::beginFrame();
+        arena.reset();
+
+        for (int i = 0; i < ENTITY_COUNT; i++)
+        {
+            int step = nextRandom(seed) % 5;
+            entities.moveCol[i] = step == 1 ? 1 : step == 2 ? -1 : 0;
+            entities.moveRow[i] = step == 3 ? 1 : step == 4 ? -1 : 0;
+        }
+        jobs.parallelFor(0, ENTITY_COUNT, ENTITY_GRAIN, [&](int begin, int end)
+                         {
+                             moveEntities(entities, map, begin, end - begin);
+                             collideEntities(entities, map, begin, end - begin);
+                         });
+
+        EntityInstance *out = arena.allocate<EntityInstance>(ENTITY_COUNT);
+        jobs.parallelFor(0, ENTITY_COUNT, ENTITY_GRAIN, [&](int begin, int end)
+                         { buildEntityInstances(entities, 64.0f, 32.0f, 0.0f, 0.0f, begin, end - begin, out + begin); });
+
+        sprites.clear();
+        for (int i = 0; i < SPRITE_COUNT; i++)
+        {
+            sprites.add(i * 4.0f, frame * 2.0f, 32.0f, 32.0f, frame * 0.01f);
+        }
+        sprites.write(packed.data(), 0, sprites.size());
+
+        if (similarity.remaining() > 0)
+        {
+            similarity.eliminateSimilar(nextRandom(seed) % COLOR_CELLS, 0.1f, eliminated);
+        }
+        eliminated.clear();
+
+        // endFrame já avisa e lista os pontos de chamada
+        AllocFrameStats stats = AllocTracker::endFrame();
+        if (frame >= WARMUP_FRAMES && stats.allocations > 0)
+        {
+            allocatingFrames++;
+        }
+    }
+
+    if (allocatingFrames > 0)
+    {
+        cerr << allocatingFrames << " de " << frames << " quadros alocaram memória" << endl;
+        return 1;
+    }
+    cout << frames << " quadros sem alocações" << endl;
+    return 0;
+}
@@ -5,10 +5,26 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <fstream>
-#include <sstream>
 #include <stdexcept>
+#include <cstddef>
+
+#include "TileMap.h"
+#include "MapParser.h"
+#include "Entities.h"
+#include "AnimationClips.h"
+#include "JobSystem.h"
+#include "RedrawScheduler.h"
+#include "BufferArena.h"
+#include "SpriteTransforms.h"
+#include "Assets.h"
+#include "Trace.h"
+#include "GlStats.h"
+#include "InputReplay.h"
+#include "FrameArena.h"
+#include "AllocTracker.h"
+#include "TileMapTexture.h"
 
 // STB_IMAGE
 #define STB_IMAGE_IMPLEMENTATION
@@ -17,18 +33,78 @@
 const GLuint WIDTH = 800;
 const GLuint HEIGHT = 600;
 
-const int FPS = 12;
 const char *WINDOW_TITLE = "Vivencia M6";
 
-int playerX = 1;
-int playerY = 1;
 int mapWidth;
 int mapHeight;
 float playerSize = 1;
-std::vector<std::vector<int>> mapData;
+TileMap *mapData = NULL; // ids dos tiles, compactados (ver TileMap.h)
 std::vector<std::pair<int, int>> objectives; // pares de coordenadas com os objetivos que devem ser coletados
 int score = 0;
 
+// personagens: o jogador é a entidade 0, os inimigos vêm em seguida
+const int PLAYER = 0;
+const int ENEMY_COUNT = 12;
+const float ENEMY_STEP_INTERVAL = 0.6f; // segundos entre passos dos inimigos
+const int PLACE_ATTEMPTS = 64;          // sorteios antes de procurar tile seguro no mapa inteiro
+EntityStore entities;
+
+// tarefas em paralelo (decodificação de PNG, sistemas de entidades)
+JobSystem jobs;
+const int ENTITY_GRAIN = 4096; // entidades por tarefa: abaixo disso roda direto na thread do GLFW
+
+// dados que só valem durante um quadro (instâncias enviadas à GPU)
+FrameArena frameArena;
+
+// cenário: por padrão desenhado pela GPU a partir de uma textura de ids (um
+// quad só); PGCC_TILEMAP=instanced ou F8 voltam ao lote com um losango por tile
+bool gpuTileMap = true;
+
+// desenho sob demanda: teclas, passos dos inimigos e quadros de animação
+// sujam a cena; parado, o jogo redesenha só na cadência das animações
+RedrawScheduler redraw;
+InputReplay input; // PGCC_RECORD / PGCC_REPLAY (ver InputReplay.h)
+
+// malhas estáticas (tile, jogador, moeda, inimigos) em arenas compartilhados,
+// criados depois do contexto e destruídos antes do glfwTerminate
+const GLsizei MESH_VERTEX_BYTES = 8 * sizeof(GLfloat); // x y z r g b s t
+BufferArena *meshVertices = NULL;
+BufferArena *meshIndices = NULL;
+GLuint meshVAO;
+
+// clipes de animação (assets/animations/sprites.clips), avaliados no vertex shader
+AnimationClipTable clips;
+const int ENEMY_CLIP_VARIANTS = 12;
+int playerIdleClip, playerWalkClip;
+int enemyClips[ENEMY_CLIP_VARIANTS]; // uma linha de enemies-spritesheet1.png cada
+
+int findClip(const std::string &name)
+{
+    int id = clips.find(name);
+    if (id < 0)
+    {
+        std::cerr << "Clipe de animação não encontrado: " << name << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return id;
+}
+
+void loadAnimationClips()
+{
+    TRACE_ZONE("loadAnimationClips");
+    AssetView clipsFile = Assets::find("animations/sprites.clips");
+    if (!clipsFile.valid() || !clips.loadFromString(clipsFile.view(), "animations/sprites.clips"))
+    {
+        exit(EXIT_FAILURE);
+    }
+    playerIdleClip = findClip("jorge_idle");
+    playerWalkClip = findClip("jorge_walk");
+    for (int i = 0; i < ENEMY_CLIP_VARIANTS; ++i)
+    {
+        enemyClips[i] = findClip("enemy1_" + std::to_string(i));
+    }
+}
+
 // initial setup (GLAD, GL hints and window configuration)
 void setupGlConfiguration()
 {
@@ -44,25 +120,17 @@ void setupGlConfiguration()
     std::cout << "Configuração do OpenGL definida com sucesso!" << std::endl;
 }
 
-std::string lerArquivoParaString(const std::string &caminhoArquivo)
+// conteúdo de um asset de texto: embutido no executável (ver common/Assets.h)
+// ou lido de assets/ nas builds com PGCC_EMBED_ASSETS=OFF; a visão não copia
+// e vale até o fim do programa
+std::string_view lerAsset(const std::string &nome)
 {
-    try
-    {
-        std::ifstream arquivo(caminhoArquivo);
-        if (!arquivo.is_open())
-        {
-            throw std::runtime_error("Não foi possível abrir o arquivo: " + caminhoArquivo);
-        }
-
-        std::ostringstream conteudoStream;
-        conteudoStream << arquivo.rdbuf(); // Lê todo o conteúdo do arquivo
-        return conteudoStream.str();
-    }
-    catch (const std::exception &e)
+    AssetView asset = Assets::find(nome);
+    if (!asset.valid())
     {
-        std::cerr << "Erro ao ler o arquivo: " << e.what() << std::endl;
-        throw;
+        throw std::runtime_error("Não foi possível carregar o asset: " + nome);
     }
+    return asset.view();
 }
 
 void setViewportDimensions(GLFWwindow *window)
@@ -80,6 +148,7 @@ void setupGlad()
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
         exit(EXIT_FAILURE);
     }
+    GlStats::initFromEnvironment(); // PGCC_GL_STATS=<quadros>
 
     std::cout << "GLAD inicializado com sucesso!" << std::endl;
 }
@@ -197,7 +266,8 @@ void assertProgramLinkingStatus(GLuint shaderProgram)
 
 GLuint createPlayerShaderProgram()
 {
-    const GLuint vertexShader = createShader(R"(#version 400
+    TRACE_ZONE("createPlayerShaderProgram");
+    const std::string vertexSource = "#version 400\n" + AnimationClipTable::glsl() + R"(
         layout (location = 0) in vec3 position;
         layout (location = 1) in vec3 colors;
         layout (location = 2) in vec2 texture_mapping;
@@ -208,20 +278,18 @@ GLuint createPlayerShaderProgram()
         uniform mat4 projection;
         uniform mat4 model;
         
-        uniform ivec2 sheetSize;   
-        uniform int frameIndex;
+        uniform int clip;
+        uniform int direction;
+        uniform float clipStart;
         
         void main()
         {
-            int column = frameIndex % sheetSize.x;
-            int row    = frameIndex / sheetSize.x;
-            vec2 cellSize = vec2(1.0) / vec2(sheetSize);
-            vec2 frameOffset = vec2(column, row) * cellSize;
-            texture_coordinates = texture_mapping * cellSize + frameOffset;
+            vec4 cell = clipRect(clip, direction, clipStart);
+            texture_coordinates = texture_mapping * cell.zw + cell.xy;
             color_values = colors;
             gl_Position = projection * model * vec4(position, 1.0);
-        })",
-                                             GL_VERTEX_SHADER);
+        })";
+    const GLuint vertexShader = createShader(vertexSource.c_str(), GL_VERTEX_SHADER);
 
     const GLuint fragmentShader = createShader(R"(#version 400
         in vec2 texture_coordinates;
@@ -251,22 +319,28 @@ GLuint createPlayerShaderProgram()
 
 GLuint createTileShaderProgram()
 {
+    TRACE_ZONE("createTileShaderProgram");
     const GLuint vertexShader = createShader(R"(
         #version 400
         layout (location = 0) in vec3 position;
         layout (location = 1) in vec3 color;
         layout (location = 2) in vec2 texc;
+        layout (location = 3) in vec2 axisX;  // transformação compacta da instância
+        layout (location = 4) in vec2 axisY;  // (ver SpriteTransforms.h)
+        layout (location = 5) in vec2 offset;
+        layout (location = 6) in int frame;   // coluna no tileset
         out vec3 vColor;
         out vec2 tex_coord;
 
         uniform mat4 projection;
-        uniform mat4 model;
-        uniform int frameIndex;
+        uniform int highlight;                // instância sob o jogador (-1 = nenhuma)
         void main()
         {
             vColor = color;
+            int frameIndex = gl_InstanceID == highlight ? 6 : frame;
             tex_coord = vec2(texc.x + float(frameIndex) * 0.142857, texc.y);
-            gl_Position = projection * model * vec4(position, 1.0);
+            vec2 world = axisX * position.x + axisY * position.y + offset;
+            gl_Position = projection * vec4(world, position.z, 1.0);
         }
         )",
                                              GL_VERTEX_SHADER);
@@ -295,15 +369,106 @@ GLuint createTileShaderProgram()
     return shaderProgram;
 }
 
-double currentTime;
-double lastTime = 0.0;
-int currentPlayerFrameIndex = 0;
-bool isWalking = false;
-int DOWN = 0;
-int LEFT = 1;
-int RIGHT = 2;
-int UP = 3;
-int walkinDirection;
+// cenário pela GPU: um quad do tamanho do mapa; cada pixel acha o próprio
+// tile na textura de ids (ver TileMapTexture.h) e amostra o tileset
+GLuint createTileMapShaderProgram()
+{
+    TRACE_ZONE("createTileMapShaderProgram");
+    const GLuint vertexShader = createShader(R"(
+        #version 400
+        layout (location = 0) in vec3 position;
+        out vec2 screen;
+
+        uniform mat4 projection;
+        uniform vec4 mapBounds; // x, y, largura, altura do quad na tela
+        void main()
+        {
+            screen = mapBounds.xy + position.xy * mapBounds.zw;
+            gl_Position = projection * vec4(screen, 0.0, 1.0);
+        }
+        )",
+                                             GL_VERTEX_SHADER);
+
+    const std::string fragmentSource = "#version 400\n" + TileMapTexture::glsl() + R"(
+        in vec2 screen;
+        out vec4 color;
+
+        uniform sampler2D tileset;
+        uniform ivec2 highlight; // (coluna, linha) do tile sob o jogador
+        void main()
+        {
+            ivec2 tile;
+            uint id;
+            vec2 local;
+            if (!isoTileAt(screen, tile, id, local))
+            {
+                discard;
+            }
+            float frame = tile == highlight ? 6.0 : float(id);
+            color = texture(tileset, vec2((frame + local.x) * 0.142857, local.y));
+        })";
+    const GLuint fragmentShader = createShader(fragmentSource.c_str(), GL_FRAGMENT_SHADER);
+
+    GLuint shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+    glLinkProgram(shaderProgram);
+    checkOpenGLError("Shader Program Linking");
+    assertProgramLinkingStatus(shaderProgram);
+
+    std::cout << "Shader program criado e vinculado com sucesso!" << std::endl;
+    return shaderProgram;
+}
+
+// inimigos: um único draw instanciado; cada instância traz posição na tela e
+// o estado da animação (ver EntityInstance em Entities.h)
+GLuint createEnemyShaderProgram()
+{
+    TRACE_ZONE("createEnemyShaderProgram");
+    const std::string vertexSource = "#version 400\n" + AnimationClipTable::glsl() + R"(
+        layout (location = 0) in vec3 position;
+        layout (location = 2) in vec2 texture_mapping;
+        layout (location = 3) in vec3 instance;       // x, y, início do clipe
+        layout (location = 4) in uvec2 instanceClip;  // clipe, direção
+
+        out vec2 texture_coordinates;
+
+        uniform mat4 projection;
+        uniform vec2 spriteSize;
+        uniform vec2 spriteOffset;
+
+        void main()
+        {
+            vec4 cell = clipRect(int(instanceClip.x), int(instanceClip.y), instance.z);
+            texture_coordinates = texture_mapping * cell.zw + cell.xy;
+            gl_Position = projection * vec4(position.xy * spriteSize + instance.xy + spriteOffset, 0.0, 1.0);
+        })";
+    const GLuint vertexShader = createShader(vertexSource.c_str(), GL_VERTEX_SHADER);
+
+    const GLuint fragmentShader = createShader(R"(#version 400
+        in vec2 texture_coordinates;
+        out vec4 color;
+
+        uniform sampler2D spriteTexture;
+
+        void main()
+        {
+            color = texture(spriteTexture, texture_coordinates);
+        }
+        )",
+                                               GL_FRAGMENT_SHADER);
+
+    GLuint shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+    glLinkProgram(shaderProgram);
+    checkOpenGLError("Shader Program Linking");
+    assertProgramLinkingStatus(shaderProgram);
+
+    std::cout << "Shader program criado e vinculado com sucesso!" << std::endl;
+    return shaderProgram;
+}
+
 GLFWwindow *window;
 
 void gameOver()
@@ -319,9 +484,24 @@ void gameWon()
     glfwSetWindowShouldClose(window, GLFW_TRUE);
 }
 
+// mapData guarda (coluna, linha); o jogo indexa por (linha, coluna)
+int tileAt(int x, int y)
+{
+    return mapData->getTile(y, x);
+}
+
+// pede um passo de (dx linhas, dy colunas) para o jogador; o sistema de
+// movimento checa o bitboard de mapData e atualiza a direção da animação
+void tryWalk(int dx, int dy)
+{
+    entities.moveRow[PLAYER] = dx;
+    entities.moveCol[PLAYER] = dy;
+    moveEntities(entities, *mapData, PLAYER, 1);
+}
+
 void resetWalkingAnimation()
 {
-    isWalking = false;
+    entities.playClip(PLAYER, playerIdleClip, (float)input.now());
 }
 // callbacks
 void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
@@ -330,79 +510,59 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
     {
         glfwSetWindowShouldClose(window, GL_TRUE);
     }
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+    {
+        TRACE_DUMP("pgcc_trace.json"); // só nas builds com PGCC_TRACE
+    }
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+    {
+        GlStats::toggle();
+    }
+    if (key == GLFW_KEY_F8 && action == GLFW_PRESS)
+    {
+        gpuTileMap = !gpuTileMap;
+        std::cout << "Cenário: " << (gpuTileMap ? "textura de ids (GPU)" : "lote instanciado") << std::endl;
+    }
 
+    redraw.invalidate();
     if (action == GLFW_RELEASE)
     {
         resetWalkingAnimation();
     }
     if (action == GLFW_PRESS)
     {
-        isWalking = true;
+        entities.playClip(PLAYER, playerWalkClip, (float)input.now());
         switch (key)
         {
         case GLFW_KEY_W:
-            if (playerX > 0 && playerY > 0 && mapData.at(playerX - 1).at(playerY - 1) != 5)
-            {
-                playerX--;
-                playerY--;
-            }
-            walkinDirection = UP;
+            tryWalk(-1, -1);
             break;
         case GLFW_KEY_X: // down
-            if (playerX < mapWidth - 1 && playerY < mapHeight - 1 && mapData.at(playerX + 1).at(playerY + 1) != 5)
-            {
-                playerX++;
-                playerY++;
-            }
-            walkinDirection = DOWN;
+            tryWalk(1, 1);
             break;
         case GLFW_KEY_A: // left
-            if (playerX < mapWidth - 1 && playerY > 0 && mapData.at(playerX + 1).at(playerY - 1) != 5)
-            {
-                playerX++;
-                playerY--;
-            }
-            walkinDirection = LEFT;
+            tryWalk(1, -1);
             break;
         case GLFW_KEY_D: // right
-            if (playerX > 0 && playerY < mapHeight - 1 && mapData.at(playerX - 1).at(playerY + 1) != 5)
-            {
-                playerX--;
-                playerY++;
-            }
-            walkinDirection = RIGHT;
+            tryWalk(-1, 1);
             break;
         case GLFW_KEY_Q: // up-left
-
-            if (playerY > 0 && mapData.at(playerX).at(playerY - 1) != 5)
-                playerY--;
-            walkinDirection = UP;
+            tryWalk(0, -1);
             break;
         case GLFW_KEY_E: // up-right
-
-            if (playerX > 0 && mapData.at(playerX - 1).at(playerY) != 5)
-            {
-                playerX--;
-            }
-
-            walkinDirection = UP;
+            tryWalk(-1, 0);
             break;
         case GLFW_KEY_Z: // down-left
-            if (playerX < mapWidth - 1 && mapData.at(playerX + 1).at(playerY) != 5)
-                playerX++;
-
-            walkinDirection = DOWN;
+            tryWalk(1, 0);
             break;
         case GLFW_KEY_C: // down-right
-
-            if (playerY < mapHeight - 1 && mapData.at(playerX).at(playerY + 1) != 5)
-                playerY++;
-
-            walkinDirection = DOWN;
+            tryWalk(0, 1);
             break;
         default:
             break;
         }
+        int playerX = entities.row[PLAYER];
+        int playerY = entities.col[PLAYER];
         for (int i = 0; i < objectives.size(); ++i)
         {
             if (playerX == objectives[i].first && playerY == objectives[i].second)
@@ -417,15 +577,45 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
                 break;
             }
         }
-        if (mapData.at(playerX).at(playerY) == 3)
+        if (collideEntities(entities, *mapData, PLAYER, 1) > 0)
         {
             gameOver();
         }
     }
 }
 
-int loadTexture(std::string filePath)
+// imagem decodificada pelo stb_image; não usa OpenGL, então pode rodar em
+// qualquer thread do JobSystem
+struct DecodedImage
+{
+    std::string assetName;
+    unsigned char *data;
+    int width, height, nrChannels;
+};
+
+// tarefa: decodifica images[begin..end)
+void decodeImages(void *images, int begin, int end)
+{
+    TRACE_ZONE("decodeImages");
+    DecodedImage *image = (DecodedImage *)images;
+    for (int i = begin; i < end; ++i)
+    {
+        // o PNG vem da memória (asset embutido), sem abrir arquivo
+        AssetView png = Assets::find(image[i].assetName);
+        if (!png.valid())
+        {
+            image[i].data = NULL;
+            continue;
+        }
+        image[i].data = stbi_load_from_memory(png.data, (int)png.size, &image[i].width, &image[i].height,
+                                              &image[i].nrChannels, 0);
+    }
+}
+
+// envia a imagem já decodificada para a GPU (apenas na thread do contexto GL)
+GLuint uploadTexture(DecodedImage &image)
 {
+    TRACE_ZONE("uploadTexture");
     GLuint texID;
 
     // Gera o identificador da textura na mem�ria
@@ -438,28 +628,25 @@ int loadTexture(std::string filePath)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    int width, height, nrChannels;
-
-    unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data)
+    if (image.data)
     {
-        if (nrChannels == 3) // jpg, bmp
+        if (image.nrChannels == 3) // jpg, bmp
         {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data);
         }
         else // png
         {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data);
         }
         glGenerateMipmap(GL_TEXTURE_2D);
     }
     else
     {
-        std::cout << "Failed to load texture" << std::endl;
+        std::cout << "Failed to load texture " << image.assetName << std::endl;
     }
 
-    stbi_image_free(data);
+    stbi_image_free(image.data);
+    image.data = NULL;
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -475,9 +662,27 @@ GLfloat calcIsoY(float x, float y)
     return (x + y) / 2;
 }
 
-GLuint setupPlayerVAO()
+// malha dentro dos buffers compartilhados: handles nos arenas de vértices e
+// de índices, resolvidos para offsets na hora de desenhar
+struct Mesh
+{
+    int vertices;
+    int indices;
+    GLsizei indexCount;
+};
+
+Mesh createMesh(const GLfloat *vertices, GLsizei vertexCount, const GLuint *indices, GLsizei indexCount)
 {
+    Mesh mesh;
+    mesh.vertices = meshVertices->allocate(vertices, vertexCount * MESH_VERTEX_BYTES, MESH_VERTEX_BYTES);
+    mesh.indices = meshIndices->allocate(indices, indexCount * sizeof(GLuint), sizeof(GLuint));
+    mesh.indexCount = indexCount;
+    return mesh;
+}
 
+// quad unitário usado pelo jogador, pela moeda e pelos inimigos
+Mesh setupQuadMesh()
+{
     GLfloat vertices[] = {
         // x      y      z      r    g    b      s           t
         // T0
@@ -487,131 +692,103 @@ GLuint setupPlayerVAO()
         1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, //
     };
 
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    unsigned int indices[] = {
-        0, 1, 2, // Primeiro tri�ngulo
-        1, 2, 3  // Segundo tri�ngulo
+    GLuint indices[] = {
+        0, 1, 2, // Primeiro triângulo
+        1, 2, 3  // Segundo triângulo
     };
 
-    GLuint EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    glBindVertexArray(0);
-    return VAO;
+    return createMesh(vertices, 4, indices, 6);
 }
 
-GLuint setupKeyVAO()
+Mesh setupTileMesh()
 {
     GLfloat vertices[] = {
         // x      y      z      r    g    b      s           t
         // T0
-        0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, //
-        0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, //
-        1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, //
-        1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, //
+        0.0, 0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.5,        //
+        0.5, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 / 14.0, 1.0, //
+        1.0, 0.5, 0.0, 0.0, 0.0, 0.0, 1.0 / 7.0, 0.5,  //
+        0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0 / 14.0, 0.0, //
     };
 
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    GLuint indices[] = {
+        0, 1, 2, // Primeiro triângulo
+        0, 2, 3  // Segundo triângulo
+    };
+
+    return createMesh(vertices, 4, indices, 6);
+}
 
+// VAO das malhas estáticas: aponta o início dos arenas e cada malha é
+// desenhada com o offset dos índices e o baseVertex dela. Criar depois das
+// malhas: se um arena crescer, o buffer muda e o VAO precisa ser refeito.
+GLuint setupMeshVAO()
+{
+    GLuint VAO;
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)0);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVertices->buffer());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)0);
     glEnableVertexAttribArray(0);
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)(3 * sizeof(GLfloat)));
     glEnableVertexAttribArray(1);
 
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)(6 * sizeof(GLfloat)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)(6 * sizeof(GLfloat)));
     glEnableVertexAttribArray(2);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    unsigned int indices[] = {
-        0, 1, 2, // Primeiro tri�ngulo
-        1, 2, 3  // Segundo tri�ngulo
-    };
-
-    GLuint EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIndices->buffer());
 
     glBindVertexArray(0);
     return VAO;
 }
-int setupTileVAO()
-{
-
-    GLfloat vertices[] = {
-        // x      y      z      r    g    b      s           t
-        // T0
-        0.0, 0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.5,        //
-        0.5, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 / 14.0, 1.0, //
-        1.0, 0.5, 0.0, 0.0, 0.0, 0.0, 1.0 / 7.0, 0.5,  //
-        0.5, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0 / 14.0, 0.0, //
-    };
-
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
+// malhas dos arenas + buffer de instâncias (atributo 3, um EntityInstance por inimigo)
+GLuint setupEnemyVAO(GLuint &instanceVBO)
+{
+    GLuint VAO;
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)0);
+    glBindBuffer(GL_ARRAY_BUFFER, meshVertices->buffer());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)0);
     glEnableVertexAttribArray(0);
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid *)(6 * sizeof(GLfloat)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)(6 * sizeof(GLfloat)));
     glEnableVertexAttribArray(2);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    unsigned int indices[] = {
-        0, 1, 2, // Primeiro tri�ngulo
-        0, 2, 3  // Segundo tri�ngulo
-    };
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(EntityInstance), (GLvoid *)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribIPointer(4, 2, GL_UNSIGNED_SHORT, sizeof(EntityInstance), (GLvoid *)offsetof(EntityInstance, clip));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
 
-    GLuint EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIndices->buffer());
 
     glBindVertexArray(0);
     return VAO;
 }
 
+const GLvoid *indexOffset(const Mesh &mesh)
+{
+    return (const GLvoid *)meshIndices->offset(mesh.indices);
+}
+
+GLint baseVertex(const Mesh &mesh)
+{
+    return (GLint)(meshVertices->offset(mesh.vertices) / MESH_VERTEX_BYTES);
+}
+
 struct Sprite
 {
-    GLuint VAO;
+    Mesh mesh;
     GLuint textureId;
     GLuint shaderId;
     glm::vec3 translate;
@@ -619,205 +796,443 @@ struct Sprite
     int frameIndex;
 };
 
-bool isPlayerPosition(int x, int y)
+// tiles (ou moedas) desenhados em um draw instanciado: as transformações
+// ficam em SoA e vão para a GPU na forma afim compacta, só quando mudam
+struct TileBatch
+{
+    SpriteTransforms transforms;
+    std::vector<GLint> frames; // coluna do tileset por instância
+    GLuint VAO, transformVBO, frameVBO;
+    bool framesDirty;
+};
+
+void setupTileBatch(TileBatch &batch)
+{
+    glGenVertexArrays(1, &batch.VAO);
+    glBindVertexArray(batch.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, meshVertices->buffer());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, MESH_VERTEX_BYTES, (GLvoid *)(6 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+
+    glGenBuffers(1, &batch.transformVBO);
+    SpriteTransforms::setupAttributes(batch.transformVBO, 3);
+
+    glGenBuffers(1, &batch.frameVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.frameVBO);
+    glVertexAttribIPointer(6, 1, GL_INT, sizeof(GLint), (GLvoid *)0);
+    glEnableVertexAttribArray(6);
+    glVertexAttribDivisor(6, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIndices->buffer());
+
+    glBindVertexArray(0);
+    batch.framesDirty = true;
+}
+
+void addTile(TileBatch &batch, float x, float y, float tileW, float tileH, int frame)
 {
-    return (x == playerX && y == playerY);
+    batch.transforms.add(x, y, tileW, tileH);
+    batch.frames.push_back(frame);
+    batch.framesDirty = true;
 }
 
-void drawTiles(const Sprite &sprite, int x, int y)
+// `highlight`: instância desenhada com o quadro 6 (tile sob o jogador), -1 = nenhuma;
+// `highlightLocation` é o uniform highlight de shaderId, buscado uma vez no main
+void drawTiles(TileBatch &batch, const Mesh &mesh, GLuint shaderId, GLint highlightLocation, GLuint textureId,
+               int highlight)
 {
-    glUseProgram(sprite.shaderId);
+    TRACE_ZONE("drawTiles");
+    int count = batch.transforms.size();
+    if (count == 0)
+    {
+        return;
+    }
+    batch.transforms.upload(batch.transformVBO);
+    if (batch.framesDirty)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, batch.frameVBO);
+        glBufferData(GL_ARRAY_BUFFER, batch.frames.size() * sizeof(GLint), batch.frames.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        batch.framesDirty = false;
+    }
+
+    glUseProgram(shaderId);
     glEnable(GL_BLEND);
 
-    glBindTexture(GL_TEXTURE_2D, sprite.textureId);
-    glBindVertexArray(sprite.VAO);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glBindVertexArray(batch.VAO);
 
-    glm::mat4 model = glm::mat4(1.0f);
+    glUniform1i(highlightLocation, highlight);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, indexOffset(mesh), count,
+                                      baseVertex(mesh));
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    model = glm::translate(model, sprite.translate);
-    model = glm::scale(model, sprite.scale);
+// o mapa inteiro no lote, na ordem em que o highlight de drawTiles espera:
+// a instância i * mapWidth + j é o tile da linha i, coluna j
+void addMapTiles(TileBatch &batch, float tileW, float tileH, float originX, float originY)
+{
+    for (int i = 0; i < mapHeight; ++i)
+    {
+        for (int j = 0; j < mapWidth; ++j)
+        {
+            float x = (j - i) * (tileW / 2.0f);
+            float y = (i + j) * (tileH / 2.0f);
+            addTile(batch, x + originX, y + originY, tileW, tileH, tileAt(i, j));
+        }
+    }
+}
 
-    glUniformMatrix4fv(glGetUniformLocation(sprite.shaderId, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    int frameIndex = isPlayerPosition(x, y) ? 6 : sprite.frameIndex;
+// cenário inteiro em um draw (ver createTileMapShaderProgram); o tile
+// (highlightCol, highlightRow) sai com o quadro 6; `highlightLocation` é o
+// uniform highlight de shaderId, buscado uma vez no main
+void drawTileMap(const TileMapTexture &tileMap, const Mesh &quad, GLuint shaderId, GLint highlightLocation,
+                 GLuint tilesetTextureId, int highlightCol, int highlightRow)
+{
+    TRACE_ZONE("drawTileMap");
+    glUseProgram(shaderId);
+    glEnable(GL_BLEND);
 
-    glUniform1i(glGetUniformLocation(sprite.shaderId, "frameIndex"), frameIndex);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    tileMap.bind(GL_TEXTURE1);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tilesetTextureId);
+    glBindVertexArray(meshVAO);
+
+    glUniform2i(highlightLocation, highlightCol, highlightRow);
+    glDrawElementsBaseVertex(GL_TRIANGLES, quad.indexCount, GL_UNSIGNED_INT, indexOffset(quad), baseVertex(quad));
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void deleteTileBatch(TileBatch &batch)
+{
+    glDeleteBuffers(1, &batch.transformVBO);
+    glDeleteBuffers(1, &batch.frameVBO);
+    glDeleteVertexArrays(1, &batch.VAO);
 }
 
 void drawPlayer(const Sprite &sprite)
 {
+    TRACE_ZONE("drawPlayer");
     glUseProgram(sprite.shaderId);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glBindTexture(GL_TEXTURE_2D, sprite.textureId);
-    glBindVertexArray(sprite.VAO);
+    glBindVertexArray(meshVAO);
 
     glm::mat4 model = glm::mat4(1.0f);
     float tileW = WIDTH / mapWidth;
     float tileH = tileW / 2.0f;
     float sobraAltura = WIDTH - (HEIGHT / 2.0f);
 
-    float x = (playerY - playerX) * (tileW / 2.0f);
-    float y = (playerY + playerX) * (tileH / 2.0f);
+    float x = (entities.col[PLAYER] - entities.row[PLAYER]) * (tileW / 2.0f);
+    float y = (entities.col[PLAYER] + entities.row[PLAYER]) * (tileH / 2.0f);
     glm::vec3 playerPos = glm::vec3(x + WIDTH / 2 - tileW / 1.8, y + playerSize * 1.5, 0.0f); // Precisa ser corrigido de acordo com o tamanho dos tiles.
 
     model = glm::translate(model, playerPos);
     model = glm::scale(model, sprite.scale);
 
     glUniformMatrix4fv(glGetUniformLocation(sprite.shaderId, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniform2i(glGetUniformLocation(sprite.shaderId, "sheetSize"), 6, 4);
-    glUniform1i(glGetUniformLocation(sprite.shaderId, "frameIndex"), currentPlayerFrameIndex); 
+    glUniform1i(glGetUniformLocation(sprite.shaderId, "clip"), entities.clip[PLAYER]);
+    glUniform1i(glGetUniformLocation(sprite.shaderId, "direction"), entities.direction[PLAYER]);
+    glUniform1f(glGetUniformLocation(sprite.shaderId, "clipStart"), entities.clipStart[PLAYER]);
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glDrawElementsBaseVertex(GL_TRIANGLES, sprite.mesh.indexCount, GL_UNSIGNED_INT, indexOffset(sprite.mesh),
+                             baseVertex(sprite.mesh));
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
-    currentTime = glfwGetTime();
-    if (isWalking && currentTime - lastTime >= 1.0 / FPS)
-    {
-        currentPlayerFrameIndex = (currentPlayerFrameIndex + 1) % 6 + walkinDirection * 6;
-        lastTime = currentTime;
-    }
 }
 
-std::vector<std::string> split(const std::string &texto, char delimitador)
+bool isSafeTile(int col, int row)
 {
-    std::vector<std::string> partes;
-    std::stringstream ss(texto);
-    std::string item;
+    return mapData->isWalkable(col, row) && !mapData->isHazard(col, row) &&
+           !(col == entities.col[PLAYER] && row == entities.row[PLAYER]);
+}
 
-    while (std::getline(ss, item, delimitador))
+// sorteia um tile caminhável, fora da lava e longe do jogador. Depois de
+// PLACE_ATTEMPTS sorteios percorre o mapa a partir de um tile sorteado;
+// false (entidade não muda) se nenhum tile é seguro
+bool placeOnRandomSafeTile(int id)
+{
+    int tiles = mapWidth * mapHeight;
+    int tile = rand() % tiles;
+    for (int attempt = 0; attempt < PLACE_ATTEMPTS && !isSafeTile(tile % mapWidth, tile / mapWidth); ++attempt)
     {
-        partes.push_back(item);
+        tile = rand() % tiles;
     }
-
-    return partes;
+    for (int i = 0; i < tiles && !isSafeTile(tile % mapWidth, tile / mapWidth); ++i)
+    {
+        tile = (tile + 1) % tiles;
+    }
+    if (!isSafeTile(tile % mapWidth, tile / mapWidth))
+    {
+        return false;
+    }
+    entities.col[id] = tile % mapWidth;
+    entities.row[id] = tile / mapWidth;
+    return true;
 }
 
-std::vector<int> extrairValores(const std::string &linha)
+// intervalo até o próximo quadro das animações em andamento (0 = nada anima)
+double animationInterval()
 {
-    std::vector<int> valores;
-    std::vector<std::string> partes = split(linha, ' ');
-
-    for (const std::string &parte : partes)
+    float fps = 0.0f;
+    for (int i = 0; i < entities.size(); ++i)
     {
-        try
+        const AnimationClip &clip = clips.get(entities.clip[i]);
+        if (clip.frameCount > 1 && clip.fps > fps)
         {
-            valores.push_back(std::stoi(parte));
+            fps = clip.fps;
         }
-        catch (const std::invalid_argument &)
+    }
+    return fps > 0.0f ? 1.0 / fps : 0.0;
+}
+
+void spawnEnemies(int count)
+{
+    entities.reserve(entities.size() + count);
+    for (int i = 0; i < count; ++i)
+    {
+        // início sorteado para que os inimigos não animem em sincronia
+        int id = entities.create(0, 0, enemyClips[i % ENEMY_CLIP_VARIANTS], -(rand() % 1000) / 1000.0f);
+        if (!placeOnRandomSafeTile(id))
         {
+            std::cerr << "Nenhum tile seguro no mapa para os inimigos" << std::endl;
+            entities.destroy(id);
+            return;
         }
     }
-
-    return valores;
 }
 
-void loadMap()
+// cada inimigo tenta um passo aleatório; quem cai na lava renasce em outro tile
+void wanderEnemies()
 {
-
-    std::string arquivo = lerArquivoParaString("../assets/maps/map15x15.txt");
-    std::cout << "Conteúdo do arquivo lido: " << arquivo << std::endl;
-    std::vector<std::string> linhas = split(arquivo, '\n');
-    std::vector<int> tamanhoMapa = extrairValores(linhas[0]);
-
-    std::cout << "Tamanho do mapa: " << tamanhoMapa[0] << "x" << tamanhoMapa[1] << std::endl;
-    mapWidth = tamanhoMapa[0];
-    mapHeight = tamanhoMapa[1];
-    playerSize = (float)1000 / mapWidth;
-
-    mapData.resize(mapHeight, std::vector<int>(mapWidth, 0));
-    for (int i = 1; i < linhas.size(); ++i)
+    TRACE_ZONE("wanderEnemies");
+    int first = PLAYER + 1;
+    int count = entities.size() - first;
+    for (int i = first; i < first + count; ++i)
     {
-        std::vector<int> valoresLinha = extrairValores(linhas[i]);
-        if (valoresLinha.size() == mapWidth)
+        entities.moveCol[i] = rand() % 3 - 1;
+        entities.moveRow[i] = rand() % 3 - 1;
+    }
+    moveEntities(entities, *mapData, first, count);
+    if (collideEntities(entities, *mapData, first, count) > 0)
+    {
+        for (int i = first; i < first + count; ++i)
         {
-            for (int j = 0; j < mapWidth; ++j)
+            // sem tile seguro o inimigo fica onde caiu
+            if (entities.onHazard[i])
             {
-                mapData[i - 1][j] = valoresLinha[j];
+                placeOnRandomSafeTile(i);
             }
         }
     }
+}
 
-    arquivo = lerArquivoParaString("../assets/maps/objective_positions.txt");
-    linhas = split(arquivo, '\n');
-    for (const std::string &linha : linhas)
+void drawEnemies(GLuint shaderId, GLuint VAO, const Mesh &mesh, GLuint instanceVBO, GLuint textureId,
+                 float tileW, float tileH, float originX, float originY)
+{
+    TRACE_ZONE("drawEnemies");
+    int first = PLAYER + 1;
+    int count = entities.size() - first;
+    if (count <= 0)
     {
-        std::vector<int> valoresLinha = extrairValores(linha);
-        if (valoresLinha.size() >= 2)
-        {
-            objectives.push_back(std::make_pair(valoresLinha[0], valoresLinha[1]));
-        }
+        return;
     }
+    EntityInstance *out = frameArena.allocate<EntityInstance>(count);
+    jobs.parallelFor(first, first + count, ENTITY_GRAIN, [&](int begin, int end)
+                     { buildEntityInstances(entities, tileW, tileH, originX, originY, begin, end - begin, out + (begin - first)); });
+
+    glUseProgram(shaderId);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(EntityInstance), out, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUniform2f(glGetUniformLocation(shaderId, "spriteSize"), tileW / 2.0f, tileW / 2.0f);
+    glUniform2f(glGetUniformLocation(shaderId, "spriteOffset"), tileW / 4.0f, -tileH / 4.0f);
+
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, indexOffset(mesh), count,
+                                      baseVertex(mesh));
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void loadMap()
+{
+    TRACE_ZONE("loadMap");
+    std::string_view arquivo = lerAsset("maps/map15x15.txt");
+    std::cout << "Conteúdo do arquivo lido: " << arquivo << std::endl;
+    mapData = parseMap(arquivo, mapWidth, mapHeight);
+    std::cout << "Tamanho do mapa: " << mapWidth << "x" << mapHeight << std::endl;
+    playerSize = (float)1000 / mapWidth;
+
+    mapData->setTileFlags(5, TILE_BLOCKED); // água
+    mapData->setTileFlags(3, TILE_HAZARD);  // lava
+
+    parseObjectives(lerAsset("maps/objective_positions.txt"), objectives);
 }
 
 int main()
 {
     std::cout << "Trabalho GB - Benjamin Vichel, Leonardo Ramos e Lucas Kappes" << std::endl;
+    TRACE_THREAD_NAME("main");
+    // os PNGs são decodificados pelas threads do JobSystem enquanto a janela
+    // e os shaders são criados; o upload para a GPU fica na thread principal
+    enum { IMAGE_ENEMIES, IMAGE_PLAYER, IMAGE_TILESET, IMAGE_COIN, IMAGE_COUNT };
+    DecodedImage images[IMAGE_COUNT] = {
+        {"sprites/enemies-spritesheet1.png", NULL, 0, 0, 0},
+        {"sprites/jorge.png", NULL, 0, 0, 0},
+        {"sprites/tilesetIso.png", NULL, 0, 0, 0},
+        {"sprites/coin.png", NULL, 0, 0, 0},
+    };
+    JobCounter imagesDecoded;
+    for (int i = 0; i < IMAGE_COUNT; ++i)
+    {
+        jobs.run(decodeImages, images, i, i + 1, &imagesDecoded);
+    }
+
     initializeGlfw();
     setupGlConfiguration();
+    input.initFromEnvironment();
+    const char *tileMapMode = getenv("PGCC_TILEMAP");
+    gpuTileMap = tileMapMode == NULL || std::string(tileMapMode) != "instanced";
 
     window = makeWindow(WIDTH, HEIGHT, WINDOW_TITLE);
     glfwSetKeyCallback(window, keyCallback);
+    redraw.install(window);
+    input.install(window, redraw);
 
     GLuint tileShaderId = createTileShaderProgram();
 
     glm::mat4 orthProjection = glm::ortho(0.0f, (float)WIDTH, (float)HEIGHT, 0.0f, -1.0f, 1.0f);
     glUseProgram(tileShaderId);
     glUniformMatrix4fv(glGetUniformLocation(tileShaderId, "projection"), 1, GL_FALSE, glm::value_ptr(orthProjection));
+    GLint tileHighlightLocation = glGetUniformLocation(tileShaderId, "highlight");
     std::cout << "Matriz de proje��o definida!" << std::endl;
 
+    loadAnimationClips();
+
+    // todas as malhas estáticas dividem um buffer de vértices e um de índices
+    meshVertices = new BufferArena();
+    meshVertices->init(4 * 1024);
+    meshIndices = new BufferArena();
+    meshIndices->init(1024);
+    Mesh quadMesh = setupQuadMesh();
+    Mesh tileMesh = setupTileMesh();
+    meshVAO = setupMeshVAO();
+
     GLuint playerShaderId = createPlayerShaderProgram();
-    GLuint playerVAO = setupPlayerVAO();
     glUseProgram(playerShaderId);
     glUniformMatrix4fv(glGetUniformLocation(playerShaderId, "projection"), 1, GL_FALSE, glm::value_ptr(orthProjection));
+    clips.upload(playerShaderId);
+
+    GLuint enemyShaderId = createEnemyShaderProgram();
+    GLuint enemyInstanceVBO;
+    GLuint enemyVAO = setupEnemyVAO(enemyInstanceVBO);
+    glUseProgram(enemyShaderId);
+    glUniformMatrix4fv(glGetUniformLocation(enemyShaderId, "projection"), 1, GL_FALSE, glm::value_ptr(orthProjection));
+    clips.upload(enemyShaderId);
+    jobs.wait(imagesDecoded);
+    GLuint enemyTextureId = uploadTexture(images[IMAGE_ENEMIES]);
 
     loadMap();
 
+    entities.create(1, 1, playerIdleClip, 0.0f);
+    spawnEnemies(ENEMY_COUNT);
+
     Sprite player = Sprite();
-    player.VAO = playerVAO;
-    player.textureId = loadTexture("../assets/sprites/jorge.png");
+    player.mesh = quadMesh;
+    player.textureId = uploadTexture(images[IMAGE_PLAYER]);
     player.shaderId = playerShaderId;
     player.scale = glm::vec3(playerSize, playerSize, 1.0f);
     player.translate = glm::vec3(200.0f, 200.0f, 0.0f);
 
-    Sprite tileSprite = Sprite();
-    tileSprite.VAO = setupTileVAO();
-    tileSprite.textureId = loadTexture("../assets/sprites/tilesetIso.png");
-    tileSprite.shaderId = tileShaderId;
+    GLuint tilesetTextureId = uploadTexture(images[IMAGE_TILESET]);
+    GLuint coinTextureId = uploadTexture(images[IMAGE_COIN]);
     float tileW = WIDTH / mapWidth;
     float tileH = tileW / 2.0f; // altura = metade da largura
-    tileSprite.scale = glm::vec3(tileW, tileH, 1.0f);
 
-    Sprite key = Sprite();
-    key.VAO = setupKeyVAO();
-    key.textureId = loadTexture("../assets/sprites/coin.png");
-    key.shaderId = tileShaderId;
-    key.scale = glm::vec3(tileW, tileH, 1.0f);
+    float sobraAltura = WIDTH - (HEIGHT / 2.0f);
 
-    std::vector<std::vector<Sprite>> map;
+    // cenário pela GPU: 1 byte por tile na textura de ids e um quad cobrindo
+    // o mapa; o vértice de cima do tile (0, 0) fica em (WIDTH / 2, sobraAltura / 4)
+    TileMapTexture tileMap;
+    tileMap.upload(*mapData);
+    GLuint tileMapShaderId = createTileMapShaderProgram();
+    glUseProgram(tileMapShaderId);
+    glUniformMatrix4fv(glGetUniformLocation(tileMapShaderId, "projection"), 1, GL_FALSE,
+                       glm::value_ptr(orthProjection));
+    glUniform1i(glGetUniformLocation(tileMapShaderId, "tileset"), 0);
+    glUniform1i(glGetUniformLocation(tileMapShaderId, "tileIds"), 1);
+    glUniform2f(glGetUniformLocation(tileMapShaderId, "isoOrigin"), WIDTH / 2.0f, sobraAltura / 4);
+    glUniform2f(glGetUniformLocation(tileMapShaderId, "isoTileSize"), tileW, tileH);
+    glUniform4f(glGetUniformLocation(tileMapShaderId, "mapBounds"), WIDTH / 2.0f - mapHeight * tileW / 2.0f,
+                sobraAltura / 4, (mapWidth + mapHeight) * tileW / 2.0f, (mapWidth + mapHeight) * tileH / 2.0f);
+    GLint tileMapHighlightLocation = glGetUniformLocation(tileMapShaderId, "highlight");
+
+    // lote instanciado (PGCC_TILEMAP=instanced ou F8): as transformações dos
+    // tiles são montadas na primeira vez que ele é desenhado e enviadas uma vez
+    TileBatch tiles;
+    setupTileBatch(tiles);
+
+    // moedas: refeitas quando um objetivo é coletado
+    TileBatch keys;
+    setupTileBatch(keys);
+
+    double lastEnemyStep = input.now();
 
-    float sobraAltura = WIDTH - (HEIGHT / 2.0f);
-    for (int i = 0; i < mapHeight; ++i)
+    while (!glfwWindowShouldClose(window))
     {
-        std::vector<Sprite> row;
-        for (int j = 0; j < mapWidth; ++j)
         {
-            Sprite tile = tileSprite;
-
-            float x = (j - i) * (tileW / 2.0f);
-            float y = (i + j) * (tileH / 2.0f);
-            tile.translate = glm::vec3(x + WIDTH / 2 - tileW / 2, y + sobraAltura / 4, 0.0f);
-            tile.frameIndex = mapData[i][j];
-            row.push_back(tile);
+            TRACE_ZONE("waitEvents");
+            input.waitEvents(redraw);
         }
-        map.push_back(row);
-    }
 
-    while (!glfwWindowShouldClose(window))
-    {
-        glfwPollEvents();
+        double now = input.now();
+        if (now - lastEnemyStep >= ENEMY_STEP_INTERVAL)
+        {
+            wanderEnemies();
+            lastEnemyStep = now;
+            redraw.invalidate();
+        }
+        redraw.scheduleAt(lastEnemyStep + ENEMY_STEP_INTERVAL);
+        double interval = animationInterval();
+        if (interval > 0.0)
+        {
+            redraw.scheduleAt(now + interval);
+        }
+        if (!redraw.beginFrame())
+        {
+            continue;
+        }
+        AllocTracker::beginFrame();
+        frameArena.reset();
+        TRACE_FRAME();
+        TRACE_COUNTER("entities", entities.size());
+        TRACE_COUNTER("objectives", objectives.size());
+
+        // a animação é calculada nos shaders a partir do tempo global
+        glUseProgram(playerShaderId);
+        glUniform1f(glGetUniformLocation(playerShaderId, "time"), (float)now);
+        glUseProgram(enemyShaderId);
+        glUniform1f(glGetUniformLocation(enemyShaderId, "time"), (float)now);
 
         glClearColor(0.0f, 0.0f, 0.0f, 0.7f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -825,30 +1240,61 @@ int main()
         glLineWidth(10);
         glPointSize(20);
 
-        for (size_t i = 0; i < map.size(); ++i)
         {
-            for (size_t j = 0; j < map[i].size(); ++j)
+            TRACE_ZONE("tiles");
+            if (gpuTileMap)
+            {
+                drawTileMap(tileMap, quadMesh, tileMapShaderId, tileMapHighlightLocation, tilesetTextureId,
+                            entities.col[PLAYER], entities.row[PLAYER]);
+            }
+            else
             {
-                drawTiles(map[i][j], i, j);
+                if (tiles.transforms.size() == 0)
+                {
+                    addMapTiles(tiles, tileW, tileH, WIDTH / 2 - tileW / 2, sobraAltura / 4);
+                }
+                drawTiles(tiles, tileMesh, tileShaderId, tileHighlightLocation, tilesetTextureId,
+                          entities.row[PLAYER] * mapWidth + entities.col[PLAYER]);
             }
         }
 
-        for (const auto &objective : objectives)
         {
-            Sprite keySprite = key;
-            float x = (objective.second - objective.first) * (tileW / 2.0f);
-            float y = (objective.second + objective.first) * (tileH / 2.0f);
-            keySprite.translate = glm::vec3(x + WIDTH / 2 - tileW / 2, y + sobraAltura / 4, 0.0f);
-            drawTiles(keySprite, objective.first, objective.second);
+            TRACE_ZONE("coins");
+            if (keys.transforms.size() != (int)objectives.size())
+            {
+                keys.transforms.clear();
+                keys.frames.clear();
+                for (const auto &objective : objectives)
+                {
+                    float x = (objective.second - objective.first) * (tileW / 2.0f);
+                    float y = (objective.second + objective.first) * (tileH / 2.0f);
+                    addTile(keys, x + WIDTH / 2 - tileW / 2, y + sobraAltura / 4, tileW, tileH, 0);
+                }
+            }
+            drawTiles(keys, quadMesh, tileShaderId, tileHighlightLocation, coinTextureId, -1);
         }
 
+        drawEnemies(enemyShaderId, enemyVAO, quadMesh, enemyInstanceVBO, enemyTextureId, tileW, tileH,
+                    WIDTH / 2 - tileW / 2, sobraAltura / 4);
+
         drawPlayer(player);
 
         glBindVertexArray(0);
 
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
+        GlStats::frame();
+        AllocTracker::endFrame();
+        input.endFrame();
     }
 
+    deleteTileBatch(tiles);
+    deleteTileBatch(keys);
+    tileMap.release();
+    delete meshVertices;
+    delete meshIndices;
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include "../../build/_deps/stb_image-src/stb_easy_font.h"
+#include "Trace.h"
 #include <string>
 #include <vector>
 
@@ -44,6 +45,7 @@ void setViewportDimensions(GLFWwindow *window)
 }
 void setupGlad()
 {
+    TRACE_ZONE("setupGlad");
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
@@ -79,6 +81,7 @@ GLFWwindow *makeWindow(GLuint width, GLuint height, const char *title)
 
 void initializeGlfw()
 {
+    TRACE_ZONE("initializeGlfw");
     if (!glfwInit())
     {
         std::cerr << "Falha ao inicializar GLFW" << std::endl;
@@ -135,6 +138,7 @@ void assertShaderCompilationStatus(GLuint shader)
 
 GLuint createShader(GLchar *shaderSource, GLenum shaderType)
 {
+    TRACE_ZONE("createShader");
     GLuint shader = glCreateShader(shaderType);
     if (!shader)
     {
@@ -166,6 +170,7 @@ void assertProgramLinkingStatus(GLuint shaderProgram)
 
 GLuint createShaderProgram()
 {
+    TRACE_ZONE("createShaderProgram");
     const GLuint vertexShader = createShader(R"(
         #version 400
         layout (location = 0) in vec3 position;
@@ -288,6 +293,7 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
 
 int loadTexture(std::string filePath)
 {
+    TRACE_ZONE("loadTexture");
     GLuint texID;
 
     // Gera o identificador da textura na memória
@@ -338,6 +344,7 @@ GLfloat calcIsoY(float x, float y)
 }
 int setupGeometry()
 {
+    TRACE_ZONE("setupGeometry");
 
     // Aqui setamos as coordenadas x, y e z do triângulo e as armazenamos de forma
     // sequencial, já visando mandar para o VBO (Vertex Buffer Objects)
@@ -498,7 +505,11 @@ int main()
 
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("pollEvents");
+            glfwPollEvents();
+        }
 
         glClearColor(0.0f, 0.0f, 0.0f, 0.7f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -516,7 +527,10 @@ int main()
 
         glBindVertexArray(0);
 
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
     }
 
     glfwTerminate();
@@ -4,12 +4,19 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 
+#include "GeometryPool.h"
+#include "InputReplay.h"
+#include "RedrawScheduler.h"
+#include "TriangleSet.h"
+#include "Trace.h"
+
 #define WIDTH 800
 #define HEIGHT 600
 #define WINDOW_TITLE "Exercicio Modulo 2 - Triangulos - Leonardo Ramos"
+#define MAX_TRIANGLES 5
 
 GLuint createShader(GLchar *shaderSource, GLenum shaderType);
-GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2);
+int createTriangle(float x0, float y0, float x1, float y1, float x2, float y2, float r, float g, float b);
 int createShaderProgram(GLuint vertexShader, GLuint fragmentShader);
 
 void setupGlConfiguration();
@@ -32,11 +39,19 @@ struct Triangle
     float yVertices[3];
     bool isReady = false;
 };
-void drawTriangle(GLuint VAO, GLint colorLoc, float r, float g, float b);
 
 Triangle currentTriangle = Triangle();
-int currentTriangleVaoIndex = 0;
-GLuint triangleVAOs[5];
+
+// os últimos MAX_TRIANGLES triângulos, em anel; o mais antigo sai do pool
+// quando chega um novo e o intervalo dele é reaproveitado
+GeometryPool *pool = NULL; // criado depois do contexto, destruído antes do glfwTerminate
+int currentTriangleSlot = 0;
+int triangleIds[MAX_TRIANGLES] = {-1, -1, -1, -1, -1};
+TriangleSet hitTest; // mesmo índice do anel; botão direito apaga o mais novo sob o cursor
+
+// redesenha só quando um triângulo é criado (ou a janela muda)
+RedrawScheduler redraw;
+InputReplay input; // PGCC_RECORD / PGCC_REPLAY (ver InputReplay.h)
 
 void addVertices(Triangle &triangle, float x, float y)
 {
@@ -56,16 +71,25 @@ void addToTrianglesIfReady(Triangle &triangle)
 {
     if (triangle.isReady)
     {
-        triangleVAOs[currentTriangleVaoIndex] = createTriangle(currentTriangle.xVertices[0], currentTriangle.yVertices[0],
-                                                               currentTriangle.xVertices[1], currentTriangle.yVertices[1],
-                                                               currentTriangle.xVertices[2], currentTriangle.yVertices[2]);
-        currentTriangleVaoIndex++;
-        if (currentTriangleVaoIndex >= 5)
+        // cor do anel: (1/i, 0.4/i, 1), limitada a 1
+        int slot = currentTriangleSlot;
+        float r = slot > 0 ? 1.0f / slot : 1.0f;
+        float g = slot > 0 ? 0.4f / slot : 1.0f;
+        pool->release(triangleIds[slot]);
+        triangleIds[slot] = createTriangle(currentTriangle.xVertices[0], currentTriangle.yVertices[0],
+                                           currentTriangle.xVertices[1], currentTriangle.yVertices[1],
+                                           currentTriangle.xVertices[2], currentTriangle.yVertices[2],
+                                           r, g, 1.0f);
+        hitTest.set(slot, currentTriangle.xVertices[0], currentTriangle.yVertices[0],
+                    currentTriangle.xVertices[1], currentTriangle.yVertices[1],
+                    currentTriangle.xVertices[2], currentTriangle.yVertices[2]);
+        currentTriangleSlot++;
+        if (currentTriangleSlot >= MAX_TRIANGLES)
         {
-            currentTriangleVaoIndex = 0;
+            currentTriangleSlot = 0;
         }
         currentTriangle = Triangle();
-
+        redraw.invalidate();
     }
 }
 
@@ -74,22 +98,39 @@ int main()
     glfwInit();
 
     setupGlConfiguration();
+    input.initFromEnvironment();
 
     GLFWwindow *window = makeWindow(WIDTH, HEIGHT, WINDOW_TITLE);
     glfwMakeContextCurrent(window);
     glfwSetCursorPosCallback(window, cursorMoveCallback);
     glfwSetMouseButtonCallback(window, cursorClickCallback);
+    redraw.install(window);
+    input.install(window, redraw);
 
     setupGlad();
     setViewportDimensions(window);
 
     GLuint shaderId = createShaderProgram();
-    GLint colorLoc = glGetUniformLocation(shaderId, "inputColor");
     glUseProgram(shaderId);
 
+    // posição (x, y, z) e cor (r, g, b) por vértice
+    pool = new GeometryPool();
+    pool->addAttribute(0, 3);
+    pool->addAttribute(1, 3);
+    pool->init(3 * MAX_TRIANGLES);
+    hitTest.resize(MAX_TRIANGLES);
+
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        TRACE_FRAME();
+        {
+            TRACE_ZONE("waitEvents");
+            input.waitEvents(redraw);
+        }
+        if (!redraw.beginFrame())
+        {
+            continue;
+        }
 
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
         glClear(GL_COLOR_BUFFER_BIT);
@@ -97,55 +138,40 @@ int main()
         glLineWidth(10);
         glPointSize(20);
 
-        for (int i = 0; i < 5; i++)
+        // fecha aos poucos os buracos deixados pelos triângulos removidos; com
+        // desenho sob demanda, pede outro quadro enquanto ainda houver o que mover
+        if (pool->compact() > 0)
         {
-            // std::cout << "Triangle VAO " << i << ": " << triangleVAOs[i] << std::endl;
-            drawTriangle(triangleVAOs[i], colorLoc, 1.0f / i, 0.4f / i, 1.0f);
+            redraw.invalidate();
         }
+        pool->draw(GL_TRIANGLES);
 
-        glBindVertexArray(0);
-
-        glfwSwapBuffers(window);
+        {
+            TRACE_ZONE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
+        input.endFrame();
     }
 
+    delete pool;
     glfwTerminate();
     return 0;
 }
 
-void drawTriangle(GLuint VAO, GLint colorLoc, float r, float g, float b)
-{
-    glBindVertexArray(VAO);
-    glUniform4f(colorLoc, r, g, b, 1.0f);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-}
-
-GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
+int createTriangle(float x0, float y0, float x1, float y1, float x2, float y2, float r, float g, float b)
 {
+    TRACE_ZONE("createTriangle");
     GLfloat vertices[] = {
-        x0, y0, 0.0f,
-        x1, y1, 0.0f,
-        x2, y2, 0.0f};
-
-    GLuint VAO, VBO;
-
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        x0, y0, 0.0f, r, g, b,
+        x1, y1, 0.0f, r, g, b,
+        x2, y2, 0.0f, r, g, b};
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid *)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    return VAO;
+    return pool->allocate(vertices, 3);
 }
 
 GLuint createShader(GLchar *shaderSource, GLenum shaderType)
 {
+    TRACE_ZONE("createShader");
     GLuint shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &shaderSource, NULL);
     glCompileShader(shader);
@@ -171,23 +197,27 @@ void assertShaderCompilationStatus(GLuint shader)
 
 int createShaderProgram()
 {
+    TRACE_ZONE("createShaderProgram");
     GLuint vertexShader = createShader(R"(
         #version 400
         layout (location = 0) in vec3 position;
+        layout (location = 1) in vec3 vertexColor;
+        out vec3 color;
         void main()
         {
             gl_Position = vec4(position.x, position.y, position.z, 1.0);
+            color = vertexColor;
         }
         )",
                                        GL_VERTEX_SHADER);
 
     GLuint fragmentShader = createShader(R"(
         #version 400
-        uniform vec4 inputColor;
-        out vec4 color;
+        in vec3 color;
+        out vec4 fragColor;
         void main()
         {
-            color = inputColor;
+            fragColor = vec4(color, 1.0);
         }
         )",
                                          GL_FRAGMENT_SHADER);
@@ -201,6 +231,7 @@ int createShaderProgram()
 
 int createShaderProgram(GLuint vertexShader, GLuint fragmentShader)
 {
+    TRACE_ZONE("linkShaderProgram");
     GLuint shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
@@ -243,6 +274,7 @@ GLFWwindow *makeWindow(int width, int height, const char *title)
 }
 void setupGlad()
 {
+    TRACE_ZONE("setupGlad");
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cerr << "Falha ao inicializar GLAD" << std::endl;
@@ -276,9 +308,21 @@ void cursorClickCallback(GLFWwindow *window, int button, int action, int mods)
                   << currentTriangle.xVertices[1] << ", " << currentTriangle.yVertices[1] << ", "
                   << currentTriangle.xVertices[2] << ", " << currentTriangle.yVertices[2] << ")" << std::endl;
         addToTrianglesIfReady(currentTriangle);
-        for(int i = 0; i < 5; i++)
+        for(int i = 0; i < MAX_TRIANGLES; i++)
+        {
+            std::cout << "Triangle " << i << ": " << triangleIds[i] << std::endl;
+        }
+    }
+    else if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
+    {
+        int slot = hitTest.pick(mouseX / 800 * 2 - 1, -(mouseY / 600 * 2 - 1));
+        if (slot >= 0)
         {
-            std::cout << "Triangle VAO " << i << ": " << triangleVAOs[i] << std::endl;
+            std::cout << "Removing triangle " << slot << std::endl;
+            pool->release(triangleIds[slot]);
+            triangleIds[slot] = -1;
+            hitTest.remove(slot);
+            redraw.invalidate();
         }
     }
 }